@@ -180,8 +180,10 @@ void GardenScene::onInit() {
     stage.get("grass")
   });
 
+  // Mouse capture is tracked here rather than queried from SDL, so
+  // scripted input behaves the same way when running headless
   input.onMouseMotion([=](const SDL_MouseMotionEvent& event) {
-    if (SDL_GetRelativeMouseMode()) {
+    if (isMouseCaptured) {
       camera.orientation.x += event.yrel / 1000.0f;
       camera.orientation.y += event.xrel / 1000.0f;
     }
@@ -189,17 +191,21 @@ void GardenScene::onInit() {
 
   input.onMouseButton([=](const SDL_MouseButtonEvent& event) {
     if (event.type == SDL_MOUSEBUTTONDOWN) {
-      if (SDL_GetRelativeMouseMode() == SDL_TRUE) {
+      if (isMouseCaptured) {
         throwSeeds();
       }
 
       SDL_SetRelativeMouseMode(SDL_TRUE);
+
+      isMouseCaptured = true;
     }
   });
 
   input.onKeyDown([=](const SDL_KeyboardEvent& event) {
     if (event.keysym.sym == SDLK_ESCAPE) {
       SDL_SetRelativeMouseMode(SDL_FALSE);
+
+      isMouseCaptured = false;
     }
   });
 }
@@ -12,6 +12,7 @@ public:
 
 private:
   Vec3f velocity = Vec3f(0.0f);
+  bool isMouseCaptured = false;
 
   void addGrass();
   void addRocks();
@@ -0,0 +1,160 @@
+#include <cmath>
+#include <string>
+
+#include <PolyEngine.h>
+
+#include "StressScene.h"
+#include "actors/VisibleObjectFilter.h"
+
+constexpr static float AREA_SIZE = 1000.0f;
+constexpr static float CHURN_LIFETIME = 1.0f;
+
+const static char* MESH_PATHS[] = {
+  "./assets/rock-1/model.obj",
+  "./assets/mushroom/base-model.obj",
+  "./assets/mushroom/head-model.obj",
+  "./assets/lantern/model.obj",
+  "./assets/seed/model.obj",
+  "./assets/sprout/model.obj",
+  "./assets/small-flower/stalk-model.obj",
+  "./assets/small-flower/petals-model.obj",
+  "./assets/lavender/stalk-model.obj",
+  "./assets/lavender/flowers-model.obj"
+};
+
+StressScene::StressScene(const StressSceneConfig& config) {
+  this->config = config;
+}
+
+void StressScene::addInstance(Object* mesh, float lifetime) {
+  if (config.useWorld) {
+    addWorldInstance(mesh, lifetime);
+
+    return;
+  }
+
+  stage.add<Instance>([&](Instance* instance) {
+    instance->from(mesh);
+    instance->setScale(RNG::random(5.0f, 15.0f));
+    instance->setPosition(Vec3f(RNG::random(-AREA_SIZE, AREA_SIZE), 0.0f, RNG::random(-AREA_SIZE, AREA_SIZE)));
+    instance->setOrientation(Vec3f(0.0f, RNG::random(0.0f, M_PI * 2.0f), 0.0f));
+    instance->lifetime = lifetime;
+  });
+}
+
+/**
+ * Adds an instance as a World entity, placed the same way as an
+ * Instance would be.
+ */
+void StressScene::addWorldInstance(Object* mesh, float lifetime) {
+  World& world = stage.getWorld();
+
+  EntityHandle entity = (
+    lifetime > 0.0f
+      ? world.create<TransformComponent, RenderInstanceComponent, LifetimeComponent>()
+      : world.create<TransformComponent, RenderInstanceComponent>()
+  );
+
+  auto* transform = world.get<TransformComponent>(entity);
+
+  transform->scale = Vec3f(RNG::random(5.0f, 15.0f));
+  transform->position = Vec3f(RNG::random(-AREA_SIZE, AREA_SIZE), 0.0f, RNG::random(-AREA_SIZE, AREA_SIZE));
+  transform->orientation = Vec3f(0.0f, RNG::random(0.0f, M_PI * 2.0f), 0.0f);
+
+  world.get<RenderInstanceComponent>(entity)->reference = mesh;
+
+  if (lifetime > 0.0f) {
+    world.get<LifetimeComponent>(entity)->remaining = lifetime;
+  }
+}
+
+void StressScene::addLights() {
+  stage.add<Light>([](Light* light) {
+    light->type = Light::LightType::DIRECTIONAL;
+    light->direction = Vec3f(-1.0f, -0.6f, 0.25f);
+    light->power = 0.5f;
+    light->canCastShadows = true;
+    light->shadowMapSize = { 2048, 2048 };
+  });
+
+  auto addLight = [&](Light::LightType type, bool canCastShadows) {
+    stage.add<Light>([&](Light* light) {
+      light->type = type;
+      light->color = Vec3f(RNG::random(), RNG::random(), RNG::random());
+      light->position = Vec3f(RNG::random(-AREA_SIZE, AREA_SIZE), 50.0f, RNG::random(-AREA_SIZE, AREA_SIZE));
+      light->direction = Vec3f(0.0f, -1.0f, 0.0f);
+      light->radius = 250.0f;
+      light->canCastShadows = canCastShadows;
+      light->shadowMapSize = { 512, 512 };
+    });
+  };
+
+  for (unsigned int i = 0; i < config.totalPointLights; i++) {
+    addLight(Light::LightType::POINT, false);
+  }
+
+  for (unsigned int i = 0; i < config.totalSpotLights; i++) {
+    addLight(Light::LightType::SPOTLIGHT, false);
+  }
+
+  for (unsigned int i = 0; i < config.totalShadowLights; i++) {
+    addLight(Light::LightType::SPOTLIGHT, true);
+  }
+}
+
+/**
+ * Adds each distinct mesh, cycling through the available models once
+ * there are more meshes than models. Meshes sharing a model are still
+ * separate objects, each with its own instances and draw calls.
+ */
+void StressScene::addMeshes() {
+  unsigned int totalPaths = sizeof(MESH_PATHS) / sizeof(const char*);
+
+  for (unsigned int i = 0; i < config.totalMeshes; i++) {
+    const char* path = MESH_PATHS[i % totalPaths];
+
+    stage.add<ReferenceMesh>("mesh-" + std::to_string(i), [&](ReferenceMesh* mesh) {
+      mesh->from(ObjLoader(path));
+      mesh->color = Vec3f(RNG::random(), RNG::random(), RNG::random());
+      mesh->shadowCascadeLimit = 2;
+
+      meshes.push_back(mesh);
+    });
+  }
+}
+
+void StressScene::onInit() {
+  camera.position = Vec3f(0.0f, 150.0f, 0.0f);
+  camera.orientation = Vec3f(0.2f, 0.0f, 0.0f);
+
+  addMeshes();
+  addLights();
+
+  for (auto* mesh : meshes) {
+    for (unsigned int i = 0; i < config.instancesPerMesh; i++) {
+      addInstance(mesh, -1.0f);
+    }
+  }
+
+  stage.add<VisibleObjectFilter>("object-filter", [&](VisibleObjectFilter* filter) {
+    filter->addObjects(meshes);
+  });
+}
+
+void StressScene::onUpdate(float dt) {
+  super::onUpdate(dt);
+
+  camera.orientation.y += dt * 0.2f;
+
+  if (meshes.size() == 0) {
+    return;
+  }
+
+  pendingSpawns += config.churnPerSecond * dt;
+
+  while (pendingSpawns >= 1.0f) {
+    addInstance(meshes[(unsigned int)(RNG::random() * meshes.size()) % meshes.size()], CHURN_LIFETIME);
+
+    pendingSpawns -= 1.0f;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <PolyEngine.h>
+
+/**
+ * Counts which a StressScene is generated from, and whether its
+ * instances are World entities rather than Instances.
+ */
+struct StressSceneConfig {
+  unsigned int totalMeshes = 4;
+  unsigned int instancesPerMesh = 1000;
+  unsigned int totalPointLights = 10;
+  unsigned int totalSpotLights = 0;
+  unsigned int totalShadowLights = 1;
+  float churnPerSecond = 0.0f;
+  bool useWorld = false;
+};
+
+/**
+ * A synthetic scene for measuring how the engine scales. Instances of
+ * each mesh are scattered over a flat area around a slowly turning
+ * camera, with point and spot lights overhead. Churn continuously
+ * spawns short-lived instances at a fixed rate, so that entity
+ * creation and removal costs can be measured alongside steady-state
+ * costs. Instances can be made World entities instead, to compare the
+ * two.
+ */
+class StressScene : public AbstractScene {
+public:
+  StressScene(const StressSceneConfig& config);
+
+  void onInit() override;
+  void onUpdate(float dt) override;
+
+private:
+  StressSceneConfig config;
+  std::vector<Object*> meshes;
+  float pendingSpawns = 0.0f;
+
+  void addInstance(Object* mesh, float lifetime);
+  void addLights();
+  void addMeshes();
+  void addWorldInstance(Object* mesh, float lifetime);
+};
\ No newline at end of file
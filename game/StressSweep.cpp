@@ -0,0 +1,174 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <PolyEngine.h>
+
+#include "StressSweep.h"
+
+constexpr static unsigned int WARMUP_FRAMES = 30;
+constexpr static unsigned int MEASURED_FRAMES = 120;
+
+/**
+ * Average per-frame costs measured for one parameter value.
+ */
+struct StressSample {
+  unsigned int value = 0;
+  float frameTime = 0.0f;
+  float subsystemTimes[ProfiledSubsystem::TOTAL_PROFILED_SUBSYSTEMS] = { 0.0f };
+  float commandRecordTime = 0.0f;
+  float commandReplayTime = 0.0f;
+  float gpuFrameTime = 0.0f;
+  unsigned int totalObjects = 0;
+  unsigned int totalDrawCalls = 0;
+};
+
+class StressGameController : public AbstractGameController {
+public:
+  StressGameController(const StressSceneConfig& config) : config(config) {};
+
+  void onInit() override {
+    enterScene(new StressScene(config));
+  }
+
+private:
+  StressSceneConfig config;
+};
+
+bool StressSweep::applyParameter(StressSceneConfig& config, const char* parameter, unsigned int value) {
+  if (strcmp(parameter, "instances") == 0) {
+    config.instancesPerMesh = value;
+  } else if (strcmp(parameter, "meshes") == 0) {
+    config.totalMeshes = value;
+  } else if (strcmp(parameter, "point-lights") == 0) {
+    config.totalPointLights = value;
+  } else if (strcmp(parameter, "spot-lights") == 0) {
+    config.totalSpotLights = value;
+  } else if (strcmp(parameter, "shadow-lights") == 0) {
+    config.totalShadowLights = value;
+  } else if (strcmp(parameter, "churn") == 0) {
+    config.churnPerSecond = (float)value;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Runs the sweep, writing one CSV row per value to the results path.
+ * Each run is seeded identically, so runs differ only by parameter.
+ * With useWorld, instances are World entities rather than Instances.
+ * Alongside each frame time, the printed summary shows its growth
+ * exponent relative to the previous value: about 1 for linear costs,
+ * and about 2 for quadratic ones.
+ */
+bool StressSweep::run(const char* parameter, const std::vector<unsigned int>& values, const char* resultsPath, bool useNullVideo, bool useWorld) {
+  std::vector<StressSample> samples;
+
+  for (unsigned int value : values) {
+    StressSceneConfig config;
+    StressSample sample;
+
+    config.useWorld = useWorld;
+
+    if (!applyParameter(config, parameter, value)) {
+      printf("[StressSweep] Unknown parameter: %s\n", parameter);
+
+      return false;
+    }
+
+    Window window;
+
+    RNG::seed(1);
+
+    window.openHeadless({ 1200, 720 });
+    window.setFrameLimit(WARMUP_FRAMES + MEASURED_FRAMES);
+
+    if (useNullVideo) {
+      window.setVideoController(new NullVideoController());
+    } else {
+      window.setVideoController(new OpenGLVideoController());
+    }
+
+    window.setGameController(new StressGameController(config));
+
+    auto lastFrameEnd = std::chrono::high_resolution_clock::now();
+
+    window.onFrameEnd([&](unsigned int frame) {
+      auto frameEnd = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<float, std::milli> frameTime = frameEnd - lastFrameEnd;
+
+      lastFrameEnd = frameEnd;
+
+      if (frame < WARMUP_FRAMES) {
+        return;
+      }
+
+      auto& profile = PerformanceProfiler::getProfile();
+
+      sample.frameTime += frameTime.count() / MEASURED_FRAMES;
+      sample.commandRecordTime += profile.commandRecordTime / MEASURED_FRAMES;
+      sample.commandReplayTime += profile.commandReplayTime / MEASURED_FRAMES;
+      sample.gpuFrameTime += PerformanceProfiler::getGpuPassTime("frame") / MEASURED_FRAMES;
+      sample.totalObjects = profile.totalObjects;
+      sample.totalDrawCalls = profile.totalDrawCalls;
+
+      for (unsigned int i = 0; i < ProfiledSubsystem::TOTAL_PROFILED_SUBSYSTEMS; i++) {
+        sample.subsystemTimes[i] += profile.subsystemTimes[i] / MEASURED_FRAMES;
+      }
+    });
+
+    window.run();
+
+    sample.value = value;
+
+    samples.push_back(sample);
+  }
+
+  std::ofstream csv(resultsPath);
+
+  csv << parameter << ",frame_ms,stage_update_ms,rehydrate_ms,culling_ms,light_buffering_ms,record_ms,replay_ms,gpu_ms,objects,draw_calls\n";
+
+  for (unsigned int i = 0; i < samples.size(); i++) {
+    auto& sample = samples[i];
+
+    csv
+      << sample.value << ","
+      << sample.frameTime << ","
+      << sample.subsystemTimes[ProfiledSubsystem::STAGE_UPDATE] << ","
+      << sample.subsystemTimes[ProfiledSubsystem::REHYDRATE] << ","
+      << sample.subsystemTimes[ProfiledSubsystem::CULLING] << ","
+      << sample.subsystemTimes[ProfiledSubsystem::LIGHT_BUFFERING] << ","
+      << sample.commandRecordTime << ","
+      << sample.commandReplayTime << ","
+      << sample.gpuFrameTime << ","
+      << sample.totalObjects << ","
+      << sample.totalDrawCalls << "\n";
+
+    float exponent = 0.0f;
+
+    if (i > 0 && sample.value > samples[i - 1].value && samples[i - 1].value > 0 && samples[i - 1].frameTime > 0.0f) {
+      exponent = std::log(sample.frameTime / samples[i - 1].frameTime) / std::log((float)sample.value / samples[i - 1].value);
+    }
+
+    printf(
+      "[StressSweep] %s=%u: frame %.3f ms (n^%.2f), update %.3f, rehydrate %.3f, culling %.3f, lights %.3f, record %.3f, replay %.3f, gpu %.3f\n",
+      parameter,
+      sample.value,
+      sample.frameTime,
+      exponent,
+      sample.subsystemTimes[ProfiledSubsystem::STAGE_UPDATE],
+      sample.subsystemTimes[ProfiledSubsystem::REHYDRATE],
+      sample.subsystemTimes[ProfiledSubsystem::CULLING],
+      sample.subsystemTimes[ProfiledSubsystem::LIGHT_BUFFERING],
+      sample.commandRecordTime,
+      sample.commandReplayTime,
+      sample.gpuFrameTime
+    );
+  }
+
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include "StressScene.h"
+
+/**
+ * Runs a StressScene headlessly once for each value of a single scene
+ * parameter, reporting the average cost of each engine subsystem per
+ * frame against the parameter value. Comparing how costs grow as the
+ * parameter grows exposes any which scale worse than linearly.
+ *
+ * Parameters are named: instances, meshes, point-lights, spot-lights,
+ * shadow-lights and churn.
+ */
+class StressSweep {
+public:
+  static bool run(const char* parameter, const std::vector<unsigned int>& values, const char* resultsPath, bool useNullVideo, bool useWorld);
+
+private:
+  static bool applyParameter(StressSceneConfig& config, const char* parameter, unsigned int value);
+};
\ No newline at end of file
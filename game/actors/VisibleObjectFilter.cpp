@@ -1,3 +1,4 @@
+#include <chrono>
 #include <cmath>
 
 #include <PolyEngine.h>
@@ -15,6 +16,7 @@ void VisibleObjectFilter::addObjects(const std::vector<Object*>& objects) {
 }
 
 void VisibleObjectFilter::onUpdate(float dt) {
+  auto start = std::chrono::high_resolution_clock::now();
   Matrix4 view = Camera::active->getViewMatrix();
   float frustumFactor = std::tanf(0.5f * Camera::active->fov * M_PI / 180.0f);
 
@@ -32,4 +34,8 @@ void VisibleObjectFilter::onUpdate(float dt) {
       );
     });
   }
+
+  std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+
+  PerformanceProfiler::trackSubsystemTime(ProfiledSubsystem::CULLING, duration.count());
 }
\ No newline at end of file
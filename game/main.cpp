@@ -1,15 +1,131 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include <PolyEngine.h>
 
 #include "GameController.h"
 #include "GardenScene.h"
+#include "StressSweep.h"
 
+/**
+ * Usage:
+ *
+ *   Polygarden [--headless [frames]] [--null-video] [--benchmark <script> <results>] [--trace <trace.json>] [--stats <frames>] [--fps <rate>] [--pipelined]
+ *   Polygarden --compare <baseline.json> <results.json> [tolerance]
+ *   Polygarden --stress-sweep <parameter> <value,value,...> <results.csv> [--null-video] [--world]
+ *
+ * --headless runs without a window, rendering offscreen where
+ * supported, optionally for a fixed number of frames. --null-video
+ * skips rendering entirely, leaving only simulation and render
+ * preparation. --benchmark runs a scripted benchmark, writing its
+ * results to <results>.csv and <results>.json. --compare checks
+ * benchmark results against a baseline, exiting with 1 if any metric
+ * regressed by more than the tolerance (0.1 by default).
+ * --stress-sweep runs a stress scene headlessly for each value of
+ * one of its parameters (see StressSweep), with --world making its
+ * instances World entities rather than Instances. --trace records
+ * profiled zones while running, writing them on exit as a Chrome
+ * trace. --stats prints frame counters every given number of frames.
+ * --fps holds frames to a target rate rather than running unlimited.
+ * --pipelined simulates each frame on a separate thread while the
+ * previous frame renders.
+ */
 int main(int argc, char *argv[]) {
+  bool isHeadless = false;
+  bool useNullVideo = false;
+  bool isPipelined = false;
+  bool useWorld = false;
+  unsigned int headlessFrames = 0;
+  const char* benchmarkScriptPath = nullptr;
+  const char* benchmarkResultsPath = nullptr;
+  const char* sweepParameter = nullptr;
+  const char* sweepResultsPath = nullptr;
+  const char* tracePath = nullptr;
+  unsigned int targetFrameRate = 0;
+  std::vector<unsigned int> sweepValues;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--headless") == 0) {
+      isHeadless = true;
+
+      if (i + 1 < argc && isdigit(argv[i + 1][0])) {
+        headlessFrames = (unsigned int)atoi(argv[++i]);
+      }
+    } else if (strcmp(argv[i], "--null-video") == 0) {
+      useNullVideo = true;
+    } else if (strcmp(argv[i], "--pipelined") == 0) {
+      isPipelined = true;
+    } else if (strcmp(argv[i], "--world") == 0) {
+      useWorld = true;
+    } else if (strcmp(argv[i], "--benchmark") == 0 && i + 2 < argc) {
+      benchmarkScriptPath = argv[++i];
+      benchmarkResultsPath = argv[++i];
+    } else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+      float tolerance = i + 3 < argc ? (float)atof(argv[i + 3]) : 0.1f;
+
+      return Benchmark::compare(argv[i + 1], argv[i + 2], tolerance) ? 0 : 1;
+    } else if (strcmp(argv[i], "--stress-sweep") == 0 && i + 3 < argc) {
+      std::stringstream values(argv[i + 2]);
+      std::string value;
+
+      while (std::getline(values, value, ',')) {
+        sweepValues.push_back((unsigned int)atoi(value.c_str()));
+      }
+
+      sweepParameter = argv[i + 1];
+      sweepResultsPath = argv[i + 3];
+      i += 3;
+    } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+      PerformanceProfiler::setStatsDumpInterval((unsigned int)atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+      targetFrameRate = (unsigned int)atoi(argv[++i]);
+    }
+  }
+
+  if (sweepParameter != nullptr) {
+    return StressSweep::run(sweepParameter, sweepValues, sweepResultsPath, useNullVideo, useWorld) ? 0 : 1;
+  }
+
   Window window;
 
-  window.open("Polygarden", { 100, 100, 1200, 720 });
-  window.setVideoController(new OpenGLVideoController());
+  if (isHeadless) {
+    window.openHeadless({ 1200, 720 });
+    window.setFrameLimit(headlessFrames);
+  } else {
+    window.open("Polygarden", { 100, 100, 1200, 720 });
+  }
+
+  window.setTargetFrameRate(targetFrameRate);
+  window.setPipelined(isPipelined);
+
+  if (useNullVideo) {
+    window.setVideoController(new NullVideoController());
+  } else {
+    window.setVideoController(new OpenGLVideoController());
+  }
+
+  if (benchmarkScriptPath != nullptr) {
+    window.setBenchmark(new Benchmark(benchmarkScriptPath, benchmarkResultsPath));
+  }
+
   window.setGameController(new GameController());
+
+  if (tracePath != nullptr) {
+    ZoneProfiler::start();
+  }
+
   window.run();
 
+  if (tracePath != nullptr) {
+    ZoneProfiler::stop();
+    ZoneProfiler::writeTrace(tracePath);
+  }
+
   return 0;
 }
\ No newline at end of file
@@ -2,11 +2,17 @@
 
 #include "subsystem/Window.h"
 #include "subsystem/AbstractVideoController.h"
+#include "subsystem/NullVideoController.h"
 #include "subsystem/AbstractGameController.h"
 #include "subsystem/AbstractScene.h"
 #include "subsystem/Stage.h"
 #include "subsystem/Math.h"
 #include "subsystem/RNG.h"
+#include "subsystem/PerformanceProfiler.h"
+#include "subsystem/ZoneProfiler.h"
+#include "subsystem/MemoryTracker.h"
+#include "subsystem/JobSystem.h"
+#include "subsystem/ecs/World.h"
 #include "subsystem/entities/Object.h"
 #include "subsystem/entities/Mesh.h"
 #include "subsystem/entities/Plane.h"
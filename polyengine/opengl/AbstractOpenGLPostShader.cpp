@@ -1,18 +1,20 @@
+#include <stdexcept>
+
 #include "glew.h"
 #include "SDL_opengl.h"
 #include "glut.h"
 #include "opengl/AbstractOpenGLPostShader.h"
+#include "opengl/OpenGLScreenQuad.h"
 #include "opengl/ShaderLoader.h"
-#include "subsystem/Window.h"
 
 AbstractOpenGLPostShader::~AbstractOpenGLPostShader() {
-  delete frameBuffer;
-
   for (auto& [ key, program ] : programMap) {
     delete program;
   }
 
   programMap.clear();
+
+  delete stageProgram;
 }
 
 void AbstractOpenGLPostShader::addShaderProgram(std::string name, const char* path) {
@@ -30,51 +32,104 @@ void AbstractOpenGLPostShader::addShaderProgram(const char* path) {
   addShaderProgram("__main__", path);
 }
 
-void AbstractOpenGLPostShader::createFrameBuffer(const Area<unsigned int>& size) {
-  if (frameBuffer != nullptr) {
-    delete frameBuffer;
-  }
+/**
+ * Adds the full-screen pass which renders the input through this
+ * shader's stage, along with any subsequent stages fused into it,
+ * and writes the result to the output.
+ */
+void AbstractOpenGLPostShader::addStagePass(OpenGLRenderGraph& graph, const std::vector<OpenGLRenderGraph::Resource>& reads, OpenGLRenderGraph::Resource input, OpenGLRenderGraph::Resource output) {
+  graph.addPass("post-fx", reads, output, [=, &graph]() {
+    stageProgram->use();
+    stageProgram->setInt("colorDepthIn", 0);
+
+    for (auto* stage : fusedStages) {
+      stage->onRenderStage(*stageProgram);
+    }
 
-  frameBuffer = new FrameBuffer(size.width, size.height);
+    graph.startReading(input, GL_TEXTURE0);
+    graph.startWriting(output);
 
-  onConfigureFrameBuffer();
+    glClear(GL_COLOR_BUFFER_BIT);
 
-  frameBuffer->bindColorTextures();
+    OpenGLScreenQuad::draw();
+  });
 }
 
-FrameBuffer* AbstractOpenGLPostShader::getFrameBuffer() const {
-  return frameBuffer;
+/**
+ * Creates the program used by this shader's stage pass, fusing in
+ * the stages of any subsequent shaders. Each fused stage samples
+ * the stage before it directly rather than through an intermediate
+ * render target, so the stages are composed into a single pass.
+ */
+void AbstractOpenGLPostShader::fuseStages(const std::vector<AbstractOpenGLPostShader*>& stages) {
+  std::vector<std::string> stagePaths;
+
+  fusedStages = stages;
+
+  for (auto* stage : fusedStages) {
+    stagePaths.push_back(stage->getStagePath());
+  }
+
+  delete stageProgram;
+
+  stageProgram = new ShaderProgram();
+
+  stageProgram->create();
+  stageProgram->attachShader(ShaderLoader::loadVertexShader("./shaders/quad.vertex.glsl"));
+  stageProgram->attachShader(ShaderLoader::loadFragmentShader("./shaders/post-fx/composite.fragment.glsl", stagePaths));
+  stageProgram->link();
 }
 
-ShaderProgram* AbstractOpenGLPostShader::getShaderProgram(std::string name) {
-  return programMap.at(name);
+/**
+ * Looks up a program without copying its name, since passes look up
+ * their programs every frame and longer names would allocate.
+ */
+ShaderProgram* AbstractOpenGLPostShader::getShaderProgram(std::string_view name) {
+  auto entry = programMap.find(name);
+
+  if (entry == programMap.end()) {
+    throw std::out_of_range("[AbstractOpenGLPostShader] No program named: " + std::string(name));
+  }
+
+  return entry->second;
 }
 
 ShaderProgram* AbstractOpenGLPostShader::getShaderProgram() {
   return getShaderProgram("__main__");
 }
 
-void AbstractOpenGLPostShader::render() {
-  frameBuffer->startReading();
-  
-  glClear(GL_COLOR_BUFFER_BIT);
+const std::string& AbstractOpenGLPostShader::getStagePath() const {
+  return stagePath;
+}
 
-  onRender();
+unsigned int AbstractOpenGLPostShader::getStageTaps() const {
+  return stageTaps;
 }
 
-void AbstractOpenGLPostShader::setNextShader(AbstractOpenGLPostShader* glPostShader) {
-  nextShader = glPostShader;
+/**
+ * Determines whether the shader renders any passes before its
+ * stage. Such shaders can't be fused into a preceding shader's
+ * pass, though later stages can still be fused into theirs.
+ */
+bool AbstractOpenGLPostShader::hasIntermediatePasses() const {
+  return false;
 }
 
-void AbstractOpenGLPostShader::writeToInputBuffer() {
-  frameBuffer->startWriting();
+bool AbstractOpenGLPostShader::hasStage() const {
+  return stagePath.size() > 0;
 }
 
-void AbstractOpenGLPostShader::writeToOutputBuffer() {
-  if (nextShader != nullptr) {
-    nextShader->writeToInputBuffer();
-  } else {
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glViewport(0, 0, Window::size.width, Window::size.height);
-  }
-}
\ No newline at end of file
+void AbstractOpenGLPostShader::onCreatePasses(OpenGLRenderGraph& graph, OpenGLRenderGraph::Resource input, OpenGLRenderGraph::Resource output) {
+  addStagePass(graph, { input }, input, output);
+}
+
+/**
+ * Declares the shader's stage snippet, relative to the shaders
+ * directory, along with the number of times the stage samples its
+ * input per fragment. Fusing stages multiplies their sample counts,
+ * so the pipeline uses this to decide which stages are worth fusing.
+ */
+void AbstractOpenGLPostShader::setStage(std::string path, unsigned int taps) {
+  stagePath = path;
+  stageTaps = taps;
+}
@@ -3,34 +3,38 @@
 #include <functional>
 #include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "opengl/ShaderProgram.h"
-#include "opengl/FrameBuffer.h"
+#include "opengl/OpenGLRenderGraph.h"
 #include "subsystem/Math.h"
 
 class AbstractOpenGLPostShader {
 public:
   virtual ~AbstractOpenGLPostShader();
 
-  void createFrameBuffer(const Area<unsigned int>& size);
-  FrameBuffer* getFrameBuffer() const;
-  void render();
+  void fuseStages(const std::vector<AbstractOpenGLPostShader*>& stages);
+  const std::string& getStagePath() const;
+  unsigned int getStageTaps() const;
+  bool hasStage() const;
+  virtual bool hasIntermediatePasses() const;
+  virtual void onCreatePasses(OpenGLRenderGraph& graph, OpenGLRenderGraph::Resource input, OpenGLRenderGraph::Resource output);
   virtual void onInit() = 0;
-  virtual void onConfigureFrameBuffer() = 0;
-  virtual void onRender() = 0;
-  void setNextShader(AbstractOpenGLPostShader* glPostShader);
-  void writeToInputBuffer();
-  void writeToOutputBuffer();
+  virtual void onRenderStage(ShaderProgram& program) {}
 
 protected:
-  FrameBuffer* frameBuffer = nullptr;
-
   void addShaderProgram(std::string name, const char* path);
   void addShaderProgram(const char* path);
-  ShaderProgram* getShaderProgram(std::string name);
+  void addStagePass(OpenGLRenderGraph& graph, const std::vector<OpenGLRenderGraph::Resource>& reads, OpenGLRenderGraph::Resource input, OpenGLRenderGraph::Resource output);
+  ShaderProgram* getShaderProgram(std::string_view name);
   ShaderProgram* getShaderProgram();
+  void setStage(std::string path, unsigned int taps);
 
 private:
-  std::map<std::string, ShaderProgram*> programMap;
-  AbstractOpenGLPostShader* nextShader = nullptr;
-};
\ No newline at end of file
+  std::map<std::string, ShaderProgram*, std::less<>> programMap;
+  std::string stagePath;
+  unsigned int stageTaps = 0;
+  std::vector<AbstractOpenGLPostShader*> fusedStages;
+  ShaderProgram* stageProgram = nullptr;
+};
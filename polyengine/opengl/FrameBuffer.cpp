@@ -1,24 +1,38 @@
 #include "opengl/FrameBuffer.h"
+#include "opengl/OpenGLState.h"
 
-FrameBuffer::FrameBuffer(int width, int height) {
+/**
+ * Creates a framebuffer whose attachments are accounted to the
+ * provided memory tag.
+ */
+FrameBuffer::FrameBuffer(int width, int height, MemoryTag memoryTag) {
   glGenFramebuffers(1, &fbo);
-  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
 
   size.width = width;
   size.height = height;
+
+  this->memoryTag = memoryTag;
 }
 
 FrameBuffer::~FrameBuffer() {
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+  OpenGLState::bindTexture(GL_TEXTURE_2D, 0);
 
-  glDeleteFramebuffers(1, &fbo);
+  OpenGLState::deleteFramebuffers(1, &fbo);
 
   for (auto& colorTexture : colorTextures) {
-    glDeleteTextures(1, &colorTexture.id);
+    if (colorTexture.isOwned) {
+      OpenGLState::deleteTextures(1, &colorTexture.id);
+    }
   }
 
-  glDeleteTextures(1, &depthStencilBuffer);
+  OpenGLState::deleteTextures(1, &depthStencilBuffer);
+  OpenGLState::deleteTextures(1, &depthTextureArray);
+  OpenGLState::deleteTextures(1, &depthCubeMap);
+  OpenGLState::deleteSamplers(1, &rawDepthSampler);
+
+  MemoryTracker::trackFree(memoryTag, totalTrackedBytes);
 
   colorTextures.clear();
 }
@@ -42,7 +56,7 @@ void FrameBuffer::addColorTexture(GLint internalFormat, GLenum format, GLint cla
   float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 
   glGenTextures(1, &texture.id);
-  glBindTexture(GL_TEXTURE_2D, texture.id);
+  OpenGLState::bindTexture(GL_TEXTURE_2D, texture.id);
   glTexImage2D(GL_TEXTURE_2D, 0, texture.internalFormat, size.width, size.height, 0, texture.format, GL_FLOAT, 0);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -50,17 +64,47 @@ void FrameBuffer::addColorTexture(GLint internalFormat, GLenum format, GLint cla
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clamp);
   glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
   glFramebufferTexture2D(GL_FRAMEBUFFER, texture.attachment, GL_TEXTURE_2D, texture.id, 0);
 
   colorTextures.push_back(texture);
+
+  trackTextureMemory(internalFormat, 1);
+}
+
+void FrameBuffer::addColorTextureArray(GLint internalFormat, GLenum format, unsigned int layers, GLint clamp, GLenum unit) {
+  ColorTexture texture;
+
+  texture.internalFormat = internalFormat;
+  texture.format = format;
+  texture.attachment = GL_COLOR_ATTACHMENT0 + colorTextures.size();
+  texture.unit = unit;
+  texture.target = GL_TEXTURE_2D_ARRAY;
+
+  float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+  glGenTextures(1, &texture.id);
+  OpenGLState::bindTexture(GL_TEXTURE_2D_ARRAY, texture.id);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, texture.internalFormat, size.width, size.height, layers, 0, texture.format, GL_FLOAT, 0);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, clamp);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, clamp);
+  glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glFramebufferTexture(GL_FRAMEBUFFER, texture.attachment, texture.id, 0);
+
+  colorTextures.push_back(texture);
+
+  trackTextureMemory(internalFormat, layers);
 }
 
 void FrameBuffer::addDepthCubeMap(GLenum unit) {
   this->depthCubeMapUnit = unit;
 
   glGenTextures(1, &depthCubeMap);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMap);
+  OpenGLState::bindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMap);
 
   for (unsigned int i = 0; i < 6; i++) {
     glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT, size.width, size.height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
@@ -72,18 +116,100 @@ void FrameBuffer::addDepthCubeMap(GLenum unit) {
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
   glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubeMap, 0);
   glDrawBuffer(GL_NONE);
   glReadBuffer(GL_NONE);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  trackTextureMemory(GL_DEPTH_COMPONENT, 6);
 }
 
 void FrameBuffer::addDepthStencilBuffer() {
   glGenTextures(1, &depthStencilBuffer);
-  glBindTexture(GL_TEXTURE_2D, depthStencilBuffer);
+  OpenGLState::bindTexture(GL_TEXTURE_2D, depthStencilBuffer);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, size.width, size.height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, 0);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_DEPTH_COMPONENT);
   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthStencilBuffer, 0);
+
+  trackTextureMemory(GL_DEPTH24_STENCIL8, 1);
+}
+
+/**
+ * Adds a depth/stencil buffer whose depth values can be sampled
+ * from the provided texture unit while reading. Passes sampling it
+ * mustn't have it attached to their target framebuffer, even with
+ * depth writes disabled, since that's a feedback loop; they should
+ * test against a copy made with blitDepthStencil() instead.
+ */
+void FrameBuffer::addDepthStencilBuffer(GLenum unit) {
+  this->depthStencilUnit = unit;
+
+  addDepthStencilBuffer();
+}
+
+/**
+ * Adds a layered, depth-only attachment for use as a shadow map.
+ * When reading, the texture is bound to the provided unit with
+ * depth comparison enabled, so shaders can take hardware-filtered
+ * PCF samples via sampler2DArrayShadow. The same texture is also
+ * bound to a second unit through a sampler object with comparison
+ * disabled, for shaders which need raw depth values.
+ */
+void FrameBuffer::addDepthTextureArray(unsigned int layers, GLenum unit, GLenum rawDepthUnit) {
+  this->depthTextureArrayUnit = unit;
+  this->rawDepthUnit = rawDepthUnit;
+
+  float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+  glGenTextures(1, &depthTextureArray);
+  OpenGLState::bindTexture(GL_TEXTURE_2D_ARRAY, depthTextureArray);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, size.width, size.height, layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+  glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+  glGenSamplers(1, &rawDepthSampler);
+  glSamplerParameteri(rawDepthSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glSamplerParameteri(rawDepthSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glSamplerParameteri(rawDepthSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+  glSamplerParameteri(rawDepthSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+  glSamplerParameterfv(rawDepthSampler, GL_TEXTURE_BORDER_COLOR, borderColor);
+  glSamplerParameteri(rawDepthSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTextureArray, 0);
+  glDrawBuffer(GL_NONE);
+  glReadBuffer(GL_NONE);
+
+  trackTextureMemory(GL_DEPTH_COMPONENT32F, layers);
+}
+
+/**
+ * Attaches an existing texture which the framebuffer doesn't own,
+ * allowing externally-managed textures to be rendered into. The
+ * texture is not deleted along with the framebuffer.
+ */
+void FrameBuffer::attachColorTexture(GLuint id, GLint internalFormat, GLenum format, GLenum unit) {
+  ColorTexture texture;
+
+  texture.id = id;
+  texture.internalFormat = internalFormat;
+  texture.format = format;
+  texture.attachment = GL_COLOR_ATTACHMENT0 + colorTextures.size();
+  texture.unit = unit;
+  texture.isOwned = false;
+
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, texture.attachment, GL_TEXTURE_2D, texture.id, 0);
+
+  colorTextures.push_back(texture);
 }
 
 void FrameBuffer::bindColorTexture(GLuint attachment) {
@@ -114,32 +240,133 @@ void FrameBuffer::blit(FrameBuffer* target) {
   }
 }
 
+/**
+ * Copies the depth/stencil buffer into the target's, so that a pass
+ * can depth and stencil test against the copy while sampling this
+ * one's depth.
+ */
+void FrameBuffer::blitDepthStencil(FrameBuffer* target) {
+  OpenGLState::bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  target->startWriting();
+
+  glBlitFramebuffer(0, 0, size.width, size.height, 0, 0, target->size.width, target->size.height, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+}
+
 void FrameBuffer::clearColorTexture(GLint attachment) {
   float black[] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
   glClearBufferfv(GL_COLOR, attachment, black);
 }
 
+/**
+ * Returns the storage size of a single texel in the provided format.
+ * Unsized formats are assumed to be stored at 8 bits per channel.
+ */
+unsigned int FrameBuffer::getBytesPerPixel(GLint internalFormat) {
+  switch (internalFormat) {
+    case GL_RGBA32F:
+      return 16;
+    case GL_RGB32F:
+      return 12;
+    case GL_RGBA16F:
+    case GL_RG32F:
+      return 8;
+    case GL_RGB16F:
+      return 6;
+    case GL_RGB:
+    case GL_RGB8:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+void FrameBuffer::generateMipmaps() {
+  for (auto& colorTexture : colorTextures) {
+    OpenGLState::bindTexture(colorTexture.unit, colorTexture.target, colorTexture.id);
+    glTexParameteri(colorTexture.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glGenerateMipmap(colorTexture.target);
+  }
+}
+
+GLuint FrameBuffer::getColorTextureId(unsigned int index) const {
+  return colorTextures[index].id;
+}
+
+const Area<unsigned int>& FrameBuffer::getSize() const {
+  return size;
+}
+
 void FrameBuffer::shareDepthStencilBuffer(FrameBuffer* target) {
-  glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+  OpenGLState::bindFramebuffer(GL_FRAMEBUFFER, target->fbo);
   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthStencilBuffer, 0);
 }
 
 void FrameBuffer::startReading() {
   for (int i = 0; i < colorTextures.size(); i++) {
-    glActiveTexture(colorTextures[i].unit);
-    glBindTexture(GL_TEXTURE_2D, colorTextures[i].id);
+    OpenGLState::bindTexture(colorTextures[i].unit, colorTextures[i].target, colorTextures[i].id);
+  }
+
+  if (depthStencilUnit > 0) {
+    OpenGLState::bindTexture(depthStencilUnit, GL_TEXTURE_2D, depthStencilBuffer);
   }
 
   if (depthCubeMap > 0) {
-    glActiveTexture(depthCubeMapUnit);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMap);
+    OpenGLState::bindTexture(depthCubeMapUnit, GL_TEXTURE_CUBE_MAP, depthCubeMap);
   }
 
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  if (depthTextureArray > 0) {
+    OpenGLState::bindTexture(depthTextureArrayUnit, GL_TEXTURE_2D_ARRAY, depthTextureArray);
+    OpenGLState::bindTexture(rawDepthUnit, GL_TEXTURE_2D_ARRAY, depthTextureArray);
+    OpenGLState::bindSampler(rawDepthUnit - GL_TEXTURE0, rawDepthSampler);
+  }
+
+  OpenGLState::bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
 }
 
 void FrameBuffer::startWriting() {
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
-  glViewport(0, 0, size.width, size.height);
+  OpenGLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+  OpenGLState::viewport(0, 0, size.width, size.height);
+}
+
+/**
+ * Attaches every layer of any layered attachments, so geometry
+ * shaders can route primitives to layers via gl_Layer.
+ */
+void FrameBuffer::trackTextureMemory(GLint internalFormat, unsigned int layers) {
+  uint64_t bytes = (uint64_t)size.width * size.height * layers * getBytesPerPixel(internalFormat);
+
+  MemoryTracker::trackAllocation(memoryTag, bytes);
+
+  totalTrackedBytes += bytes;
 }
+
+void FrameBuffer::writeToAllLayers() {
+  OpenGLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+
+  for (auto& colorTexture : colorTextures) {
+    glFramebufferTexture(GL_DRAW_FRAMEBUFFER, colorTexture.attachment, colorTexture.id, 0);
+  }
+
+  if (depthTextureArray > 0) {
+    glFramebufferTexture(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTextureArray, 0);
+  }
+}
+
+/**
+ * Attaches a single layer of any layered attachments, directing
+ * all subsequent non-layered rendering to that layer.
+ */
+void FrameBuffer::writeToLayer(unsigned int layer) {
+  OpenGLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+
+  for (auto& colorTexture : colorTextures) {
+    if (colorTexture.target == GL_TEXTURE_2D_ARRAY) {
+      glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, colorTexture.attachment, colorTexture.id, 0, layer);
+    }
+  }
+
+  if (depthTextureArray > 0) {
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTextureArray, 0, layer);
+  }
+}
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "glew.h"
 #include "glut.h"
 #include "subsystem/Math.h"
+#include "subsystem/MemoryTracker.h"
 
 struct ColorTexture {
   unsigned int internalFormat;
@@ -12,31 +13,54 @@ struct ColorTexture {
   GLuint id;
   GLuint attachment;
   GLenum unit;
+  GLenum target = GL_TEXTURE_2D;
+  bool isOwned = true;
 };
 
 class FrameBuffer {
 public:
-  FrameBuffer(int width, int height);
+  FrameBuffer(int width, int height, MemoryTag memoryTag = MemoryTag::GPU_RENDER_TARGETS);
   ~FrameBuffer();
 
+  static unsigned int getBytesPerPixel(GLint internalFormat);
+
   void addColorTexture(GLint internalFormat, GLenum format);
   void addColorTexture(GLint internalFormat, GLenum format, GLint clamp);
   void addColorTexture(GLint internalFormat, GLenum format, GLint clamp, GLenum unit);
+  void addColorTextureArray(GLint internalFormat, GLenum format, unsigned int layers, GLint clamp, GLenum unit);
   void addDepthCubeMap(GLenum unit);
   void addDepthStencilBuffer();
+  void addDepthStencilBuffer(GLenum unit);
+  void addDepthTextureArray(unsigned int layers, GLenum unit, GLenum rawDepthUnit);
+  void attachColorTexture(GLuint id, GLint internalFormat, GLenum format, GLenum unit);
   void bindColorTexture(GLenum attachment);
   void bindColorTextures();
   void blit(FrameBuffer* target);
+  void blitDepthStencil(FrameBuffer* target);
   void clearColorTexture(GLint attachment);
+  void generateMipmaps();
+  GLuint getColorTextureId(unsigned int index) const;
+  const Area<unsigned int>& getSize() const;
   void shareDepthStencilBuffer(FrameBuffer* target);
   void startReading();
   void startWriting();
+  void writeToAllLayers();
+  void writeToLayer(unsigned int layer);
 
 private:
   GLuint fbo = 0;
   GLuint depthStencilBuffer = 0;
+  GLenum depthStencilUnit = 0;
+  GLuint depthTextureArray = 0;
+  GLenum depthTextureArrayUnit;
+  GLuint rawDepthSampler = 0;
+  GLenum rawDepthUnit;
   GLuint depthCubeMap = 0;
   GLenum depthCubeMapUnit;
   std::vector<ColorTexture> colorTextures;
   Area<unsigned int> size;
+  MemoryTag memoryTag;
+  uint64_t totalTrackedBytes = 0;
+
+  void trackTextureMemory(GLint internalFormat, unsigned int layers);
 };
\ No newline at end of file
@@ -1,13 +1,22 @@
 #include "opengl/GBuffer.h"
 #include "opengl/ShaderLoader.h"
 #include "opengl/OpenGLScreenQuad.h"
+#include "opengl/OpenGLObject.h"
 
 GBuffer::GBuffer() {
   createShaderPrograms();
 }
 
 GBuffer::~GBuffer() {
-  // TODO
+  delete depthStencilCopy;
+}
+
+/**
+ * Refreshes the depth/stencil copy from the G-Buffer's, once the
+ * geometry pass has written it.
+ */
+void GBuffer::copyDepthStencil() {
+  frameBuffer->blitDepthStencil(depthStencilCopy);
 }
 
 void GBuffer::createFrameBuffer(unsigned int width, unsigned int height) {
@@ -15,41 +24,55 @@ void GBuffer::createFrameBuffer(unsigned int width, unsigned int height) {
     delete frameBuffer;
   }
 
+  if (depthStencilCopy != nullptr) {
+    delete depthStencilCopy;
+  }
+
   frameBuffer = new FrameBuffer(width, height);
 
-  frameBuffer->addColorTexture(GL_RGB32F, GL_RGB, GL_CLAMP_TO_BORDER, GL_TEXTURE0);     // Color
-  frameBuffer->addColorTexture(GL_RGBA32F, GL_RGBA, GL_CLAMP_TO_BORDER, GL_TEXTURE1);   // Normal/depth
-  frameBuffer->addColorTexture(GL_RGB32F, GL_RGB, GL_CLAMP_TO_BORDER, GL_TEXTURE2);     // Position
-  frameBuffer->addDepthStencilBuffer();
+  // Positions and view depths aren't stored, and are instead
+  // reconstructed from the depth buffer by consuming shaders
+  frameBuffer->addColorTexture(GL_RGBA8, GL_RGBA, GL_CLAMP_TO_BORDER, GL_TEXTURE0);     // Color/flags
+  frameBuffer->addColorTexture(GL_RG16, GL_RG, GL_CLAMP_TO_BORDER, GL_TEXTURE1);        // Octahedral normal
+  frameBuffer->addDepthStencilBuffer(GL_TEXTURE2);                                      // Depth
   frameBuffer->bindColorTextures();
+
+  // Passes reading the G-Buffer sample its depth, so they depth and
+  // stencil test against this copy rather than the original
+  depthStencilCopy = new FrameBuffer(width, height);
+  depthStencilCopy->addDepthStencilBuffer();
+
+  glDrawBuffer(GL_NONE);
+  glReadBuffer(GL_NONE);
 }
 
 void GBuffer::createShaderPrograms() {
-  geometryProgram.create();
-  geometryProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/geometry.vertex.glsl"));
-  geometryProgram.attachShader(ShaderLoader::loadFragmentShader("./shaders/geometry.fragment.glsl"));
-  geometryProgram.link();
+  geometryPrograms.setVertexShader("./shaders/geometry.vertex.glsl");
+  geometryPrograms.setFragmentShader("./shaders/geometry.fragment.glsl");
+  geometryPrograms.addDefine(VARIANT_TREE_ANIMATION, "TREE_ANIMATION");
+  geometryPrograms.addDefine(VARIANT_GRASS_ANIMATION, "GRASS_ANIMATION");
+  geometryPrograms.addDefine(VARIANT_TEXTURE, "HAS_TEXTURE");
+  geometryPrograms.addDefine(VARIANT_NORMAL_MAP, "HAS_NORMAL_MAP");
+  geometryPrograms.addDefine(VARIANT_EMISSIVE, "IS_EMISSIVE");
 
   illuminationProgram.create();
   illuminationProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/lighting-quad.vertex.glsl"));
   illuminationProgram.attachShader(ShaderLoader::loadFragmentShader("./shaders/illumination.fragment.glsl"));
   illuminationProgram.link();
+}
+
+FrameBuffer* GBuffer::getDepthStencilCopy() {
+  return depthStencilCopy;
+}
 
-  albedoProgram.create();
-  albedoProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/quad.vertex.glsl"));
-  albedoProgram.attachShader(ShaderLoader::loadFragmentShader("./shaders/albedo.fragment.glsl"));
-  albedoProgram.link();
+ShaderProgramVariants& GBuffer::getGeometryPrograms() {
+  return geometryPrograms;
 }
 
 ShaderProgram& GBuffer::getShaderProgram(GBuffer::Shader shader) {
   switch (shader) {
-    case GBuffer::Shader::GEOMETRY:
-      return geometryProgram;
     case GBuffer::Shader::ILLUMINATION:
-      return illuminationProgram;
-    case GBuffer::Shader::ALBEDO:
-      return albedoProgram;
     default:
-      return geometryProgram;
+      return illuminationProgram;
   }
 }
@@ -6,26 +6,28 @@
 #include "opengl/FrameBuffer.h"
 #include "opengl/OpenGLScreenQuad.h"
 #include "opengl/ShaderProgram.h"
+#include "opengl/ShaderProgramVariants.h"
 #include "subsystem/Math.h"
 
 class GBuffer : public AbstractBuffer {
 public:
   enum Shader {
-    GEOMETRY,
-    ILLUMINATION,
-    ALBEDO
+    ILLUMINATION
   };
 
   GBuffer();
   ~GBuffer();
 
+  void copyDepthStencil();
   void createFrameBuffer(unsigned int width, unsigned int height) override;
+  FrameBuffer* getDepthStencilCopy();
+  ShaderProgramVariants& getGeometryPrograms();
   ShaderProgram& getShaderProgram(GBuffer::Shader shader);
 
 private:
-  ShaderProgram geometryProgram;
+  FrameBuffer* depthStencilCopy = nullptr;
+  ShaderProgramVariants geometryPrograms;
   ShaderProgram illuminationProgram;
-  ShaderProgram albedoProgram;
 
   void createShaderPrograms();
 };
\ No newline at end of file
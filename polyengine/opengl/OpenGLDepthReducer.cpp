@@ -0,0 +1,102 @@
+#include <cfloat>
+#include <cstring>
+
+#include "opengl/OpenGLDepthReducer.h"
+#include "opengl/OpenGLState.h"
+#include "opengl/ShaderLoader.h"
+#include "subsystem/MemoryTracker.h"
+#include "subsystem/PerformanceProfiler.h"
+
+OpenGLDepthReducer::OpenGLDepthReducer() {
+  reductionProgram.create();
+  reductionProgram.attachShader(ShaderLoader::loadComputeShader("./shaders/depth-reduction.compute.glsl"));
+  reductionProgram.link();
+
+  glGenBuffers(1, &ssbo);
+  OpenGLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, 2 * sizeof(GLuint), 0, GL_DYNAMIC_READ);
+
+  MemoryTracker::trackAllocation(MemoryTag::GPU_UNIFORMS, 2 * sizeof(GLuint));
+
+  resetDepthRange();
+}
+
+OpenGLDepthReducer::~OpenGLDepthReducer() {
+  if (fence != nullptr) {
+    glDeleteSync(fence);
+  }
+
+  OpenGLState::deleteBuffers(1, &ssbo);
+
+  MemoryTracker::trackFree(MemoryTag::GPU_UNIFORMS, 2 * sizeof(GLuint));
+}
+
+const Range<float>& OpenGLDepthReducer::getDepthRange() const {
+  return depthRange;
+}
+
+/**
+ * Reads back the results of the previous reduction. Depths are
+ * stored as the bit patterns of positive floats, which sort the
+ * same way as the floats themselves, allowing the compute shader
+ * to use integer atomics.
+ */
+void OpenGLDepthReducer::readDepthRange() {
+  GLuint depthBits[2];
+
+  OpenGLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(depthBits), depthBits);
+
+  if (depthBits[1] == 0) {
+    // No visible surfaces were found; keep the last known range
+    return;
+  }
+
+  memcpy(&depthRange.start, &depthBits[0], sizeof(float));
+  memcpy(&depthRange.end, &depthBits[1], sizeof(float));
+}
+
+/**
+ * Dispatches a new depth reduction over the currently bound
+ * G-Buffer depth texture. If the previous reduction is
+ * still in flight, this frame's dispatch is skipped rather than
+ * waiting on it.
+ */
+void OpenGLDepthReducer::reduce(unsigned int width, unsigned int height) {
+  if (fence != nullptr) {
+    GLenum status = glClientWaitSync(fence, 0, 0);
+
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+      return;
+    }
+
+    glDeleteSync(fence);
+
+    fence = nullptr;
+
+    readDepthRange();
+  }
+
+  resetDepthRange();
+
+  reductionProgram.use();
+  reductionProgram.setInt("depthTexture", 2);
+
+  OpenGLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo);
+  glDispatchCompute((width + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, (height + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1);
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void OpenGLDepthReducer::resetDepthRange() {
+  float maxFloat = FLT_MAX;
+  GLuint depthBits[2] = { 0, 0 };
+
+  memcpy(&depthBits[0], &maxFloat, sizeof(float));
+
+  OpenGLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(depthBits), depthBits);
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::BYTES_UPLOADED, sizeof(depthBits));
+}
\ No newline at end of file
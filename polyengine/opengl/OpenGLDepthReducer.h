@@ -0,0 +1,33 @@
+#pragma once
+
+#include "glew.h"
+#include "glut.h"
+#include "opengl/ShaderProgram.h"
+#include "subsystem/Math.h"
+
+/**
+ * Reduces the G-Buffer's depth buffer to the minimum and maximum
+ * view depths of all visible surfaces using a compute shader.
+ * Results are read back once the GPU has finished producing them,
+ * typically one frame later, so the reduction never stalls the
+ * pipeline.
+ */
+class OpenGLDepthReducer {
+public:
+  OpenGLDepthReducer();
+  ~OpenGLDepthReducer();
+
+  const Range<float>& getDepthRange() const;
+  void reduce(unsigned int width, unsigned int height);
+
+private:
+  const static unsigned int WORK_GROUP_SIZE = 16;
+
+  ShaderProgram reductionProgram;
+  GLuint ssbo = 0;
+  GLsync fence = nullptr;
+  Range<float> depthRange = { 1.0f, 2500.0f };
+
+  void readDepthRange();
+  void resetDepthRange();
+};
\ No newline at end of file
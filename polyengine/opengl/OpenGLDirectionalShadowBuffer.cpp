@@ -6,16 +6,18 @@ void OpenGLDirectionalShadowBuffer::createFrameBuffer(unsigned int width, unsign
     delete frameBuffer;
   }
 
-  frameBuffer = new FrameBuffer(width, height);
+  frameBuffer = new FrameBuffer(width, height, MemoryTag::GPU_SHADOW_MAPS);
 
-  frameBuffer->addColorTexture(GL_R32F, GL_RED, GL_CLAMP_TO_BORDER, GL_TEXTURE3);   // Shadow map cascade 0
-  frameBuffer->addColorTexture(GL_R32F, GL_RED, GL_CLAMP_TO_BORDER, GL_TEXTURE4);   // Shadow map cascade 1
-  frameBuffer->addColorTexture(GL_R32F, GL_RED, GL_CLAMP_TO_BORDER, GL_TEXTURE5);   // Shadow map cascade 2
-  frameBuffer->addColorTexture(GL_R32F, GL_RED, GL_CLAMP_TO_BORDER, GL_TEXTURE6);   // Shadow map cascade 3
-  frameBuffer->addDepthStencilBuffer();
-  frameBuffer->bindColorTextures();
+  // Each shadow map cascade is stored as a layer of the same
+  // depth texture array, so cascades can be rendered either one
+  // at a time or all at once via layered rendering
+  frameBuffer->addDepthTextureArray(4, GL_TEXTURE3, GL_TEXTURE4);
+}
+
+void OpenGLDirectionalShadowBuffer::writeToAllShadowCascades() {
+  frameBuffer->writeToAllLayers();
 }
 
 void OpenGLDirectionalShadowBuffer::writeToShadowCascade(unsigned int cascadeIndex) {
-  frameBuffer->bindColorTexture(GL_COLOR_ATTACHMENT0 + cascadeIndex);
+  frameBuffer->writeToLayer(cascadeIndex);
 }
\ No newline at end of file
@@ -5,5 +5,6 @@
 class OpenGLDirectionalShadowBuffer : public AbstractBuffer {
 public:
   void createFrameBuffer(unsigned int width, unsigned int height) override;
+  void writeToAllShadowCascades();
   void writeToShadowCascade(unsigned int cascadeIndex);
 };
\ No newline at end of file
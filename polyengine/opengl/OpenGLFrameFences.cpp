@@ -0,0 +1,51 @@
+#include <chrono>
+
+#include "opengl/OpenGLFrameFences.h"
+#include "subsystem/ZoneProfiler.h"
+
+OpenGLFrameFences::~OpenGLFrameFences() {
+  for (auto& fence : fences) {
+    if (fence != nullptr) {
+      glDeleteSync(fence);
+    }
+  }
+}
+
+/**
+ * Marks the end of the current frame's commands.
+ */
+void OpenGLFrameFences::signal() {
+  fences[currentFrame % MAX_FRAMES_IN_FLIGHT] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  currentFrame++;
+}
+
+/**
+ * Blocks until the GPU has finished the frame which last used the
+ * current slot, returning how long that took in milliseconds.
+ */
+float OpenGLFrameFences::wait() {
+  auto& fence = fences[currentFrame % MAX_FRAMES_IN_FLIGHT];
+
+  if (fence == nullptr) {
+    return 0.0f;
+  }
+
+  PROFILE_ZONE("OpenGLFrameFences::wait");
+
+  auto start = std::chrono::high_resolution_clock::now();
+  GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+  // Only flush on the first attempt; afterwards, wait in 1ms steps
+  while (result == GL_TIMEOUT_EXPIRED) {
+    result = glClientWaitSync(fence, 0, 1000000);
+  }
+
+  glDeleteSync(fence);
+
+  fence = nullptr;
+
+  std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+
+  return duration.count();
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "glew.h"
+#include "glut.h"
+
+/**
+ * Limits how many frames the GPU may fall behind the CPU. A fence
+ * is inserted after each frame's commands, and before submitting a
+ * new frame, the CPU only waits for the fence of the frame which
+ * last used the same slot. Up to MAX_FRAMES_IN_FLIGHT frames can be
+ * queued, so the CPU prepares the next frame while the GPU is still
+ * executing the previous one, yet input latency stays bounded.
+ */
+class OpenGLFrameFences {
+public:
+  constexpr static unsigned int MAX_FRAMES_IN_FLIGHT = 2;
+
+  ~OpenGLFrameFences();
+
+  void signal();
+  float wait();
+
+private:
+  GLsync fences[MAX_FRAMES_IN_FLIGHT] = { nullptr };
+  unsigned int currentFrame = 0;
+};
\ No newline at end of file
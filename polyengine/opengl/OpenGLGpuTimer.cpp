@@ -0,0 +1,156 @@
+#include <cstring>
+
+#include "opengl/OpenGLGpuTimer.h"
+#include "subsystem/PerformanceProfiler.h"
+
+void OpenGLGpuTimer::begin(const char* name) {
+  auto& frame = frames[currentFrame % FRAME_LATENCY];
+  GpuScope scope;
+
+  scope.name = name;
+  scope.depth = (unsigned int)openScopes.size();
+  scope.startQuery = issueTimestamp();
+  scope.endQuery = 0;
+
+  openScopes.push_back((unsigned int)frame.scopes.size());
+  frame.scopes.push_back(scope);
+}
+
+/**
+ * Reads back the timings of the frame last submitted in this frame's
+ * slot, and starts reusing its queries. GPU timestamps are offset
+ * onto the ZoneProfiler's clock using the GPU's current time.
+ */
+void OpenGLGpuTimer::beginFrame() {
+  auto& frame = frames[currentFrame % FRAME_LATENCY];
+  GLint64 gpuTime = 0;
+
+  if (frame.isPending) {
+    readFrame(frame);
+  }
+
+  glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+
+  frame.scopes.clear();
+  frame.totalUsedQueries = 0;
+  frame.clockOffset = (int64_t)ZoneProfiler::now() - gpuTime;
+  frame.isPending = false;
+
+  openScopes.clear();
+}
+
+void OpenGLGpuTimer::end() {
+  auto& frame = frames[currentFrame % FRAME_LATENCY];
+
+  frame.scopes[openScopes.back()].endQuery = issueTimestamp();
+
+  openScopes.pop_back();
+}
+
+void OpenGLGpuTimer::endFrame() {
+  frames[currentFrame % FRAME_LATENCY].isPending = true;
+
+  currentFrame++;
+}
+
+/**
+ * Deletes every query, e.g. before the context is destroyed.
+ */
+void OpenGLGpuTimer::free() {
+  for (auto& frame : frames) {
+    if (frame.queries.size() > 0) {
+      glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+    }
+
+    frame.queries.clear();
+    frame.scopes.clear();
+    frame.totalUsedQueries = 0;
+    frame.isPending = false;
+  }
+
+  openScopes.clear();
+}
+
+GLuint OpenGLGpuTimer::issueTimestamp() {
+  auto& frame = frames[currentFrame % FRAME_LATENCY];
+
+  if (frame.totalUsedQueries == frame.queries.size()) {
+    GLuint query = 0;
+
+    glGenQueries(1, &query);
+
+    frame.queries.push_back(query);
+  }
+
+  GLuint query = frame.queries[frame.totalUsedQueries++];
+
+  glQueryCounter(query, GL_TIMESTAMP);
+
+  return query;
+}
+
+/**
+ * Reports each scope's time, summing scopes which share a name, e.g.
+ * the repeated passes of a downsample chain. Queries complete in
+ * submission order, so once the last is available, all of them are.
+ */
+void OpenGLGpuTimer::readFrame(GpuFrame& frame) {
+  if (frame.totalUsedQueries == 0) {
+    return;
+  }
+
+  GLint isAvailable = 0;
+
+  glGetQueryObjectiv(frame.queries[frame.totalUsedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+
+  if (!isAvailable) {
+    return;
+  }
+
+  if (gpuTrack == nullptr) {
+    gpuTrack = ZoneProfiler::createTrack("GPU");
+  }
+
+  passTimes.clear();
+
+  for (auto& scope : frame.scopes) {
+    if (scope.endQuery == 0) {
+      continue;
+    }
+
+    GLuint64 start = 0;
+    GLuint64 end = 0;
+
+    glGetQueryObjectui64v(scope.startQuery, GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &end);
+
+    float milliseconds = (end - start) / 1000000.0f;
+    bool isNewPass = true;
+
+    for (auto& passTime : passTimes) {
+      if (strcmp(passTime.first, scope.name) == 0) {
+        passTime.second += milliseconds;
+        isNewPass = false;
+        break;
+      }
+    }
+
+    if (isNewPass) {
+      passTimes.push_back({ scope.name, milliseconds });
+    }
+
+    if (ZoneProfiler::isEnabled()) {
+      ZoneProfiler::recordZone(gpuTrack, scope.name, start + frame.clockOffset, end + frame.clockOffset, scope.depth);
+    }
+  }
+
+  for (auto& passTime : passTimes) {
+    PerformanceProfiler::trackGpuPassTime(passTime.first, passTime.second);
+  }
+}
+
+OpenGLGpuTimer::GpuFrame OpenGLGpuTimer::frames[OpenGLGpuTimer::FRAME_LATENCY];
+unsigned int OpenGLGpuTimer::currentFrame = 0;
+std::vector<unsigned int> OpenGLGpuTimer::openScopes;
+std::vector<std::pair<const char*, float>> OpenGLGpuTimer::passTimes;
+ZoneBuffer* OpenGLGpuTimer::gpuTrack = nullptr;
\ No newline at end of file
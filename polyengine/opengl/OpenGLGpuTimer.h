@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "glew.h"
+#include "glut.h"
+#include "subsystem/ZoneProfiler.h"
+
+/**
+ * Times the enclosing scope on the GPU under the given name, which
+ * must outlive the profiler in the same way as PROFILE_ZONE names.
+ */
+#define PROFILE_GPU_ZONE(name) ScopedGpuTimer PROFILE_ZONE_CONCAT(__gpuZone, __LINE__)(name)
+
+/**
+ * Measures GPU time spent in named, nestable scopes with timestamp
+ * queries. Each frame's queries are only read back once the frame
+ * has cycled back around, a few frames later, by which point they've
+ * almost always completed; any which haven't are dropped rather than
+ * waited on, so timing never stalls the pipeline.
+ *
+ * Results are reported to the PerformanceProfiler per scope name,
+ * and while the ZoneProfiler is running, to a GPU track aligned with
+ * the CPU zones.
+ */
+class OpenGLGpuTimer {
+public:
+  static void begin(const char* name);
+  static void beginFrame();
+  static void end();
+  static void endFrame();
+  static void free();
+
+private:
+  constexpr static unsigned int FRAME_LATENCY = 3;
+
+  struct GpuScope {
+    const char* name;
+    unsigned int depth;
+    GLuint startQuery;
+    GLuint endQuery;
+  };
+
+  struct GpuFrame {
+    std::vector<GpuScope> scopes;
+    std::vector<GLuint> queries;
+    unsigned int totalUsedQueries = 0;
+    int64_t clockOffset = 0;
+    bool isPending = false;
+  };
+
+  static GpuFrame frames[FRAME_LATENCY];
+  static unsigned int currentFrame;
+  static std::vector<unsigned int> openScopes;
+  static std::vector<std::pair<const char*, float>> passTimes;
+  static ZoneBuffer* gpuTrack;
+
+  static GLuint issueTimestamp();
+  static void readFrame(GpuFrame& frame);
+};
+
+/**
+ * Times its own lifetime on the GPU.
+ */
+class ScopedGpuTimer {
+public:
+  ScopedGpuTimer(const char* name) {
+    OpenGLGpuTimer::begin(name);
+  }
+
+  ~ScopedGpuTimer() {
+    OpenGLGpuTimer::end();
+  }
+};
\ No newline at end of file
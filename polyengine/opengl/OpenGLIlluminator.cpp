@@ -1,34 +1,40 @@
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <vector>
 
 #include "opengl/OpenGLIlluminator.h"
 #include "opengl/OpenGLDebugger.h"
+#include "opengl/OpenGLGpuTimer.h"
 #include "opengl/OpenGLScreenQuad.h"
 #include "opengl/OpenGLDirectionalShadowBuffer.h"
 #include "opengl/OpenGLSpotShadowBuffer.h"
 #include "opengl/OpenGLPointShadowBuffer.h"
+#include "opengl/OpenGLState.h"
 #include "opengl/ShaderLoader.h"
 #include "subsystem/entities/Object.h"
 #include "subsystem/entities/Light.h"
 #include "subsystem/entities/Camera.h"
 #include "subsystem/PerformanceProfiler.h"
+#include "subsystem/Window.h"
+#include "subsystem/ZoneProfiler.h"
 
 static bool isActiveDirectionalShadowCaster(const OpenGLShadowCaster* glShadowCaster) {
   return (
-    glShadowCaster->getSourceLight()->type == Light::LightType::DIRECTIONAL &&
-    glShadowCaster->getSourceLight()->power > 0.0f
+    glShadowCaster->getLight()->type == Light::LightType::DIRECTIONAL &&
+    glShadowCaster->getLight()->power > 0.0f
   );
 };
 
 static bool isActiveSpotShadowCaster(const OpenGLShadowCaster* glShadowCaster) {
   return (
-    glShadowCaster->getSourceLight()->type == Light::LightType::SPOTLIGHT &&
-    glShadowCaster->getSourceLight()->power > 0.0f
+    glShadowCaster->getLight()->type == Light::LightType::SPOTLIGHT &&
+    glShadowCaster->getLight()->power > 0.0f
   );
 };
 
 static bool isActivePointShadowCaster(const OpenGLShadowCaster* glShadowCaster) {
-  auto* light = glShadowCaster->getSourceLight();
+  auto* light = glShadowCaster->getLight();
 
   return (
     light->type == Light::LightType::POINT &&
@@ -39,35 +45,83 @@ static bool isActivePointShadowCaster(const OpenGLShadowCaster* glShadowCaster)
   );
 };
 
-static bool isObjectWithinLightRadius(const Object* object, const Light* light) {
-  return (
-    std::abs(object->position.x - light->position.x) < light->radius &&
-    std::abs(object->position.y - light->position.y) < light->radius &&
-    std::abs(object->position.z - light->position.z) < light->radius
-  );
+static const char* getCascadeRenderModeName(OpenGLIlluminator::CascadeRenderMode mode) {
+  return mode == OpenGLIlluminator::CascadeRenderMode::SINGLE_PASS ? "single-pass" : "multi-pass";
 }
 
 OpenGLIlluminator::OpenGLIlluminator() {
   glLightingQuad = new OpenGLLightingQuad();
+  glDepthReducer = new OpenGLDepthReducer();
+  lightConstantsBuffer = new OpenGLUniformBuffer(UniformBlockBinding::LIGHT_CONSTANTS_BINDING, sizeof(LightConstants));
 
   createShaderPrograms();
 }
 
 OpenGLIlluminator::~OpenGLIlluminator() {
   delete glLightingQuad;
+  delete glDepthReducer;
+  delete lightConstantsBuffer;
 }
 
-void OpenGLIlluminator::createShaderPrograms() {
-  lightViewProgram.create();
-  lightViewProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/lightview.vertex.glsl"));
-  lightViewProgram.attachShader(ShaderLoader::loadFragmentShader("./shaders/lightview.fragment.glsl"));
-  lightViewProgram.link();
+void OpenGLIlluminator::bindLightConstants(OpenGLShadowCaster* glShadowCaster) {
+  lightConstantsBuffer->bind(glShadowCaster->getLightConstantSlot());
+}
+
+/**
+ * Sorts active shadowcasters by light type. Whenever there are
+ * multiple active point shadowcasters, their light views are rendered
+ * on a rotating basis - the active one determined by the current
+ * frame - to reduce per-frame rendering work. This may result in a
+ * reduced apparent "shadow framerate" if too many are grouped
+ * together in close proximity.
+ *
+ * TODO: Allow point lights to override the active index check and
+ * update their shadow map every frame.
+ */
+void OpenGLIlluminator::collectShadowCasters() {
+  directionalShadowCasters.clear();
+  spotShadowCasters.clear();
+  pointShadowCasters.clear();
+
+  for (auto* glShadowCaster : glVideoController->glShadowCasters) {
+    if (isActiveDirectionalShadowCaster(glShadowCaster)) {
+      directionalShadowCasters.push_back(glShadowCaster);
+    } else if (isActiveSpotShadowCaster(glShadowCaster)) {
+      spotShadowCasters.push_back(glShadowCaster);
+    } else if (isActivePointShadowCaster(glShadowCaster)) {
+      pointShadowCasters.push_back(glShadowCaster);
+    }
+  }
+
+  activePointShadowCaster = pointShadowCasters.size() > 0
+    ? pointShadowCasters[PerformanceProfiler::getCurrentFrame() % pointShadowCasters.size()]
+    : nullptr;
+}
 
-  pointLightViewProgram.create();
-  pointLightViewProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/point-lightview.vertex.glsl"));
-  pointLightViewProgram.attachShader(ShaderLoader::loadGeometryShader("./shaders/point-lightview.geometry.glsl"));
-  pointLightViewProgram.attachShader(ShaderLoader::loadFragmentShader("./shaders/point-lightview.fragment.glsl"));
-  pointLightViewProgram.link();
+void OpenGLIlluminator::createShaderPrograms() {
+  lightViewPrograms.setVertexShader("./shaders/lightview.vertex.glsl");
+  lightViewPrograms.setFragmentShader("./shaders/lightview.fragment.glsl");
+  lightViewPrograms.addDefine(VARIANT_TREE_ANIMATION, "TREE_ANIMATION");
+  lightViewPrograms.addDefine(VARIANT_GRASS_ANIMATION, "GRASS_ANIMATION");
+  lightViewPrograms.addDefine(VARIANT_TEXTURE, "HAS_TEXTURE");
+
+  layeredLightViewPrograms.setVertexShader("./shaders/directional-lightview.vertex.glsl");
+  layeredLightViewPrograms.setGeometryShader("./shaders/directional-lightview.geometry.glsl");
+  layeredLightViewPrograms.setFragmentShader("./shaders/lightview.fragment.glsl");
+  layeredLightViewPrograms.addDefine(VARIANT_TREE_ANIMATION, "TREE_ANIMATION");
+  layeredLightViewPrograms.addDefine(VARIANT_GRASS_ANIMATION, "GRASS_ANIMATION");
+  layeredLightViewPrograms.addDefine(VARIANT_TEXTURE, "HAS_TEXTURE");
+
+  pointLightViewPrograms.setVertexShader("./shaders/point-lightview.vertex.glsl");
+  pointLightViewPrograms.setGeometryShader("./shaders/point-lightview.geometry.glsl");
+  pointLightViewPrograms.setFragmentShader("./shaders/point-lightview.fragment.glsl");
+  pointLightViewPrograms.addDefine(VARIANT_TREE_ANIMATION, "TREE_ANIMATION");
+  pointLightViewPrograms.addDefine(VARIANT_GRASS_ANIMATION, "GRASS_ANIMATION");
+
+  shadowMomentsProgram.create();
+  shadowMomentsProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/quad.vertex.glsl"));
+  shadowMomentsProgram.attachShader(ShaderLoader::loadFragmentShader("./shaders/shadow-moments.fragment.glsl"));
+  shadowMomentsProgram.link();
 
   directionalCameraViewProgram.create();
   directionalCameraViewProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/quad.vertex.glsl"));
@@ -85,107 +139,341 @@ void OpenGLIlluminator::createShaderPrograms() {
   pointCameraViewProgram.link();
 }
 
-void OpenGLIlluminator::renderNonShadowCasterLights() {
-  auto& illuminationProgram = glVideoController->gBuffer->getShaderProgram(GBuffer::Shader::ILLUMINATION);
-
-  illuminationProgram.use();
-
-  glDisable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_STENCIL_TEST);
-  glStencilFunc(GL_EQUAL, 1, 0xFF);
-  glEnable(GL_BLEND);
+OpenGLIlluminator::CascadeRenderMode OpenGLIlluminator::getCascadeRenderMode() const {
+  return cascadeRenderMode;
+}
 
-  auto* scene = glVideoController->scene;
-  auto& lights = scene->getStage().getLights();
+/**
+ * Takes what rendering the frame's lights needs from the scene: each
+ * shadowcaster's light, and the packed non-shadowcaster lights. Must
+ * be called before the frame's light views are recorded.
+ */
+void OpenGLIlluminator::prepareLights() {
+  PROFILE_ZONE("OpenGLIlluminator::prepareLights");
 
-  illuminationProgram.setInt("colorTexture", 0);
-  illuminationProgram.setInt("normalDepthTexture", 1);
-  illuminationProgram.setInt("positionTexture", 2);
-  illuminationProgram.setVec3f("cameraPosition", scene->getCamera().position);
+  for (auto* glShadowCaster : glVideoController->glShadowCasters) {
+    glShadowCaster->snapshotLight();
+  }
 
-  std::vector<Light*> nonShadowCasterLights;
+  nonShadowCasterLights.clear();
 
-  for (auto* light : lights) {
+  for (auto* light : glVideoController->scene->getStage().getLights()) {
     if (light->power > 0.0f && !light->canCastShadows) {
       nonShadowCasterLights.push_back(light);
     }
   }
 
-  glLightingQuad->render(nonShadowCasterLights);
+  for (auto& light : glVideoController->scene->getStage().getWorld().getLights()) {
+    if (light.power > 0.0f) {
+      nonShadowCasterLights.push_back(&light);
+    }
+  }
 
-  glDisable(GL_BLEND);
+  glLightingQuad->prepare(nonShadowCasterLights, glVideoController->frameCamera);
 }
 
-void OpenGLIlluminator::renderShadowCasterLights() {
-  auto& glShadowCasters = glVideoController->glShadowCasters;
-  std::vector<OpenGLShadowCaster*> directionalShadowCasters;
-  std::vector<OpenGLShadowCaster*> spotShadowCasters;
-  std::vector<OpenGLShadowCaster*> pointShadowCasters;
+/**
+ * Queues every shadowcasting object for a light view pass, grouped
+ * by program variant and textures. Directional light view objects
+ * are grouped by cascade limit first, while spot and point light
+ * view objects are ordered front to back from the light.
+ */
+void OpenGLIlluminator::queueLightViewObjects(OpenGLRenderQueue& queue, RenderPass pass, ShaderProgramVariants& programs, const Light* light) {
+  bool isDirectional = pass == RenderPass::DIRECTIONAL_SHADOW_PASS;
 
-  for (auto* glShadowCaster : glShadowCasters) {
-    if (isActiveDirectionalShadowCaster(glShadowCaster)) {
-      directionalShadowCasters.push_back(glShadowCaster);
-    } else if (isActiveSpotShadowCaster(glShadowCaster)) {
-      spotShadowCasters.push_back(glShadowCaster);
-    } else if (isActivePointShadowCaster(glShadowCaster)) {
-      pointShadowCasters.push_back(glShadowCaster);
+  queue.clear();
+
+  for (auto* glObject : glVideoController->glObjects) {
+    auto* sourceObject = glObject->getSourceObject();
+
+    if (sourceObject->shadowCascadeLimit == 0) {
+      continue;
+    }
+
+    uint64_t key = OpenGLRenderQueue::createSortKey(
+      pass,
+      isDirectional ? std::min(sourceObject->shadowCascadeLimit, 4U) : 0,
+      programs.getVariantFlags(glObject->getShaderVariant()),
+      glObject->getMaterialId(),
+      isDirectional ? 0.0f : sourceObject->getBoundsDistance(light->position)
+    );
+
+    queue.submit(key, glObject);
+  }
+
+  queue.sort();
+}
+
+/**
+ * Records one directional light view command list per cascade, each
+ * drawing only those objects which cast shadows into the cascade.
+ */
+void OpenGLIlluminator::recordDirectionalShadowCasterLightView(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::recordDirectionalShadowCasterLightView");
+
+  auto& queue = glShadowCaster->getLightViewQueue();
+
+  queueLightViewObjects(queue, RenderPass::DIRECTIONAL_SHADOW_PASS, lightViewPrograms, glShadowCaster->getLight());
+
+  for (int i = 0; i < 4; i++) {
+    auto& commands = glShadowCaster->getLightViewCommands(i);
+
+    commands.clear();
+
+    for (auto& packet : queue.getPackets()) {
+      auto* glObject = packet.glObject;
+      auto* sourceObject = glObject->getSourceObject();
+
+      if (sourceObject->shadowCascadeLimit > i) {
+        if (commands.setPipeline(&lightViewPrograms, lightViewPrograms.getVariantFlags(glObject->getShaderVariant()))) {
+          commands.setInt("modelTexture", 7);
+          commands.setInt("lightMatrixIndex", i);
+        }
+
+        commands.draw(glObject, sourceObject, sourceObject->shadowLod != nullptr);
+      }
     }
   }
 
-  glDisable(GL_BLEND);
-  glDisable(GL_STENCIL_TEST);
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_CULL_FACE);
+  unsigned int totalConsideredInstances = 0;
+  unsigned int totalDrawnInstances = 0;
 
-  // Render directional light shadow maps first, since these don't
-  // need to dynamically enable/disable objects based on their
-  // proximity to the light. Instead we defer to the existing
-  // object enabled/disabled states, which can be determined
-  // in game logic rather than engine logic.
-  if (directionalShadowCasters.size() > 0 || spotShadowCasters.size() > 0) {  
-    lightViewProgram.use();
+  for (int i = 0; i < 4; i++) {
+    totalConsideredInstances += glShadowCaster->getLightViewCommands(i).getTotalConsideredInstances();
+    totalDrawnInstances += glShadowCaster->getLightViewCommands(i).getTotalDrawnInstances();
   }
 
+  PerformanceProfiler::trackViewInstances("directional-light", totalConsideredInstances, totalDrawnInstances);
+}
+
+void OpenGLIlluminator::recordDirectionalShadowCasterLightViewLayered(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::recordDirectionalShadowCasterLightViewLayered");
+
+  auto& queue = glShadowCaster->getLightViewQueue();
+  auto& commands = glShadowCaster->getLightViewCommands();
+
+  queueLightViewObjects(queue, RenderPass::DIRECTIONAL_SHADOW_PASS, layeredLightViewPrograms, glShadowCaster->getLight());
+
+  commands.clear();
+
+  for (auto& packet : queue.getPackets()) {
+    auto* glObject = packet.glObject;
+    auto* sourceObject = glObject->getSourceObject();
+
+    if (commands.setPipeline(&layeredLightViewPrograms, layeredLightViewPrograms.getVariantFlags(glObject->getShaderVariant()))) {
+      commands.setInt("modelTexture", 7);
+    }
+
+    // Queued objects are grouped by cascade limit, so the
+    // draw constants change at most 4 times over the pass
+    commands.setDrawConstants((int)std::min(sourceObject->shadowCascadeLimit, 4U));
+    commands.draw(glObject, sourceObject, sourceObject->shadowLod != nullptr);
+  }
+
+  PerformanceProfiler::trackViewInstances("directional-light", commands.getTotalConsideredInstances(), commands.getTotalDrawnInstances());
+}
+
+/**
+ * Runs a job for each light view rendered this frame, counted by the
+ * given counter. Each job writes only to its own shadowcaster's queue
+ * and command lists, so jobs can safely run alongside one another.
+ */
+void OpenGLIlluminator::recordLightViews(JobCounter& counter) {
+  PROFILE_ZONE("OpenGLIlluminator::recordLightViews");
+
+  collectShadowCasters();
+
   for (auto* glShadowCaster : directionalShadowCasters) {
-    renderDirectionalShadowCasterLightView(glShadowCaster);
+    JobSystem::run([=]() {
+      if (cascadeRenderMode == CascadeRenderMode::SINGLE_PASS) {
+        recordDirectionalShadowCasterLightViewLayered(glShadowCaster);
+      } else {
+        recordDirectionalShadowCasterLightView(glShadowCaster);
+      }
+    }, counter);
   }
 
-  // Render spot/point lights next, since these dynamically update
-  // object enabled/disabled states based on proximity.
   for (auto* glShadowCaster : spotShadowCasters) {
-    renderSpotShadowCasterLightView(glShadowCaster);
+    JobSystem::run([=]() {
+      recordSpotShadowCasterLightView(glShadowCaster);
+    }, counter);
   }
 
-  // Whenever there are multiple active point shadowcasters, render
-  // their light views on a rotating basis - the active one determined
-  // by the current frame - to reduce per-frame rendering work. This
-  // may result in a reduced apparent "shadow framerate" if too many
-  // are grouped together in close proximity.
-  //
-  // TODO: Allow point lights to override the active index check and
-  // update their shadow map every frame.
-  unsigned int cycleIndex = 0;
+  if (activePointShadowCaster != nullptr) {
+    JobSystem::run([=]() {
+      recordPointShadowCasterLightView(activePointShadowCaster);
+    }, counter);
+  }
+}
 
-  unsigned int activePointShadowCasterIndex = pointShadowCasters.size() > 0
-    ? (PerformanceProfiler::getCurrentFrame() % pointShadowCasters.size())
-    : 0;
+/**
+ * Records the point light view. Only instances within the light's
+ * radius are drawn; rather than toggling which instances objects
+ * render, their data is copied into the command list.
+ *
+ * TODO: Allow objects to force point lights to render them
+ * anyway, e.g. large objects with origins further away from the
+ * light source than their radius, but geometry within the radius
+ */
+void OpenGLIlluminator::recordPointShadowCasterLightView(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::recordPointShadowCasterLightView");
 
-  if (pointShadowCasters.size() > 0) {
-    pointLightViewProgram.use();
+  auto& queue = glShadowCaster->getLightViewQueue();
+  auto& commands = glShadowCaster->getLightViewCommands();
+  auto* light = glShadowCaster->getLight();
+
+  queueLightViewObjects(queue, RenderPass::POINT_SHADOW_PASS, pointLightViewPrograms, light);
+
+  commands.clear();
+
+  for (auto& packet : queue.getPackets()) {
+    auto* glObject = packet.glObject;
+    auto* sourceObject = glObject->getSourceObject();
+
+    commands.setPipeline(&pointLightViewPrograms, pointLightViewPrograms.getVariantFlags(glObject->getShaderVariant()));
+
+    commands.drawInstancesWhere(glObject, sourceObject, sourceObject->shadowLod != nullptr, [=](const Vec3f& position) {
+      return light->isWithinRadius(position);
+    });
   }
 
-  for (auto* glShadowCaster : pointShadowCasters) {
-    if (cycleIndex++ == activePointShadowCasterIndex) {
-      renderPointShadowCasterLightView(glShadowCaster);
+  PerformanceProfiler::trackViewInstances("point-light", commands.getTotalConsideredInstances(), commands.getTotalDrawnInstances());
+}
+
+/**
+ * Records the spot light view, drawing only instances within the
+ * light's radius in the same way as point light views.
+ */
+void OpenGLIlluminator::recordSpotShadowCasterLightView(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::recordSpotShadowCasterLightView");
+
+  auto& queue = glShadowCaster->getLightViewQueue();
+  auto& commands = glShadowCaster->getLightViewCommands();
+  auto* light = glShadowCaster->getLight();
+
+  queueLightViewObjects(queue, RenderPass::SPOT_SHADOW_PASS, lightViewPrograms, light);
+
+  commands.clear();
+
+  for (auto& packet : queue.getPackets()) {
+    auto* glObject = packet.glObject;
+    auto* sourceObject = glObject->getSourceObject();
+
+    if (commands.setPipeline(&lightViewPrograms, lightViewPrograms.getVariantFlags(glObject->getShaderVariant()))) {
+      commands.setInt("modelTexture", 7);
+      commands.setInt("lightMatrixIndex", 0);
+    }
+
+    commands.drawInstancesWhere(glObject, sourceObject, sourceObject->shadowLod != nullptr, [=](const Vec3f& position) {
+      return light->isWithinRadius(position);
+    });
+  }
+
+  PerformanceProfiler::trackViewInstances("spot-light", commands.getTotalConsideredInstances(), commands.getTotalDrawnInstances());
+}
+
+void OpenGLIlluminator::renderNonShadowCasterLights() {
+  PROFILE_ZONE("OpenGLIlluminator::renderNonShadowCasterLights");
+  PROFILE_GPU_ZONE("non-shadowcaster-lights");
+
+  auto& illuminationProgram = glVideoController->gBuffer->getShaderProgram(GBuffer::Shader::ILLUMINATION);
+
+  illuminationProgram.use();
+
+  OpenGLState::disable(GL_DEPTH_TEST);
+  OpenGLState::disable(GL_CULL_FACE);
+  OpenGLState::enable(GL_STENCIL_TEST);
+  OpenGLState::stencilFunc(GL_EQUAL, 1, 0xFF);
+  OpenGLState::enable(GL_BLEND);
+
+  glVideoController->setGBufferUniforms(illuminationProgram);
+  glLightingQuad->render();
+
+  OpenGLState::disable(GL_BLEND);
+}
+
+/**
+ * Renders the light views recorded for this frame's active
+ * shadowcasters, followed by each shadowcasting light itself.
+ */
+void OpenGLIlluminator::renderShadowCasterLights() {
+  PROFILE_ZONE("OpenGLIlluminator::renderShadowCasterLights");
+
+  OpenGLState::disable(GL_BLEND);
+  OpenGLState::disable(GL_STENCIL_TEST);
+  OpenGLState::enable(GL_DEPTH_TEST);
+  OpenGLState::enable(GL_CULL_FACE);
+
+  // Fit directional light shadow cascades to the range of visible
+  // depths, as determined by the most recent G-Buffer reduction
+  if (directionalShadowCasters.size() > 0) {
+    PROFILE_GPU_ZONE("depth-reduction");
+
+    glVideoController->gBuffer->startReading();
+    glDepthReducer->reduce(Window::size.width, Window::size.height);
+
+    for (auto* glShadowCaster : directionalShadowCasters) {
+      glShadowCaster->fitCascades(glDepthReducer->getDepthRange());
+    }
+  }
+
+  activeShadowCasters.clear();
+  activeShadowCasters.insert(activeShadowCasters.end(), directionalShadowCasters.begin(), directionalShadowCasters.end());
+  activeShadowCasters.insert(activeShadowCasters.end(), spotShadowCasters.begin(), spotShadowCasters.end());
+  activeShadowCasters.insert(activeShadowCasters.end(), pointShadowCasters.begin(), pointShadowCasters.end());
+
+  updateLightConstants(activeShadowCasters);
+
+  // Cascade timings are used to compare the cost of each
+  // cascade rendering mode
+  if (directionalShadowCasters.size() > 0) {
+    PROFILE_GPU_ZONE("shadow-cascades");
+
+    for (auto* glShadowCaster : directionalShadowCasters) {
+      if (cascadeRenderMode == CascadeRenderMode::SINGLE_PASS) {
+        renderDirectionalShadowCasterLightViewLayered(glShadowCaster);
+      } else {
+        renderDirectionalShadowCasterLightView(glShadowCaster);
+      }
+    }
+  }
+
+  if (spotShadowCasters.size() > 0) {
+    PROFILE_GPU_ZONE("spot-light-views");
+
+    for (auto* glShadowCaster : spotShadowCasters) {
+      renderSpotShadowCasterLightView(glShadowCaster);
+    }
+  }
+
+  if (activePointShadowCaster != nullptr) {
+    PROFILE_GPU_ZONE("point-light-view");
+
+    renderPointShadowCasterLightView(activePointShadowCaster);
+  }
+
+  OpenGLState::disable(GL_DEPTH_TEST);
+  OpenGLState::disable(GL_CULL_FACE);
+
+  // Prefilter the shadow maps of any directional/spot lights
+  // using EVSM filtering before they're sampled in camera view
+  {
+    PROFILE_GPU_ZONE("shadow-moments");
+
+    for (auto* glShadowCaster : directionalShadowCasters) {
+      renderShadowMoments(glShadowCaster);
+    }
+
+    for (auto* glShadowCaster : spotShadowCasters) {
+      renderShadowMoments(glShadowCaster);
     }
   }
 
+  PROFILE_GPU_ZONE("shadowcaster-lights");
+
   // After the shadow maps are drawn, render the lights with shadow
-  glDisable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_STENCIL_TEST);
-  glEnable(GL_BLEND);
+  OpenGLState::enable(GL_STENCIL_TEST);
+  OpenGLState::enable(GL_BLEND);
 
   if (directionalShadowCasters.size() > 0) {
     directionalCameraViewProgram.use();
@@ -211,107 +499,127 @@ void OpenGLIlluminator::renderShadowCasterLights() {
     renderPointShadowCasterCameraView(glShadowCaster);
   }
 
-  glDisable(GL_BLEND);
-
-  // Tentatively re-enable all objects for rendering. No objects will
-  // actually be rendered again until after the next game tick, which
-  // can allow enabled/disabled states to be changed once more before
-  // objects are rehydrated in Stage::update().
-  for (auto* glObject : glVideoController->glObjects) {
-    glObject->getSourceObject()->enableRenderingAll();
-  }
+  OpenGLState::disable(GL_BLEND);
 }
 
 void OpenGLIlluminator::renderDirectionalShadowCasterCameraView(OpenGLShadowCaster* glShadowCaster) {
-  auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLDirectionalShadowBuffer>();
-  auto* light = glShadowCaster->getSourceLight();
+  PROFILE_ZONE("OpenGLIlluminator::renderDirectionalShadowCasterCameraView");
 
-  Matrix4 lightMatrixCascades[] = {
-    glShadowCaster->getCascadedLightMatrix(0, *Camera::active),
-    glShadowCaster->getCascadedLightMatrix(1, *Camera::active),
-    glShadowCaster->getCascadedLightMatrix(2, *Camera::active),
-    glShadowCaster->getCascadedLightMatrix(3, *Camera::active)
-  };
+  auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLDirectionalShadowBuffer>();
+  auto* light = glShadowCaster->getLight();
 
   directionalCameraViewProgram.use();
-  directionalCameraViewProgram.setInt("colorTexture", 0);
-  directionalCameraViewProgram.setInt("normalDepthTexture", 1);
-  directionalCameraViewProgram.setInt("positionTexture", 2);
-  directionalCameraViewProgram.setInt("lightMaps[0]", 3);
-  directionalCameraViewProgram.setInt("lightMaps[1]", 4);
-  directionalCameraViewProgram.setInt("lightMaps[2]", 5);
-  directionalCameraViewProgram.setInt("lightMaps[3]", 6);
-  directionalCameraViewProgram.setMatrix4("lightMatrixCascades[0]", lightMatrixCascades[0]);
-  directionalCameraViewProgram.setMatrix4("lightMatrixCascades[1]", lightMatrixCascades[1]);
-  directionalCameraViewProgram.setMatrix4("lightMatrixCascades[2]", lightMatrixCascades[2]);
-  directionalCameraViewProgram.setMatrix4("lightMatrixCascades[3]", lightMatrixCascades[3]);
-  directionalCameraViewProgram.setVec3f("cameraPosition", Camera::active->position);
-  directionalCameraViewProgram.setVec3f("light.position", light->position);
-  directionalCameraViewProgram.setVec3f("light.direction", light->direction.unit());
-  directionalCameraViewProgram.setVec3f("light.color", light->color * light->power);
-  directionalCameraViewProgram.setFloat("light.radius", light->radius);
-  directionalCameraViewProgram.setInt("light.type", light->type);
-
-  glVideoController->glPostShaderPipeline->getFirstShader()->writeToInputBuffer();
+  glVideoController->setGBufferUniforms(directionalCameraViewProgram);
+  directionalCameraViewProgram.setInt("lightMaps", 3);
+  directionalCameraViewProgram.setInt("lightDepthMaps", 4);
+  directionalCameraViewProgram.setInt("lightMomentMaps", 5);
+  directionalCameraViewProgram.setBool("useEvsm", glShadowCaster->getMomentsBuffer() != nullptr);
+
+  bindLightConstants(glShadowCaster);
+  glVideoController->writeToSceneBuffer();
   glVideoController->gBuffer->startReading();
   glShadowBuffer->startReading();
 
+  if (glShadowCaster->getMomentsBuffer() != nullptr) {
+    glShadowCaster->getMomentsBuffer()->startReading();
+  }
+
   OpenGLScreenQuad::draw();
   PerformanceProfiler::trackLight(light);
 }
 
 void OpenGLIlluminator::renderDirectionalShadowCasterLightView(OpenGLShadowCaster* glShadowCaster) {
-  auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLDirectionalShadowBuffer>();
+  PROFILE_ZONE("OpenGLIlluminator::renderDirectionalShadowCasterLightView");
 
-  Matrix4 lightMatrixCascades[] = {
-    glShadowCaster->getCascadedLightMatrix(0, *Camera::active),
-    glShadowCaster->getCascadedLightMatrix(1, *Camera::active),
-    glShadowCaster->getCascadedLightMatrix(2, *Camera::active),
-    glShadowCaster->getCascadedLightMatrix(3, *Camera::active)
-  };
+  auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLDirectionalShadowBuffer>();
 
-  lightViewProgram.setInt("modelTexture", 7);
+  bindLightConstants(glShadowCaster);
   glShadowBuffer->startWriting();
 
   for (int i = 0; i < 4; i++) {
-    lightViewProgram.setMatrix4("lightMatrix", lightMatrixCascades[i]);
     glShadowBuffer->writeToShadowCascade(i);
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    for (auto* glObject : glVideoController->glObjects) {
-      if (glObject->getSourceObject()->shadowCascadeLimit > i) {
-        lightViewProgram.setBool("hasTexture", glObject->hasTexture());
+    glVideoController->replay(glShadowCaster->getLightViewCommands(i));
+  }
+}
 
-        glVideoController->setObjectEffects(lightViewProgram, glObject);
+void OpenGLIlluminator::renderDirectionalShadowCasterLightViewLayered(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::renderDirectionalShadowCasterLightViewLayered");
 
-        if (glObject->getSourceObject()->shadowLod != nullptr) {
-          glObject->renderShadowLod();
-        } else {
-          glObject->render();
-        }
-      }
-    }
+  auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLDirectionalShadowBuffer>();
+
+  bindLightConstants(glShadowCaster);
+  glShadowBuffer->startWriting();
+  glShadowBuffer->writeToAllShadowCascades();
+
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  glVideoController->replay(glShadowCaster->getLightViewCommands());
+}
+
+/**
+ * Converts a directional or spot light's shadow map into blurred,
+ * mipmapped EVSM moments. Each layer is warped and blurred along
+ * one axis into an intermediate buffer, then blurred along the
+ * other axis into the final moments buffer, so the filtering cost
+ * scales with shadow map resolution rather than screen resolution.
+ */
+void OpenGLIlluminator::renderShadowMoments(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::renderShadowMoments");
+
+  auto* glMomentsBuffer = glShadowCaster->getMomentsBuffer();
+
+  if (glMomentsBuffer == nullptr) {
+    return;
+  }
+
+  unsigned int totalLayers = glMomentsBuffer->getTotalLayers();
+
+  shadowMomentsProgram.use();
+  shadowMomentsProgram.setInt("depthMaps", 4);
+  shadowMomentsProgram.setInt("momentMaps", 6);
+
+  glShadowCaster->getShadowBuffer<AbstractBuffer>()->startReading();
+
+  shadowMomentsProgram.setBool("isWarpPass", true);
+  shadowMomentsProgram.setVec2f("direction", Vec2f(1.0f, 0.0f));
+
+  for (unsigned int layer = 0; layer < totalLayers; layer++) {
+    shadowMomentsProgram.setInt("layer", layer);
+    glMomentsBuffer->writeToBlurLayer(layer);
+
+    OpenGLScreenQuad::draw();
   }
+
+  glMomentsBuffer->startReadingBlurBuffer();
+
+  shadowMomentsProgram.setBool("isWarpPass", false);
+  shadowMomentsProgram.setVec2f("direction", Vec2f(0.0f, 1.0f));
+
+  for (unsigned int layer = 0; layer < totalLayers; layer++) {
+    shadowMomentsProgram.setInt("layer", layer);
+    glMomentsBuffer->writeToMomentsLayer(layer);
+
+    OpenGLScreenQuad::draw();
+  }
+
+  glMomentsBuffer->generateMipmaps();
 }
 
 void OpenGLIlluminator::renderPointShadowCasterCameraView(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::renderPointShadowCasterCameraView");
+
   auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLPointShadowBuffer>();
-  auto* light = glShadowCaster->getSourceLight();
+  auto* light = glShadowCaster->getLight();
 
-  pointCameraViewProgram.setInt("colorTexture", 0);
-  pointCameraViewProgram.setInt("normalDepthTexture", 1);
-  pointCameraViewProgram.setInt("positionTexture", 2);
+  glVideoController->setGBufferUniforms(pointCameraViewProgram);
   pointCameraViewProgram.setInt("lightCubeMap", 3);
-  pointCameraViewProgram.setFloat("farPlane", light->radius);
-  pointCameraViewProgram.setVec3f("cameraPosition", Camera::active->position);
-  pointCameraViewProgram.setVec3f("light.position", light->position);
-  pointCameraViewProgram.setVec3f("light.direction", light->direction);
-  pointCameraViewProgram.setVec3f("light.color", light->color * light->power);
-  pointCameraViewProgram.setFloat("light.radius", light->radius);
-  pointCameraViewProgram.setInt("light.type", light->type);
-
-  glVideoController->glPostShaderPipeline->getFirstShader()->writeToInputBuffer();
+
+  bindLightConstants(glShadowCaster);
+
+  glVideoController->writeToSceneBuffer();
   glVideoController->gBuffer->startReading();
   glShadowBuffer->startReading();
 
@@ -320,113 +628,144 @@ void OpenGLIlluminator::renderPointShadowCasterCameraView(OpenGLShadowCaster* gl
 }
 
 void OpenGLIlluminator::renderPointShadowCasterLightView(OpenGLShadowCaster* glShadowCaster) {
-  auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLPointShadowBuffer>();
-  auto* light = glShadowCaster->getSourceLight();
-
-  Matrix4 lightMatrices[6] = {
-    glShadowCaster->getLightMatrix(Vec3f(1.0f, 0.0f, 0.0f), Vec3f(0.0f, -1.0f, 0.0f)),
-    glShadowCaster->getLightMatrix(Vec3f(-1.0f, 0.0f, 0.0f), Vec3f(0.0f, -1.0f, 0.0f)),
-    glShadowCaster->getLightMatrix(Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 0.0f, 1.0f)),
-    glShadowCaster->getLightMatrix(Vec3f(0.0f, -1.0f, 0.0f), Vec3f(0.0f, 0.0f, -1.0f)),
-    glShadowCaster->getLightMatrix(Vec3f(0.0f, 0.0f, -1.0f), Vec3f(0.0f, -1.0f, 0.0f)),
-    glShadowCaster->getLightMatrix(Vec3f(0.0f, 0.0f, 1.0f), Vec3f(0.0f, -1.0f, 0.0f))
-  };
+  PROFILE_ZONE("OpenGLIlluminator::renderPointShadowCasterLightView");
 
-  pointLightViewProgram.use();
-  pointLightViewProgram.setVec3f("lightPosition", light->position.gl());
-  pointLightViewProgram.setFloat("farPlane", light->radius);
-
-  for (int i = 0; i < 6; i++) {
-    pointLightViewProgram.setMatrix4("lightMatrices[" + std::to_string(i) + "]", lightMatrices[i]);
-  }
+  auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLPointShadowBuffer>();
 
+  bindLightConstants(glShadowCaster);
   glShadowBuffer->startWriting();
 
   glClear(GL_DEPTH_BUFFER_BIT);
 
-  for (auto* glObject : glVideoController->glObjects) {
-    auto* sourceObject = glObject->getSourceObject();
-
-    if (sourceObject->shadowCascadeLimit > 0) {
-      glVideoController->setObjectEffects(pointLightViewProgram, glObject);
-
-      // TODO: Allow objects to force point lights to render them
-      // anyway, e.g. large objects with origins further away from the
-      // light source than their radius, but geometry within the radius
-      sourceObject->enableRenderingWhere([&](Object* object) {
-        return isObjectWithinLightRadius(object, glShadowCaster->getSourceLight());
-      });
-
-      sourceObject->rehydrate();
-
-      if (sourceObject->shadowLod != nullptr) {
-        glObject->renderShadowLod();
-      } else {
-        glObject->render();
-      }
-    }
-  }
+  glVideoController->replay(glShadowCaster->getLightViewCommands());
 }
 
 void OpenGLIlluminator::renderSpotShadowCasterCameraView(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::renderSpotShadowCasterCameraView");
+
   auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLSpotShadowBuffer>();
-  auto* light = glShadowCaster->getSourceLight();
-  Matrix4 lightMatrix = glShadowCaster->getLightMatrix(light->direction, Vec3f(0.0f, 1.0f, 0.0f));
+  auto* light = glShadowCaster->getLight();
 
-  glVideoController->glPostShaderPipeline->getFirstShader()->writeToInputBuffer();
+  glVideoController->writeToSceneBuffer();
   glVideoController->gBuffer->startReading();
   glShadowBuffer->startReading();
 
+  if (glShadowCaster->getMomentsBuffer() != nullptr) {
+    glShadowCaster->getMomentsBuffer()->startReading();
+  }
+
   spotCameraViewProgram.use();
-  spotCameraViewProgram.setInt("colorTexture", 0);
-  spotCameraViewProgram.setInt("normalDepthTexture", 1);
-  spotCameraViewProgram.setInt("positionTexture", 2);
+  glVideoController->setGBufferUniforms(spotCameraViewProgram);
   spotCameraViewProgram.setInt("lightMap", 3);
-  spotCameraViewProgram.setMatrix4("lightMatrix", lightMatrix);
-  spotCameraViewProgram.setVec3f("cameraPosition", Camera::active->position);
-  spotCameraViewProgram.setVec3f("light.position", light->position);
-  spotCameraViewProgram.setVec3f("light.direction", light->direction.unit());
-  spotCameraViewProgram.setVec3f("light.color", light->color * light->power);
-  spotCameraViewProgram.setFloat("light.radius", light->radius);
-  spotCameraViewProgram.setInt("light.type", light->type);
+  spotCameraViewProgram.setInt("lightDepthMap", 4);
+  spotCameraViewProgram.setInt("lightMomentMap", 5);
+  spotCameraViewProgram.setBool("useEvsm", glShadowCaster->getMomentsBuffer() != nullptr);
+
+  bindLightConstants(glShadowCaster);
 
   OpenGLScreenQuad::draw();
   PerformanceProfiler::trackLight(light);
 }
 
 void OpenGLIlluminator::renderSpotShadowCasterLightView(OpenGLShadowCaster* glShadowCaster) {
+  PROFILE_ZONE("OpenGLIlluminator::renderSpotShadowCasterLightView");
+
   auto* glShadowBuffer = glShadowCaster->getShadowBuffer<OpenGLSpotShadowBuffer>();
-  Matrix4 lightMatrix = glShadowCaster->getLightMatrix(glShadowCaster->getSourceLight()->direction, Vec3f(0.0f, 1.0f, 0.0f));
 
-  lightViewProgram.setMatrix4("lightMatrix", lightMatrix);
+  bindLightConstants(glShadowCaster);
   glShadowBuffer->startWriting();
 
   glClear(GL_DEPTH_BUFFER_BIT);
 
-  for (auto* glObject : glVideoController->glObjects) {
-    auto* sourceObject = glObject->getSourceObject();
+  glVideoController->replay(glShadowCaster->getLightViewCommands());
+}
 
-    if (sourceObject->shadowCascadeLimit > 0) {
-      glVideoController->setObjectEffects(lightViewProgram, glObject);
+void OpenGLIlluminator::setCascadeRenderMode(CascadeRenderMode mode) {
+  cascadeRenderMode = mode;
 
-      // TODO: Allow objects to force spot lights to render them
-      // anyway, e.g. large objects with origins further away from the
-      // light source than their radius, but geometry within the radius
-      sourceObject->enableRenderingWhere([&](Object* object) {
-        return isObjectWithinLightRadius(object, glShadowCaster->getSourceLight());
-      });
+  printf("[OpenGLIlluminator] Cascade render mode: %s\n", getCascadeRenderModeName(mode));
+}
+
+void OpenGLIlluminator::setVideoController(OpenGLVideoController* glVideoController) {
+  this->glVideoController = glVideoController;
+}
 
-      sourceObject->rehydrate();
+void OpenGLIlluminator::toggleCascadeRenderMode() {
+  setCascadeRenderMode(
+    cascadeRenderMode == CascadeRenderMode::SINGLE_PASS
+      ? CascadeRenderMode::MULTI_PASS
+      : CascadeRenderMode::SINGLE_PASS
+  );
+}
 
-      if (sourceObject->shadowLod != nullptr) {
-        glObject->renderShadowLod();
-      } else {
-        glObject->render();
-      }
+/**
+ * Uploads the constants for every active shadowcaster in a single
+ * buffer update, each in its own slot, which the shadowcaster keeps.
+ * Light view and camera view passes then only bind the slot for their
+ * light, rather than re-sending its matrices and properties to each
+ * program.
+ */
+void OpenGLIlluminator::updateLightConstants(const std::vector<OpenGLShadowCaster*>& glShadowCasters) {
+  if (shadowCasterConstants.size() != glShadowCasters.size()) {
+    shadowCasterConstants.resize(glShadowCasters.size());
+  }
+
+  for (unsigned int slot = 0; slot < glShadowCasters.size(); slot++) {
+    auto* glShadowCaster = glShadowCasters[slot];
+    auto* light = glShadowCaster->getLight();
+    auto& lightConstants = shadowCasterConstants[slot];
+    Matrix4 lightMatrices[6];
+    Vec3f direction = light->direction;
+    Vec3f color = light->color * light->power;
+
+    memset(&lightConstants, 0, sizeof(LightConstants));
+
+    switch (light->type) {
+      case Light::LightType::DIRECTIONAL:
+        for (int i = 0; i < 4; i++) {
+          lightMatrices[i] = glShadowCaster->getCascadedLightMatrix(i, glVideoController->frameCamera);
+        }
+
+        for (int i = 0; i < 3; i++) {
+          lightConstants.cascadeSplits[i] = glShadowCaster->getCascadeSplit(i);
+        }
+
+        direction = direction.unit();
+        break;
+      case Light::LightType::SPOTLIGHT:
+        lightMatrices[0] = glShadowCaster->getLightMatrix(light->direction, Vec3f(0.0f, 1.0f, 0.0f));
+        direction = direction.unit();
+        break;
+      case Light::LightType::POINT:
+        lightMatrices[0] = glShadowCaster->getLightMatrix(Vec3f(1.0f, 0.0f, 0.0f), Vec3f(0.0f, -1.0f, 0.0f));
+        lightMatrices[1] = glShadowCaster->getLightMatrix(Vec3f(-1.0f, 0.0f, 0.0f), Vec3f(0.0f, -1.0f, 0.0f));
+        lightMatrices[2] = glShadowCaster->getLightMatrix(Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 0.0f, 1.0f));
+        lightMatrices[3] = glShadowCaster->getLightMatrix(Vec3f(0.0f, -1.0f, 0.0f), Vec3f(0.0f, 0.0f, -1.0f));
+        lightMatrices[4] = glShadowCaster->getLightMatrix(Vec3f(0.0f, 0.0f, -1.0f), Vec3f(0.0f, -1.0f, 0.0f));
+        lightMatrices[5] = glShadowCaster->getLightMatrix(Vec3f(0.0f, 0.0f, 1.0f), Vec3f(0.0f, -1.0f, 0.0f));
+        break;
+      default:
+        break;
     }
+
+    for (int i = 0; i < 6; i++) {
+      memcpy(lightConstants.lightMatrices[i], lightMatrices[i].m, sizeof(lightConstants.lightMatrices[i]));
+    }
+
+    lightConstants.position[0] = light->position.x;
+    lightConstants.position[1] = light->position.y;
+    lightConstants.position[2] = light->position.z;
+    lightConstants.direction[0] = direction.x;
+    lightConstants.direction[1] = direction.y;
+    lightConstants.direction[2] = direction.z;
+    lightConstants.color[0] = color.x;
+    lightConstants.color[1] = color.y;
+    lightConstants.color[2] = color.z;
+    lightConstants.radius = light->radius;
+    lightConstants.type = light->type;
+
+    glShadowCaster->setLightConstantSlot(slot);
   }
-}
 
-void OpenGLIlluminator::setVideoController(OpenGLVideoController* glVideoController) {
-  this->glVideoController = glVideoController;
+  lightConstantsBuffer->update(shadowCasterConstants.data(), shadowCasterConstants.size());
 }
\ No newline at end of file
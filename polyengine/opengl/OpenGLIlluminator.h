@@ -1,34 +1,79 @@
 #pragma once
 
+#include <vector>
+
 #include "opengl/OpenGLVideoController.h"
 #include "opengl/OpenGLShadowCaster.h"
 #include "opengl/OpenGLLightingQuad.h"
+#include "opengl/OpenGLDepthReducer.h"
+#include "opengl/OpenGLRenderQueue.h"
+#include "opengl/OpenGLUniformBuffer.h"
 #include "opengl/ShaderProgram.h"
+#include "opengl/ShaderProgramVariants.h"
 #include "opengl/FrameBuffer.h"
+#include "subsystem/JobSystem.h"
 
 class OpenGLIlluminator {
 public:
+  /**
+   * Determines how directional light shadow map cascades are
+   * rendered: either with one pass over all objects per cascade,
+   * or in a single layered pass where a geometry shader routes
+   * primitives to each cascade they overlap.
+   */
+  enum CascadeRenderMode {
+    MULTI_PASS,
+    SINGLE_PASS
+  };
+
   OpenGLIlluminator();
   ~OpenGLIlluminator();
 
+  CascadeRenderMode getCascadeRenderMode() const;
+  void prepareLights();
+  void recordLightViews(JobCounter& counter);
   void renderNonShadowCasterLights();
   void renderShadowCasterLights();
+  void setCascadeRenderMode(CascadeRenderMode mode);
   void setVideoController(OpenGLVideoController* glVideoController);
+  void toggleCascadeRenderMode();
 
 private:
   OpenGLVideoController* glVideoController = nullptr;
   OpenGLLightingQuad* glLightingQuad = nullptr;
-  ShaderProgram lightViewProgram;
-  ShaderProgram pointLightViewProgram;
+  OpenGLDepthReducer* glDepthReducer = nullptr;
+  OpenGLUniformBuffer* lightConstantsBuffer = nullptr;
+  std::vector<LightConstants> shadowCasterConstants;
+  std::vector<OpenGLShadowCaster*> directionalShadowCasters;
+  std::vector<OpenGLShadowCaster*> spotShadowCasters;
+  std::vector<OpenGLShadowCaster*> pointShadowCasters;
+  std::vector<OpenGLShadowCaster*> activeShadowCasters;
+  std::vector<const Light*> nonShadowCasterLights;
+  OpenGLShadowCaster* activePointShadowCaster = nullptr;
+  CascadeRenderMode cascadeRenderMode = CascadeRenderMode::SINGLE_PASS;
+  ShaderProgramVariants lightViewPrograms;
+  ShaderProgramVariants layeredLightViewPrograms;
+  ShaderProgramVariants pointLightViewPrograms;
+  ShaderProgram shadowMomentsProgram;
   ShaderProgram directionalCameraViewProgram;
   ShaderProgram spotCameraViewProgram;
   ShaderProgram pointCameraViewProgram;
 
+  void bindLightConstants(OpenGLShadowCaster* glShadowCaster);
+  void collectShadowCasters();
   void createShaderPrograms();
+  void queueLightViewObjects(OpenGLRenderQueue& queue, RenderPass pass, ShaderProgramVariants& programs, const Light* light);
+  void recordDirectionalShadowCasterLightView(OpenGLShadowCaster* glShadowCaster);
+  void recordDirectionalShadowCasterLightViewLayered(OpenGLShadowCaster* glShadowCaster);
+  void recordPointShadowCasterLightView(OpenGLShadowCaster* glShadowCaster);
+  void recordSpotShadowCasterLightView(OpenGLShadowCaster* glShadowCaster);
   void renderDirectionalShadowCasterCameraView(OpenGLShadowCaster* OpenGLShadowCaster);
   void renderDirectionalShadowCasterLightView(OpenGLShadowCaster* glShadowCaster);
+  void renderDirectionalShadowCasterLightViewLayered(OpenGLShadowCaster* glShadowCaster);
+  void renderShadowMoments(OpenGLShadowCaster* glShadowCaster);
   void renderPointShadowCasterCameraView(OpenGLShadowCaster* glShadowCaster);
   void renderPointShadowCasterLightView(OpenGLShadowCaster* glShadowCaster);
   void renderSpotShadowCasterCameraView(OpenGLShadowCaster* glShadowCaster);
   void renderSpotShadowCasterLightView(OpenGLShadowCaster* glShadowCaster);
+  void updateLightConstants(const std::vector<OpenGLShadowCaster*>& glShadowCasters);
 };
\ No newline at end of file
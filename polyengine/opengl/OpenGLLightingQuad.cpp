@@ -1,6 +1,10 @@
+#include <chrono>
+
 #include "opengl/OpenGLLightingQuad.h"
+#include "opengl/OpenGLState.h"
 #include "subsystem/entities/Camera.h"
 #include "subsystem/Math.h"
+#include "subsystem/MemoryTracker.h"
 #include "subsystem/PerformanceProfiler.h"
 #include "subsystem/Window.h"
 
@@ -31,92 +35,45 @@ const static enum Attribute {
   LIGHT_TYPE = 8
 };
 
-struct LightData {
-  float position[3];
-  float direction[3];
-  float color[3];
-  float radius;
-  int type;
-};
-
-struct QuadTransformData {
-  float offset[2];
-  float scale[2];
-};
-
 OpenGLLightingQuad::OpenGLLightingQuad() {
   glGenVertexArrays(1, &vao);
   glGenBuffers(3, &buffers[0]);
-  glBindVertexArray(vao);
+  OpenGLState::bindVertexArray(vao);
 
-  glBindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_VERTEX]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_VERTEX]);
   glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), QUAD_DATA, GL_STATIC_DRAW);
 
+  MemoryTracker::trackAllocation(MemoryTag::GPU_LIGHTS, 24 * sizeof(float));
+
   defineQuadVertexAttributes();
   defineLightAttributes();
   defineQuadTransformAttributes();
 }
 
 OpenGLLightingQuad::~OpenGLLightingQuad() {
-  // TODO
-}
-
-// TODO: Perform some of this work in OpenGLIlluminator, or rename
-// OpenGLLightingQuad to better represent its responsibility over
-// screen-space light bounds calculation
-void OpenGLLightingQuad::bufferData(const std::vector<Light*>& lights) {
-  LightData* lightBuffer = new LightData[lights.size()];
-  QuadTransformData* transformBuffer = new QuadTransformData[lights.size()];
-  Matrix4 projection = Matrix4::projection(Window::size, Camera::active->fov * 0.5f, 1.0f, 10000.0f);
-  Matrix4 view = Camera::active->getViewMatrix();
-  float aspectRatio = (float)Window::size.width / (float)Window::size.height;
-
-  for (unsigned int i = 0; i < lights.size(); i++) {
-    auto* light = lights[i];
-    auto live_color = light->color * light->power;
-
-    memcpy(lightBuffer[i].position, &light->position, 3 * sizeof(float));
-    memcpy(lightBuffer[i].direction, &light->direction, 3 * sizeof(float));
-    memcpy(lightBuffer[i].color, &live_color, 3 * sizeof(float));
+  OpenGLState::deleteVertexArrays(1, &vao);
+  OpenGLState::deleteBuffers(3, &buffers[0]);
 
-    lightBuffer[i].radius = light->radius;
-    lightBuffer[i].type = light->type;
-
-    Vec3f localLightPosition = view * light->position;
-
-    if (localLightPosition.z > 0.0f && light->type != Light::LightType::DIRECTIONAL) {
-      Vec3f clip = (projection * localLightPosition) / localLightPosition.z;
-
-      transformBuffer[i].offset[0] = clip.x;
-      transformBuffer[i].offset[1] = clip.y;
-      transformBuffer[i].scale[0] = light->radius / localLightPosition.z * aspectRatio;
-      transformBuffer[i].scale[1] = light->radius / localLightPosition.z * 1.2f;
-    } else {
-      float scale = (localLightPosition.magnitude() < light->radius * 0.5f || light->type == Light::LightType::DIRECTIONAL) ? 1.0f : 0.0f;
+  MemoryTracker::trackFree(MemoryTag::GPU_LIGHTS, 24 * sizeof(float) + lightBufferSize);
+}
 
-      transformBuffer[i].offset[0] = 0.0f;
-      transformBuffer[i].offset[1] = 0.0f;
-      transformBuffer[i].scale[0] = scale;
-      transformBuffer[i].scale[1] = scale;
-    }
+void OpenGLLightingQuad::bufferData() {
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::LIGHT]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(LightData) * lightData.size(), lightData.data(), GL_DYNAMIC_DRAW);
 
-    if (transformBuffer[i].scale[0] > 0.0f && transformBuffer[i].scale[1] > 0.0f) {
-      PerformanceProfiler::trackLight(light);
-    }
-  }
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_TRANSFORM]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(QuadTransformData) * transformData.size(), transformData.data(), GL_DYNAMIC_DRAW);
 
-  glBindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::LIGHT]);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(LightData) * lights.size(), lightBuffer, GL_DYNAMIC_DRAW);
+  unsigned int totalBytes = (sizeof(LightData) + sizeof(QuadTransformData)) * lightData.size();
 
-  glBindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_TRANSFORM]);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(QuadTransformData) * lights.size(), transformBuffer, GL_DYNAMIC_DRAW);
+  PerformanceProfiler::trackCounter(ProfiledCounter::BYTES_UPLOADED, totalBytes);
+  MemoryTracker::trackResize(MemoryTag::GPU_LIGHTS, lightBufferSize, totalBytes);
 
-  delete[] lightBuffer;
-  delete[] transformBuffer;
+  lightBufferSize = totalBytes;
 }
 
 void OpenGLLightingQuad::defineLightAttributes() {
-  glBindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::LIGHT]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::LIGHT]);
 
   glEnableVertexAttribArray(Attribute::LIGHT_POSITION);
   glVertexAttribPointer(Attribute::LIGHT_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(LightData), (void*)offsetof(LightData, position));
@@ -140,7 +97,7 @@ void OpenGLLightingQuad::defineLightAttributes() {
 }
 
 void OpenGLLightingQuad::defineQuadTransformAttributes() {
-  glBindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_TRANSFORM]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_TRANSFORM]);
 
   glEnableVertexAttribArray(Attribute::QUAD_OFFSET);
   glVertexAttribPointer(Attribute::QUAD_OFFSET, 2, GL_FLOAT, GL_FALSE, sizeof(QuadTransformData), (void*)offsetof(QuadTransformData, offset));
@@ -152,7 +109,7 @@ void OpenGLLightingQuad::defineQuadTransformAttributes() {
 }
 
 void OpenGLLightingQuad::defineQuadVertexAttributes() {
-  glBindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_VERTEX]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, buffers[Buffer::QUAD_VERTEX]);
 
   glEnableVertexAttribArray(Attribute::VERTEX_POSITION);
   glVertexAttribPointer(Attribute::VERTEX_POSITION, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
@@ -161,15 +118,71 @@ void OpenGLLightingQuad::defineQuadVertexAttributes() {
   glVertexAttribPointer(Attribute::VERTEX_UV, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 }
 
-void OpenGLLightingQuad::render(const std::vector<Light*>& lights) {
-  if (lights.size() == 0) {
+/**
+ * Packs each light's data and screen-space bounds for rendering, as
+ * seen from the given camera. Packing is done ahead of rendering so
+ * that the lights themselves needn't be read while rendering.
+ */
+void OpenGLLightingQuad::prepare(const std::vector<const Light*>& lights, const Camera& camera) {
+  auto start = std::chrono::high_resolution_clock::now();
+  Matrix4 projection = Matrix4::projection(Window::size, camera.fov * 0.5f, 1.0f, 10000.0f);
+  Matrix4 view = camera.getViewMatrix();
+  float aspectRatio = (float)Window::size.width / (float)Window::size.height;
+
+  lightData.resize(lights.size());
+  transformData.resize(lights.size());
+
+  for (unsigned int i = 0; i < lights.size(); i++) {
+    auto* light = lights[i];
+    auto live_color = light->color * light->power;
+
+    memcpy(lightData[i].position, &light->position, 3 * sizeof(float));
+    memcpy(lightData[i].direction, &light->direction, 3 * sizeof(float));
+    memcpy(lightData[i].color, &live_color, 3 * sizeof(float));
+
+    lightData[i].radius = light->radius;
+    lightData[i].type = light->type;
+
+    Vec3f localLightPosition = view * light->position;
+
+    if (localLightPosition.z > 0.0f && light->type != Light::LightType::DIRECTIONAL) {
+      Vec3f clip = (projection * localLightPosition) / localLightPosition.z;
+
+      transformData[i].offset[0] = clip.x;
+      transformData[i].offset[1] = clip.y;
+      transformData[i].scale[0] = light->radius / localLightPosition.z * aspectRatio;
+      transformData[i].scale[1] = light->radius / localLightPosition.z * 1.2f;
+    } else {
+      float scale = (localLightPosition.magnitude() < light->radius * 0.5f || light->type == Light::LightType::DIRECTIONAL) ? 1.0f : 0.0f;
+
+      transformData[i].offset[0] = 0.0f;
+      transformData[i].offset[1] = 0.0f;
+      transformData[i].scale[0] = scale;
+      transformData[i].scale[1] = scale;
+    }
+
+    if (transformData[i].scale[0] > 0.0f && transformData[i].scale[1] > 0.0f) {
+      PerformanceProfiler::trackLight(light);
+    }
+  }
+
+  std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+
+  PerformanceProfiler::trackSubsystemTime(ProfiledSubsystem::LIGHT_BUFFERING, duration.count());
+}
+
+/**
+ * Renders the lights packed by the last prepare().
+ */
+void OpenGLLightingQuad::render() {
+  if (lightData.size() == 0) {
     return;
   }
 
-  bufferData(lights);
+  bufferData();
 
-  glBindVertexArray(vao);
-  glDrawArraysInstanced(GL_TRIANGLES, 0, 6, lights.size());
+  OpenGLState::bindVertexArray(vao);
+  glDrawArraysInstanced(GL_TRIANGLES, 0, 6, lightData.size());
 
   PerformanceProfiler::trackDrawCall();
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "glew.h"
 #include "glut.h"
+#include "subsystem/entities/Camera.h"
 #include "subsystem/entities/Light.h"
 #include "subsystem/Math.h"
 
@@ -12,13 +13,30 @@ public:
   OpenGLLightingQuad();
   ~OpenGLLightingQuad();
 
-  void render(const std::vector<Light*>& lights);
+  void prepare(const std::vector<const Light*>& lights, const Camera& camera);
+  void render();
 
 private:
+  struct LightData {
+    float position[3];
+    float direction[3];
+    float color[3];
+    float radius;
+    int type;
+  };
+
+  struct QuadTransformData {
+    float offset[2];
+    float scale[2];
+  };
+
   GLuint vao;
   GLuint buffers[3];
+  unsigned int lightBufferSize = 0;
+  std::vector<LightData> lightData;
+  std::vector<QuadTransformData> transformData;
 
-  void bufferData(const std::vector<Light*>& lights);
+  void bufferData();
   void defineLightAttributes();
   void defineQuadTransformAttributes();
   void defineQuadVertexAttributes();
@@ -1,9 +1,11 @@
 #include <algorithm>
 
 #include "opengl/OpenGLObject.h"
+#include "opengl/OpenGLState.h"
 #include "opengl/OpenGLTexture.h"
 #include "opengl/ShaderProgram.h"
 #include "opengl/ShaderLoader.h"
+#include "subsystem/MemoryTracker.h"
 #include "subsystem/PerformanceProfiler.h"
 
 const static enum Buffer {
@@ -36,6 +38,12 @@ OpenGLObject::OpenGLObject(Object* object) {
     glNormalMap = OpenGLObject::createOpenGLTexture(object->normalMap, GL_TEXTURE8);
   }
 
+  // Materials are numbered densely in the order they're first seen,
+  // so that they fit the sort key without colliding
+  auto material = materialMap.try_emplace({ glTexture, glNormalMap }, (unsigned int)materialMap.size());
+
+  materialId = material.first->second;
+
   if (object->shadowLod != nullptr) {
     addLod(object->shadowLod);
     setActiveLodIndex(0);
@@ -44,12 +52,19 @@ OpenGLObject::OpenGLObject(Object* object) {
 
 OpenGLObject::~OpenGLObject() {
   for (auto* glLod : glLods) {
-    // TODO: Delete VAO/EBO/VBOs
+    MemoryTracker::trackFree(MemoryTag::GPU_MESHES, glLod->bufferSizes[Buffer::VERTEX] + glLod->elementBufferSize);
+    MemoryTracker::trackFree(MemoryTag::GPU_INSTANCES, glLod->bufferSizes[Buffer::MATRIX] + glLod->bufferSizes[Buffer::COLOR] + glLod->bufferSizes[Buffer::ID]);
+
+    OpenGLState::deleteVertexArrays(1, &glLod->vao);
+    OpenGLState::deleteBuffers(4, &glLod->buffers[0]);
+    OpenGLState::deleteBuffers(1, &glLod->ebo);
 
     delete glLod;
   }
 
   glLods.clear();
+
+  MemoryTracker::trackFree(MemoryTag::CPU_INSTANCES, snapshotBytes);
 }
 
 void OpenGLObject::addLod(const Object* object) {
@@ -58,7 +73,7 @@ void OpenGLObject::addLod(const Object* object) {
   glGenVertexArrays(1, &glLod->vao);
   glGenBuffers(4, &glLod->buffers[0]);
   glGenBuffers(1, &glLod->ebo);
-  glBindVertexArray(glLod->vao);
+  OpenGLState::bindVertexArray(glLod->vao);
 
   glLod->baseObject = object;
 
@@ -84,21 +99,23 @@ void OpenGLObject::bindTextures() {
   }
 }
 
-void OpenGLObject::bufferDynamicData(const void* data, unsigned int size, GLuint vbo) {
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+void OpenGLObject::bufferDynamicData(const void* data, unsigned int size, unsigned int bufferIndex) {
+  auto* glLod = getActiveLod();
+
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, glLod->buffers[bufferIndex]);
   glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
-}
 
-void OpenGLObject::bufferInstanceData() {
-  unsigned int totalInstances = sourceObject->getTotalInstances();
-  const float* matrices = sourceObject->getMatrixBuffer();
-  const float* colors = sourceObject->getColorBuffer();
-  const int* objectIds = sourceObject->getObjectIdBuffer();
-  auto* glLod = getActiveLod();
+  MemoryTracker::trackResize(MemoryTag::GPU_INSTANCES, glLod->bufferSizes[bufferIndex], size);
+
+  glLod->bufferSizes[bufferIndex] = size;
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::BYTES_UPLOADED, size);
+}
 
-  bufferDynamicData(matrices, totalInstances * 16 * sizeof(float), glLod->buffers[Buffer::MATRIX]);
-  bufferDynamicData(colors, totalInstances * 3 * sizeof(float), glLod->buffers[Buffer::COLOR]);
-  bufferDynamicData(objectIds, totalInstances * sizeof(int), glLod->buffers[Buffer::ID]);
+void OpenGLObject::bufferInstanceData(const float* matrices, const float* colors, const int* objectIds, unsigned int totalInstances) {
+  bufferDynamicData(matrices, totalInstances * 16 * sizeof(float), Buffer::MATRIX);
+  bufferDynamicData(colors, totalInstances * 3 * sizeof(float), Buffer::COLOR);
+  bufferDynamicData(objectIds, totalInstances * sizeof(int), Buffer::ID);
 }
 
 void OpenGLObject::bufferVertexData() {
@@ -130,9 +147,14 @@ void OpenGLObject::bufferVertexData() {
     buffer[i++] = vertex->uv.y;
   }
 
-  glBindBuffer(GL_ARRAY_BUFFER, glLod->buffers[Buffer::VERTEX]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, glLod->buffers[Buffer::VERTEX]);
   glBufferData(GL_ARRAY_BUFFER, bufferSize * sizeof(float), buffer, GL_STATIC_DRAW);
 
+  PerformanceProfiler::trackCounter(ProfiledCounter::BYTES_UPLOADED, bufferSize * sizeof(float));
+  MemoryTracker::trackAllocation(MemoryTag::GPU_MESHES, bufferSize * sizeof(float));
+
+  glLod->bufferSizes[Buffer::VERTEX] = bufferSize * sizeof(float);
+
   delete[] buffer;
 }
 
@@ -154,9 +176,14 @@ void OpenGLObject::bufferVertexElementData() {
     }
   }
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glLod->ebo);
+  OpenGLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, glLod->ebo);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize * sizeof(unsigned int), buffer, GL_STATIC_DRAW);
 
+  PerformanceProfiler::trackCounter(ProfiledCounter::BYTES_UPLOADED, bufferSize * sizeof(unsigned int));
+  MemoryTracker::trackAllocation(MemoryTag::GPU_MESHES, bufferSize * sizeof(unsigned int));
+
+  glLod->elementBufferSize = bufferSize * sizeof(unsigned int);
+
   delete[] buffer;
 }
 
@@ -175,7 +202,7 @@ OpenGLTexture* OpenGLObject::createOpenGLTexture(const Texture* texture, GLenum
 }
 
 void OpenGLObject::defineColorAttributes() {
-  glBindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::COLOR]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::COLOR]);
 
   glEnableVertexAttribArray(Attribute::MODEL_COLOR);
   glVertexAttribPointer(Attribute::MODEL_COLOR, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
@@ -183,7 +210,7 @@ void OpenGLObject::defineColorAttributes() {
 }
 
 void OpenGLObject::defineMatrixAttributes() {
-  glBindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::MATRIX]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::MATRIX]);
 
   for (unsigned int i = 0; i < 4; i++) {
     glEnableVertexAttribArray(Attribute::MODEL_MATRIX + i);
@@ -193,7 +220,7 @@ void OpenGLObject::defineMatrixAttributes() {
 }
 
 void OpenGLObject::defineObjectIdAttributes() {
-  glBindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::ID]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::ID]);
 
   glEnableVertexAttribArray(Attribute::OBJECT_ID);
   glVertexAttribIPointer(Attribute::OBJECT_ID, 1, GL_INT, sizeof(int), (void*)0);
@@ -201,7 +228,7 @@ void OpenGLObject::defineObjectIdAttributes() {
 }
 
 void OpenGLObject::defineVertexAttributes() {
-  glBindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::VERTEX]);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, getActiveLod()->buffers[Buffer::VERTEX]);
 
   glEnableVertexAttribArray(Attribute::VERTEX_POSITION);
   glVertexAttribPointer(Attribute::VERTEX_POSITION, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)0);
@@ -220,6 +247,17 @@ OpenGLObjectLod* OpenGLObject::getActiveLod() {
   return glLods[activeLodIndex];
 }
 
+void OpenGLObject::drawInstances(unsigned int totalInstances) {
+  auto* glLod = getActiveLod();
+
+  OpenGLState::bindVertexArray(glLod->vao);
+  OpenGLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, glLod->ebo);
+  glDrawElementsInstanced(GL_TRIANGLES, glLod->baseObject->getPolygons().size() * 3, GL_UNSIGNED_INT, (void*)0, totalInstances);
+
+  PerformanceProfiler::trackObject(sourceObject, totalInstances);
+  PerformanceProfiler::trackDrawCall();
+}
+
 void OpenGLObject::freeCachedResources() {
   for (auto [ key, glTexture ] : textureMap) {
     delete glTexture;
@@ -231,6 +269,33 @@ void OpenGLObject::freeCachedResources() {
 
   textureMap.clear();
   shaderMap.clear();
+  materialMap.clear();
+}
+
+/**
+ * Identifies the set of textures an object is rendered with, so
+ * objects sharing textures can be drawn together.
+ */
+unsigned int OpenGLObject::getMaterialId() const {
+  return materialId;
+}
+
+unsigned int OpenGLObject::getShaderVariant() const {
+  unsigned int variant = sourceObject->effects & (VARIANT_TREE_ANIMATION | VARIANT_GRASS_ANIMATION);
+
+  if (hasTexture()) {
+    variant |= VARIANT_TEXTURE;
+  }
+
+  if (hasNormalMap()) {
+    variant |= VARIANT_NORMAL_MAP;
+  }
+
+  if (sourceObject->isEmissive) {
+    variant |= VARIANT_EMISSIVE;
+  }
+
+  return variant;
 }
 
 Object* OpenGLObject::getSourceObject() const {
@@ -245,24 +310,39 @@ bool OpenGLObject::hasTexture() const {
   return glTexture != nullptr;
 }
 
+/**
+ * Renders the instances taken in the last snapshot.
+ */
 void OpenGLObject::render() {
-  unsigned int totalRenderableInstances = sourceObject->getTotalRenderableInstances();
-
-  if (totalRenderableInstances == 0) {
+  if (totalSnapshotInstances == 0) {
     return;
   }
 
-  auto* glLod = getActiveLod();
-
   bindTextures();
-  bufferInstanceData();
+  bufferInstanceData(instanceMatrices, instanceColors, instanceObjectIds, totalSnapshotInstances);
+  drawInstances(totalSnapshotInstances);
+}
 
-  glBindVertexArray(glLod->vao);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glLod->ebo);
-  glDrawElementsInstanced(GL_TRIANGLES, glLod->baseObject->getPolygons().size() * 3, GL_UNSIGNED_INT, (void*)0, totalRenderableInstances);
+/**
+ * Renders instances from externally provided instance data rather
+ * than the source object's own, e.g. a subset of its instances
+ * recorded into a command list.
+ */
+void OpenGLObject::renderInstances(const float* matrices, const float* colors, const int* objectIds, unsigned int totalInstances, bool useShadowLod) {
+  if (totalInstances == 0) {
+    return;
+  }
 
-  PerformanceProfiler::trackObject(sourceObject, totalRenderableInstances);
-  PerformanceProfiler::trackDrawCall();
+  unsigned int previousActiveLodIndex = activeLodIndex;
+
+  if (useShadowLod) {
+    setActiveLodIndex(glLods.size() - 1);
+  }
+
+  bindTextures();
+  bufferInstanceData(matrices, colors, objectIds, totalInstances);
+  drawInstances(totalInstances);
+  setActiveLodIndex(previousActiveLodIndex);
 }
 
 void OpenGLObject::renderLod(unsigned int index) {
@@ -281,5 +361,41 @@ void OpenGLObject::setActiveLodIndex(unsigned int index) {
   activeLodIndex = std::min((int)index, (int)glLods.size() - 1);
 }
 
+/**
+ * Takes the source object's renderable instance data for the frame,
+ * before rendering. Copying it allows the source object to go on
+ * changing while the frame renders; otherwise, the source object's
+ * buffers are read directly, and must stay as they are until the
+ * frame is rendered.
+ */
+void OpenGLObject::snapshotInstanceData(bool shouldCopy) {
+  totalSnapshotInstances = sourceObject->getTotalRenderableInstances();
+
+  if (!shouldCopy || totalSnapshotInstances == 0) {
+    instanceMatrices = sourceObject->getMatrixBuffer();
+    instanceColors = sourceObject->getColorBuffer();
+    instanceObjectIds = sourceObject->getObjectIdBuffer();
+
+    return;
+  }
+
+  matrixSnapshot.assign(sourceObject->getMatrixBuffer(), sourceObject->getMatrixBuffer() + totalSnapshotInstances * 16);
+  colorSnapshot.assign(sourceObject->getColorBuffer(), sourceObject->getColorBuffer() + totalSnapshotInstances * 3);
+  objectIdSnapshot.assign(sourceObject->getObjectIdBuffer(), sourceObject->getObjectIdBuffer() + totalSnapshotInstances);
+
+  instanceMatrices = matrixSnapshot.data();
+  instanceColors = colorSnapshot.data();
+  instanceObjectIds = objectIdSnapshot.data();
+
+  uint64_t bytes = (matrixSnapshot.capacity() + colorSnapshot.capacity()) * sizeof(float) + objectIdSnapshot.capacity() * sizeof(int);
+
+  if (bytes != snapshotBytes) {
+    MemoryTracker::trackResize(MemoryTag::CPU_INSTANCES, snapshotBytes, bytes);
+
+    snapshotBytes = bytes;
+  }
+}
+
 std::map<int, OpenGLTexture*> OpenGLObject::textureMap;
-std::map<std::string, ShaderProgram*> OpenGLObject::shaderMap;
\ No newline at end of file
+std::map<std::string, ShaderProgram*> OpenGLObject::shaderMap;
+std::map<std::pair<const OpenGLTexture*, const OpenGLTexture*>, unsigned int> OpenGLObject::materialMap;
\ No newline at end of file
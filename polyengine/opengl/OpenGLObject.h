@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "glew.h"
@@ -10,10 +12,24 @@
 #include "opengl/OpenGLTexture.h"
 #include "opengl/ShaderProgram.h"
 
+/**
+ * Flags selecting the shader variants an object is rendered with.
+ * Animation flags mirror their ObjectEffects counterparts.
+ */
+enum ObjectShaderVariant {
+  VARIANT_TREE_ANIMATION = ObjectEffects::TREE_ANIMATION,
+  VARIANT_GRASS_ANIMATION = ObjectEffects::GRASS_ANIMATION,
+  VARIANT_TEXTURE = 1 << 8,
+  VARIANT_NORMAL_MAP = 1 << 9,
+  VARIANT_EMISSIVE = 1 << 10
+};
+
 struct OpenGLObjectLod {
   GLuint vao;
   GLuint ebo;
   GLuint buffers[4];
+  unsigned int bufferSizes[4] = { 0 };
+  unsigned int elementBufferSize = 0;
   const Object* baseObject = nullptr;
 };
 
@@ -25,34 +41,49 @@ public:
   static void freeCachedResources();
 
   void bindTextures();
+  unsigned int getMaterialId() const;
+  unsigned int getShaderVariant() const;
   Object* getSourceObject() const;
   bool hasNormalMap() const;
   bool hasTexture() const;
   void render();
+  void renderInstances(const float* matrices, const float* colors, const int* objectIds, unsigned int totalInstances, bool useShadowLod);
   void renderLod(unsigned int index);
   void renderShadowLod();
+  void snapshotInstanceData(bool shouldCopy);
 
 private:
   static std::map<int, OpenGLTexture*> textureMap;
   static std::map<std::string, ShaderProgram*> shaderMap;
+  static std::map<std::pair<const OpenGLTexture*, const OpenGLTexture*>, unsigned int> materialMap;
 
   std::vector<OpenGLObjectLod*> glLods;
   unsigned int activeLodIndex = 0;
   Object* sourceObject = nullptr;
   OpenGLTexture* glTexture = nullptr;
   OpenGLTexture* glNormalMap = nullptr;
+  unsigned int materialId = 0;
+  const float* instanceMatrices = nullptr;
+  const float* instanceColors = nullptr;
+  const int* instanceObjectIds = nullptr;
+  unsigned int totalSnapshotInstances = 0;
+  std::vector<float> matrixSnapshot;
+  std::vector<float> colorSnapshot;
+  std::vector<int> objectIdSnapshot;
+  uint64_t snapshotBytes = 0;
 
   static OpenGLTexture* createOpenGLTexture(const Texture* texture, GLenum unit);
 
   void addLod(const Object* object);
-  void bufferDynamicData(const void* data, unsigned int size, GLuint vbo);
-  void bufferInstanceData();
+  void bufferDynamicData(const void* data, unsigned int size, unsigned int bufferIndex);
+  void bufferInstanceData(const float* matrices, const float* colors, const int* objectIds, unsigned int totalInstances);
   void bufferVertexData();
   void bufferVertexElementData();
   void defineColorAttributes();
   void defineMatrixAttributes();
   void defineObjectIdAttributes();
   void defineVertexAttributes();
+  void drawInstances(unsigned int totalInstances);
   OpenGLObjectLod* getActiveLod();
   void setActiveLodIndex(unsigned int index);
 };
\ No newline at end of file
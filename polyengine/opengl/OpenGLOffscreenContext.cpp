@@ -0,0 +1,117 @@
+#include <cstdio>
+
+#include "opengl/OpenGLOffscreenContext.h"
+
+OpenGLOffscreenContext::~OpenGLOffscreenContext() {
+  destroy();
+}
+
+#ifdef POLYGARDEN_EGL
+
+/**
+ * Creates a core profile context matching the one requested from
+ * SDL for windowed rendering, along with a pbuffer surface with the
+ * depth and stencil bits the G-Buffer resolve relies on.
+ */
+bool OpenGLOffscreenContext::create(unsigned int width, unsigned int height) {
+  const EGLint configAttributes[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_DEPTH_SIZE, 24,
+    EGL_STENCIL_SIZE, 1,
+    EGL_NONE
+  };
+
+  const EGLint surfaceAttributes[] = {
+    EGL_WIDTH, (EGLint)width,
+    EGL_HEIGHT, (EGLint)height,
+    EGL_NONE
+  };
+
+  const EGLint contextAttributes[] = {
+    EGL_CONTEXT_MAJOR_VERSION, 4,
+    EGL_CONTEXT_MINOR_VERSION, 6,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE
+  };
+
+  EGLConfig config;
+  EGLint totalConfigs = 0;
+
+  display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  if (
+    display == EGL_NO_DISPLAY ||
+    !eglInitialize(display, nullptr, nullptr) ||
+    !eglChooseConfig(display, configAttributes, &config, 1, &totalConfigs) ||
+    totalConfigs == 0
+  ) {
+    printf("[OpenGLOffscreenContext] Failed to initialize EGL display\n");
+
+    destroy();
+
+    return false;
+  }
+
+  eglBindAPI(EGL_OPENGL_API);
+
+  surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+  context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+
+  if (
+    surface == EGL_NO_SURFACE ||
+    context == EGL_NO_CONTEXT ||
+    !eglMakeCurrent(display, surface, surface, context)
+  ) {
+    printf("[OpenGLOffscreenContext] Failed to create context: EGL error 0x%x\n", eglGetError());
+
+    destroy();
+
+    return false;
+  }
+
+  return true;
+}
+
+void OpenGLOffscreenContext::destroy() {
+  if (display == EGL_NO_DISPLAY) {
+    return;
+  }
+
+  eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+  if (context != EGL_NO_CONTEXT) {
+    eglDestroyContext(display, context);
+  }
+
+  if (surface != EGL_NO_SURFACE) {
+    eglDestroySurface(display, surface);
+  }
+
+  eglTerminate(display);
+
+  display = EGL_NO_DISPLAY;
+  surface = EGL_NO_SURFACE;
+  context = EGL_NO_CONTEXT;
+}
+
+void OpenGLOffscreenContext::swap() {
+  eglSwapBuffers(display, surface);
+}
+
+#else
+
+bool OpenGLOffscreenContext::create(unsigned int width, unsigned int height) {
+  printf("[OpenGLOffscreenContext] Offscreen rendering requires a build with POLYGARDEN_EGL defined\n");
+
+  return false;
+}
+
+void OpenGLOffscreenContext::destroy() {}
+
+void OpenGLOffscreenContext::swap() {}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#ifdef POLYGARDEN_EGL
+#include <EGL/egl.h>
+#endif
+
+/**
+ * An OpenGL context rendering to an offscreen pbuffer rather than a
+ * window, for rendering without a display. Only available in builds
+ * defining POLYGARDEN_EGL; otherwise creating one always fails.
+ */
+class OpenGLOffscreenContext {
+public:
+  ~OpenGLOffscreenContext();
+
+  bool create(unsigned int width, unsigned int height);
+  void destroy();
+  void swap();
+
+private:
+  #ifdef POLYGARDEN_EGL
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLSurface surface = EGL_NO_SURFACE;
+  EGLContext context = EGL_NO_CONTEXT;
+  #endif
+};
\ No newline at end of file
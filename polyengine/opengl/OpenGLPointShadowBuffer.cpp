@@ -6,7 +6,7 @@ void OpenGLPointShadowBuffer::createFrameBuffer(unsigned int width, unsigned int
     delete frameBuffer;
   }
 
-  frameBuffer = new FrameBuffer(width, height);
+  frameBuffer = new FrameBuffer(width, height, MemoryTag::GPU_SHADOW_MAPS);
 
   frameBuffer->addDepthCubeMap(GL_TEXTURE3);
 }
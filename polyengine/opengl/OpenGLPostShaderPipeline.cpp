@@ -1,44 +1,86 @@
+#include <cstdio>
+#include <string>
 
 #include "opengl/OpenGLPostShaderPipeline.h"
-#include "opengl/OpenGLScreenQuad.h"
 #include "glew.h"
 #include "glut.h"
 
+/**
+ * The maximum number of input samples per fragment a fused pass
+ * may take. Fusing a stage multiplies the samples taken by the
+ * stages before it, so neighborhood filters are only fused where
+ * the extra sampling is cheaper than an intermediate target.
+ */
+constexpr static unsigned int MAX_FUSED_STAGE_TAPS = 16;
+
 OpenGLPostShaderPipeline::~OpenGLPostShaderPipeline() {
   for (auto* glPostShader : glPostShaders) {
     delete glPostShader;
   }
 
   glPostShaders.clear();
+  stageGroups.clear();
 }
 
 void OpenGLPostShaderPipeline::addPostShader(AbstractOpenGLPostShader* glPostShader) {
   glPostShader->onInit();
 
-  if (glPostShaders.size() > 0) {
-    glPostShaders[glPostShaders.size() - 1]->setNextShader(glPostShader);
-  }
-
   glPostShaders.push_back(glPostShader);
 }
 
-AbstractOpenGLPostShader* OpenGLPostShaderPipeline::getFirstShader() {
-  return glPostShaders[0];
-}
+/**
+ * Chains each group of post shaders together through transient
+ * render targets, with the final group writing to the back buffer.
+ */
+void OpenGLPostShaderPipeline::createPasses(OpenGLRenderGraph& graph, OpenGLRenderGraph::Resource input) {
+  for (unsigned int i = 0; i < stageGroups.size(); i++) {
+    bool isFinalGroup = i == stageGroups.size() - 1;
 
-void OpenGLPostShaderPipeline::createFrameBuffers(const Area<unsigned int>& size) {
-  for (auto* glPostShader : glPostShaders) {
-    glPostShader->createFrameBuffer(size);
+    auto output = isFinalGroup
+      ? graph.getBackBuffer()
+      : graph.createTexture("post-fx-" + std::to_string(i), { GL_RGBA32F, GL_RGBA });
+
+    stageGroups[i][0]->onCreatePasses(graph, input, output);
+
+    input = output;
   }
 }
 
-void OpenGLPostShaderPipeline::render() {
-  glDisable(GL_STENCIL_TEST);
+/**
+ * Groups consecutive post shaders whose stages can be composed into
+ * a single pass, and creates the fused program for each group. This
+ * should be called once all post shaders have been added.
+ */
+void OpenGLPostShaderPipeline::fuseStages() {
+  unsigned int totalTaps = 0;
+
+  stageGroups.clear();
 
   for (auto* glPostShader : glPostShaders) {
-    glPostShader->writeToOutputBuffer();
-    glPostShader->render();
+    bool canFuse = (
+      stageGroups.size() > 0 &&
+      stageGroups.back()[0]->hasStage() &&
+      glPostShader->hasStage() &&
+      !glPostShader->hasIntermediatePasses() &&
+      totalTaps * glPostShader->getStageTaps() <= MAX_FUSED_STAGE_TAPS
+    );
+
+    if (canFuse) {
+      stageGroups.back().push_back(glPostShader);
+
+      totalTaps *= glPostShader->getStageTaps();
+    } else {
+      stageGroups.push_back({ glPostShader });
 
-    OpenGLScreenQuad::draw();
+      totalTaps = glPostShader->getStageTaps();
+    }
   }
+
+  for (auto& stageGroup : stageGroups) {
+    if (stageGroup[0]->hasStage()) {
+      stageGroup[0]->fuseStages(stageGroup);
+    }
+  }
+
+  printf("[OpenGLPostShaderPipeline] Fused %d post shaders into %d passes\n", (int)glPostShaders.size(), (int)stageGroups.size());
 }
\ No newline at end of file
@@ -3,18 +3,21 @@
 #include <vector>
 
 #include "opengl/AbstractOpenGLPostShader.h"
-#include "opengl/OpenGLScreenQuad.h"
-#include "subsystem/Math.h"
+#include "opengl/OpenGLRenderGraph.h"
 
 class OpenGLPostShaderPipeline {
 public:
   ~OpenGLPostShaderPipeline();
 
   void addPostShader(AbstractOpenGLPostShader* glPostShader);
-  void createFrameBuffers(const Area<unsigned int>& size);
-  AbstractOpenGLPostShader* getFirstShader();
-  void render();
+  void createPasses(OpenGLRenderGraph& graph, OpenGLRenderGraph::Resource input);
+  void fuseStages();
 
 private:
+  /**
+   * Groups of consecutive post shaders, each rendered in one
+   * pass by the first shader in the group.
+   */
+  std::vector<std::vector<AbstractOpenGLPostShader*>> stageGroups;
   std::vector<AbstractOpenGLPostShader*> glPostShaders;
 };
\ No newline at end of file
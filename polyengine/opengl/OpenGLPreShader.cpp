@@ -1,22 +1,9 @@
 #include "opengl/OpenGLPreShader.h"
-#include "opengl/ShaderLoader.h"
-#include "opengl/OpenGLScreenQuad.h"
 
-OpenGLPreShader::OpenGLPreShader(const char* path) {
-  program.create();
-  program.attachShader(ShaderLoader::loadVertexShader("./shaders/quad.vertex.glsl"));
-  program.attachShader(ShaderLoader::loadFragmentShader(path));
-  program.link();
+OpenGLPreShader::OpenGLPreShader(const char* stagePath) {
+  this->stagePath = stagePath;
 }
 
-OpenGLPreShader::~OpenGLPreShader() {
-  // TODO
-}
-
-ShaderProgram& OpenGLPreShader::getProgram() {
-  return program;
-}
-
-void OpenGLPreShader::render() {
-  OpenGLScreenQuad::draw();
+const char* OpenGLPreShader::getStagePath() const {
+  return stagePath;
 }
\ No newline at end of file
@@ -1,15 +1,16 @@
 #pragma once
 
-#include "opengl/ShaderProgram.h"
-
+/**
+ * A pre-fx stage applied to lit surfaces. Rather than rendering
+ * as its own full-screen pass, each stage is fused into the
+ * lighting resolve shader, in the order the stages are added.
+ */
 class OpenGLPreShader {
 public:
-  OpenGLPreShader(const char* path);
-  ~OpenGLPreShader();
+  OpenGLPreShader(const char* stagePath);
 
-  ShaderProgram& getProgram();
-  void render();
+  const char* getStagePath() const;
 
 private:
-  ShaderProgram program;
+  const char* stagePath;
 };
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "opengl/OpenGLRenderGraph.h"
+#include "opengl/OpenGLGpuTimer.h"
+#include "opengl/OpenGLState.h"
+#include "subsystem/MemoryTracker.h"
+#include "subsystem/ZoneProfiler.h"
+
+static uint64_t getTextureBytes(const Area<unsigned int>& size, GLint internalFormat) {
+  return (uint64_t)size.width * size.height * FrameBuffer::getBytesPerPixel(internalFormat);
+}
+
+static bool isSameTextureFormat(const OpenGLRenderGraph::TextureDescriptor& a, const OpenGLRenderGraph::TextureDescriptor& b) {
+  return (
+    a.internalFormat == b.internalFormat &&
+    a.format == b.format &&
+    a.clamp == b.clamp
+  );
+}
+
+OpenGLRenderGraph::~OpenGLRenderGraph() {
+  for (auto& texture : texturePool) {
+    delete texture.frameBuffer;
+
+    OpenGLState::deleteTextures(1, &texture.id);
+    MemoryTracker::trackFree(MemoryTag::GPU_RENDER_TARGETS, getTextureBytes(texture.size, texture.descriptor.internalFormat));
+  }
+
+  texturePool.clear();
+}
+
+void OpenGLRenderGraph::addPass(std::string name, const std::vector<Resource>& reads, Resource write, std::function<void()> handler) {
+  PassNode pass;
+
+  pass.name = name;
+  pass.zoneName = ZoneProfiler::internName(name);
+  pass.reads = reads;
+  pass.write = write;
+  pass.handler = handler;
+
+  passes.push_back(pass);
+}
+
+/**
+ * Assigns each transient resource used by a live pass to a pooled
+ * texture. A pooled texture can be reused once the last pass using
+ * its previous resource has run, letting resources with disjoint
+ * lifetimes share memory. Textures left unused by the compiled
+ * graph are freed.
+ */
+void OpenGLRenderGraph::allocateTextures() {
+  std::vector<Resource> transientResources;
+
+  for (auto& texture : texturePool) {
+    texture.isInUse = false;
+    texture.lastUse = -1;
+  }
+
+  for (Resource resource = 0; resource < resources.size(); resource++) {
+    if (!isImported(resource) && resources[resource].firstUse >= 0) {
+      transientResources.push_back(resource);
+    }
+  }
+
+  std::sort(transientResources.begin(), transientResources.end(), [&](Resource a, Resource b) {
+    return resources[a].firstUse < resources[b].firstUse;
+  });
+
+  for (auto resource : transientResources) {
+    auto& node = resources[resource];
+    Area<unsigned int> size = getTextureSize(node.descriptor);
+    int textureIndex = -1;
+
+    for (unsigned int i = 0; i < texturePool.size(); i++) {
+      auto& texture = texturePool[i];
+
+      bool isAvailable = !texture.isInUse || texture.lastUse < node.firstUse;
+      bool isMatchingTexture = isSameTextureFormat(texture.descriptor, node.descriptor) && texture.size.width == size.width && texture.size.height == size.height;
+
+      if (isAvailable && isMatchingTexture) {
+        textureIndex = i;
+
+        break;
+      }
+    }
+
+    if (textureIndex == -1) {
+      PooledTexture texture;
+
+      texture.descriptor = node.descriptor;
+      texture.size = size;
+
+      glGenTextures(1, &texture.id);
+      OpenGLState::bindTexture(GL_TEXTURE_2D, texture.id);
+      glTexImage2D(GL_TEXTURE_2D, 0, node.descriptor.internalFormat, size.width, size.height, 0, node.descriptor.format, GL_FLOAT, 0);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, node.descriptor.clamp);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, node.descriptor.clamp);
+
+      texture.frameBuffer = new FrameBuffer(size.width, size.height);
+      texture.frameBuffer->attachColorTexture(texture.id, node.descriptor.internalFormat, node.descriptor.format, GL_TEXTURE0);
+      texture.frameBuffer->bindColorTextures();
+
+      MemoryTracker::trackAllocation(MemoryTag::GPU_RENDER_TARGETS, getTextureBytes(size, node.descriptor.internalFormat));
+
+      texturePool.push_back(texture);
+
+      textureIndex = texturePool.size() - 1;
+    }
+
+    auto& texture = texturePool[textureIndex];
+
+    texture.isInUse = true;
+    texture.lastUse = node.lastUse;
+    node.textureIndex = textureIndex;
+
+    if (node.depthStencilSource != nullptr) {
+      node.depthStencilSource->shareDepthStencilBuffer(texture.frameBuffer);
+    }
+  }
+
+  // Free any textures which are no longer needed, remapping the
+  // texture indices of resources to the compacted pool
+  std::vector<PooledTexture> usedTextures;
+  std::vector<int> remappedIndices(texturePool.size(), -1);
+
+  for (unsigned int i = 0; i < texturePool.size(); i++) {
+    auto& texture = texturePool[i];
+
+    if (texture.isInUse) {
+      remappedIndices[i] = usedTextures.size();
+
+      usedTextures.push_back(texture);
+    } else {
+      delete texture.frameBuffer;
+
+      OpenGLState::deleteTextures(1, &texture.id);
+      MemoryTracker::trackFree(MemoryTag::GPU_RENDER_TARGETS, getTextureBytes(texture.size, texture.descriptor.internalFormat));
+    }
+  }
+
+  for (auto& node : resources) {
+    if (node.textureIndex >= 0) {
+      node.textureIndex = remappedIndices[node.textureIndex];
+    }
+  }
+
+  texturePool = usedTextures;
+}
+
+void OpenGLRenderGraph::blit(Resource source, Resource target) {
+  getFrameBuffer(source)->blit(getFrameBuffer(target));
+}
+
+/**
+ * Removes all passes and resources so the graph can be rebuilt.
+ * Pooled textures are retained until the next compilation, where
+ * they can be reused by the new graph.
+ */
+void OpenGLRenderGraph::clear() {
+  resources.clear();
+  passes.clear();
+
+  backBuffer = -1;
+}
+
+void OpenGLRenderGraph::compile(const Area<unsigned int>& windowSize) {
+  this->windowSize = windowSize;
+
+  cullPasses();
+  computeLifetimes();
+  allocateTextures();
+  logAllocations();
+}
+
+void OpenGLRenderGraph::computeLifetimes() {
+  for (auto& node : resources) {
+    node.firstUse = -1;
+    node.lastUse = -1;
+    node.textureIndex = -1;
+  }
+
+  for (int i = 0; i < (int)passes.size(); i++) {
+    auto& pass = passes[i];
+
+    if (pass.isCulled) {
+      continue;
+    }
+
+    auto markUse = [&](Resource resource) {
+      auto& node = resources[resource];
+
+      if (node.firstUse == -1) {
+        node.firstUse = i;
+      }
+
+      node.lastUse = i;
+    };
+
+    for (auto resource : pass.reads) {
+      markUse(resource);
+    }
+
+    markUse(pass.write);
+  }
+}
+
+OpenGLRenderGraph::Resource OpenGLRenderGraph::createTexture(std::string name, const TextureDescriptor& descriptor) {
+  ResourceNode node;
+
+  node.name = name;
+  node.descriptor = descriptor;
+
+  resources.push_back(node);
+
+  return resources.size() - 1;
+}
+
+/**
+ * Walks passes in reverse, keeping only those which write to an
+ * imported resource or the back buffer, or whose output is read
+ * by another pass which is kept.
+ */
+void OpenGLRenderGraph::cullPasses() {
+  std::vector<bool> isResourceNeeded(resources.size(), false);
+
+  for (int i = (int)passes.size() - 1; i >= 0; i--) {
+    auto& pass = passes[i];
+
+    pass.isCulled = !isImported(pass.write) && !isResourceNeeded[pass.write];
+
+    if (!pass.isCulled) {
+      for (auto resource : pass.reads) {
+        isResourceNeeded[resource] = true;
+      }
+    }
+  }
+}
+
+void OpenGLRenderGraph::execute() {
+  for (auto& pass : passes) {
+    if (!pass.isCulled) {
+      PROFILE_ZONE(pass.zoneName);
+      PROFILE_GPU_ZONE(pass.zoneName);
+
+      pass.handler();
+    }
+  }
+}
+
+OpenGLRenderGraph::Resource OpenGLRenderGraph::getBackBuffer() {
+  if (backBuffer == -1) {
+    ResourceNode node;
+
+    node.name = "back-buffer";
+    node.isBackBuffer = true;
+
+    resources.push_back(node);
+
+    backBuffer = resources.size() - 1;
+  }
+
+  return backBuffer;
+}
+
+FrameBuffer* OpenGLRenderGraph::getFrameBuffer(Resource resource) const {
+  auto& node = resources[resource];
+
+  return node.importedFrameBuffer != nullptr
+    ? node.importedFrameBuffer
+    : texturePool[node.textureIndex].frameBuffer;
+}
+
+Area<unsigned int> OpenGLRenderGraph::getTextureSize(const TextureDescriptor& descriptor) const {
+  return {
+    std::max(1U, (unsigned int)(windowSize.width * descriptor.scale)),
+    std::max(1U, (unsigned int)(windowSize.height * descriptor.scale))
+  };
+}
+
+OpenGLRenderGraph::Resource OpenGLRenderGraph::importFrameBuffer(std::string name, FrameBuffer* frameBuffer) {
+  ResourceNode node;
+
+  node.name = name;
+  node.importedFrameBuffer = frameBuffer;
+
+  resources.push_back(node);
+
+  return resources.size() - 1;
+}
+
+bool OpenGLRenderGraph::isImported(Resource resource) const {
+  return resources[resource].importedFrameBuffer != nullptr || resources[resource].isBackBuffer;
+}
+
+void OpenGLRenderGraph::logAllocations() const {
+  unsigned int totalPasses = 0;
+  unsigned int totalTransientResources = 0;
+  uint64_t totalBytes = 0;
+
+  for (auto& pass : passes) {
+    if (!pass.isCulled) {
+      totalPasses++;
+    }
+  }
+
+  for (Resource resource = 0; resource < resources.size(); resource++) {
+    if (!isImported(resource) && resources[resource].textureIndex >= 0) {
+      totalTransientResources++;
+    }
+  }
+
+  for (auto& texture : texturePool) {
+    totalBytes += getTextureBytes(texture.size, texture.descriptor.internalFormat);
+  }
+
+  printf("[OpenGLRenderGraph] Compiled %u/%u passes; %u transient targets aliased onto %u textures (%.1f MB)\n",
+    totalPasses,
+    (unsigned int)passes.size(),
+    totalTransientResources,
+    (unsigned int)texturePool.size(),
+    totalBytes / (1024.0f * 1024.0f)
+  );
+}
+
+/**
+ * Sets a framebuffer whose depth/stencil buffer should be shared
+ * with the texture backing a transient resource, e.g. so lighting
+ * passes can stencil test against the G-Buffer's geometry.
+ */
+void OpenGLRenderGraph::setDepthStencilSource(Resource resource, FrameBuffer* frameBuffer) {
+  resources[resource].depthStencilSource = frameBuffer;
+}
+
+void OpenGLRenderGraph::startReading(Resource resource, GLenum unit) {
+  OpenGLState::bindTexture(unit, GL_TEXTURE_2D, getFrameBuffer(resource)->getColorTextureId(0));
+}
+
+void OpenGLRenderGraph::startWriting(Resource resource) {
+  if (resources[resource].isBackBuffer) {
+    OpenGLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    OpenGLState::viewport(0, 0, windowSize.width, windowSize.height);
+  } else {
+    getFrameBuffer(resource)->startWriting();
+  }
+}
\ No newline at end of file
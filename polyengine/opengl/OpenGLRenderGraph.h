@@ -0,0 +1,94 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "glew.h"
+#include "glut.h"
+#include "opengl/FrameBuffer.h"
+#include "subsystem/Math.h"
+
+/**
+ * Describes the render passes which make up a frame, along with
+ * the resources each pass reads and writes. Once compiled, the
+ * graph can:
+ *
+ *  - Cull passes whose results are never used
+ *  - Size transient render targets relative to the window
+ *  - Alias transient render targets with non-overlapping lifetimes
+ *    onto the same textures
+ *
+ * Imported resources, such as the G-Buffer, are owned elsewhere and
+ * persist between frames. Passes which write to imported resources
+ * or to the back buffer are never culled.
+ */
+class OpenGLRenderGraph {
+public:
+  typedef unsigned int Resource;
+
+  struct TextureDescriptor {
+    GLint internalFormat;
+    GLenum format;
+    float scale = 1.0f;
+    GLint clamp = GL_CLAMP_TO_EDGE;
+  };
+
+  ~OpenGLRenderGraph();
+
+  void addPass(std::string name, const std::vector<Resource>& reads, Resource write, std::function<void()> handler);
+  void blit(Resource source, Resource target);
+  void clear();
+  void compile(const Area<unsigned int>& windowSize);
+  Resource createTexture(std::string name, const TextureDescriptor& descriptor);
+  void execute();
+  Resource getBackBuffer();
+  Resource importFrameBuffer(std::string name, FrameBuffer* frameBuffer);
+  void setDepthStencilSource(Resource resource, FrameBuffer* frameBuffer);
+  void startReading(Resource resource, GLenum unit);
+  void startWriting(Resource resource);
+
+private:
+  struct ResourceNode {
+    std::string name;
+    TextureDescriptor descriptor;
+    FrameBuffer* importedFrameBuffer = nullptr;
+    FrameBuffer* depthStencilSource = nullptr;
+    bool isBackBuffer = false;
+    int firstUse = -1;
+    int lastUse = -1;
+    int textureIndex = -1;
+  };
+
+  struct PassNode {
+    std::string name;
+    const char* zoneName = nullptr;
+    std::vector<Resource> reads;
+    Resource write;
+    std::function<void()> handler;
+    bool isCulled = false;
+  };
+
+  struct PooledTexture {
+    GLuint id = 0;
+    TextureDescriptor descriptor;
+    Area<unsigned int> size;
+    FrameBuffer* frameBuffer = nullptr;
+    int lastUse = -1;
+    bool isInUse = false;
+  };
+
+  std::vector<ResourceNode> resources;
+  std::vector<PassNode> passes;
+  std::vector<PooledTexture> texturePool;
+  Area<unsigned int> windowSize = { 0, 0 };
+  int backBuffer = -1;
+
+  void allocateTextures();
+  void computeLifetimes();
+  void cullPasses();
+  FrameBuffer* getFrameBuffer(Resource resource) const;
+  Area<unsigned int> getTextureSize(const TextureDescriptor& descriptor) const;
+  bool isImported(Resource resource) const;
+  void logAllocations() const;
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cstring>
+
+#include "opengl/OpenGLRenderQueue.h"
+
+uint64_t OpenGLRenderQueue::createSortKey(unsigned int pass, unsigned int stateClass, unsigned int variant, unsigned int material, float depth) {
+  uint32_t depthBits;
+
+  // The bit patterns of positive floats sort the same way as the
+  // floats themselves, so depths can be quantized by truncation
+  depth = std::max(depth, 0.0f);
+
+  memcpy(&depthBits, &depth, sizeof(float));
+
+  return (
+    (uint64_t(pass & 0xF) << 60) |
+    (uint64_t(stateClass & 0xF) << 56) |
+    (uint64_t(variant & 0xFFF) << 44) |
+    (uint64_t(material & 0x3FFF) << 30) |
+    uint64_t(depthBits >> 2)
+  );
+}
+
+void OpenGLRenderQueue::clear() {
+  packets.clear();
+}
+
+const std::vector<RenderPacket>& OpenGLRenderQueue::getPackets() const {
+  return packets;
+}
+
+/**
+ * Sorts packets by key with a least-significant-digit radix sort,
+ * one byte per pass. Passes over bytes which every key shares are
+ * skipped, which is most of them, since only a few passes, variants
+ * and materials are generally in use at once.
+ */
+void OpenGLRenderQueue::sort() {
+  unsigned int total = packets.size();
+
+  if (total < 2) {
+    return;
+  }
+
+  scratch.resize(total);
+
+  for (unsigned int shift = 0; shift < 64; shift += 8) {
+    unsigned int counts[256] = { 0 };
+
+    for (auto& packet : packets) {
+      counts[(packet.key >> shift) & 0xFF]++;
+    }
+
+    if (counts[(packets[0].key >> shift) & 0xFF] == total) {
+      continue;
+    }
+
+    unsigned int offset = 0;
+
+    for (unsigned int i = 0; i < 256; i++) {
+      unsigned int count = counts[i];
+
+      counts[i] = offset;
+      offset += count;
+    }
+
+    for (auto& packet : packets) {
+      scratch[counts[(packet.key >> shift) & 0xFF]++] = packet;
+    }
+
+    packets.swap(scratch);
+  }
+}
+
+void OpenGLRenderQueue::submit(uint64_t key, OpenGLObject* glObject) {
+  packets.push_back({ key, glObject });
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "opengl/OpenGLObject.h"
+
+/**
+ * Passes whose draws are submitted through render queues, in the
+ * order they're sorted in when sharing a queue.
+ */
+enum RenderPass {
+  GEOMETRY_PASS,
+  DIRECTIONAL_SHADOW_PASS,
+  SPOT_SHADOW_PASS,
+  POINT_SHADOW_PASS
+};
+
+/**
+ * A single draw submitted to a render queue.
+ */
+struct RenderPacket {
+  uint64_t key;
+  OpenGLObject* glObject;
+};
+
+/**
+ * Collects the draws of a pass and orders them by sort key before
+ * they're executed. Keys are built from most to least significant
+ * field, so draws are grouped by pass, then state class, program
+ * variant and material, with the remaining ties ordered front to
+ * back to make the most of early depth testing:
+ *
+ *   [ pass:4 | state class:4 | variant:12 | material:14 | depth:30 ]
+ *
+ * What the state class represents is up to each pass, e.g. whether
+ * stencil writes are enabled, or an object's shadow cascade limit.
+ */
+class OpenGLRenderQueue {
+public:
+  static uint64_t createSortKey(unsigned int pass, unsigned int stateClass, unsigned int variant, unsigned int material, float depth);
+
+  void clear();
+  const std::vector<RenderPacket>& getPackets() const;
+  void sort();
+  void submit(uint64_t key, OpenGLObject* glObject);
+
+private:
+  std::vector<RenderPacket> packets;
+  std::vector<RenderPacket> scratch;
+};
\ No newline at end of file
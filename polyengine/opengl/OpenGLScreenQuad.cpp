@@ -1,4 +1,5 @@
 #include "opengl/OpenGLScreenQuad.h"
+#include "opengl/OpenGLState.h"
 #include "subsystem/PerformanceProfiler.h"
 
 const float QUAD_DATA[] = {
@@ -13,8 +14,8 @@ const float QUAD_DATA[] = {
 OpenGLScreenQuad::OpenGLScreenQuad() {
   glGenVertexArrays(1, &vao);
   glGenBuffers(1, &vbo);
-  glBindVertexArray(vao);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  OpenGLState::bindVertexArray(vao);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
   glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), QUAD_DATA, GL_STATIC_DRAW);
 
   glEnableVertexAttribArray(0);
@@ -37,8 +38,8 @@ void OpenGLScreenQuad::draw() {
 }
 
 void OpenGLScreenQuad::render() {
-  glBindVertexArray(vao);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  OpenGLState::bindVertexArray(vao);
+  OpenGLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
   glDrawArrays(GL_TRIANGLES, 0, 6);
 
   PerformanceProfiler::trackDrawCall();
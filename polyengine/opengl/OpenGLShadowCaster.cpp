@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 
 #include "opengl/OpenGLShadowCaster.h"
@@ -6,27 +7,60 @@
 #include "opengl/OpenGLSpotShadowBuffer.h"
 #include "opengl/OpenGLPointShadowBuffer.h"
 
-const static Range<float> CASCADE_PARAMETERS[4][2] = {
+const static Range<float> CASCADE_PARAMETERS[4] = {
   { 1.0f, 200.0f },
   { 200.0f, 500.0f },
   { 500.0f, 1250.0f },
   { 1250.0f, 2500.0f }
 };
 
-OpenGLShadowCaster::OpenGLShadowCaster(const Light* light) {
+// The farthest distance from the camera at which directional
+// light shadows are rendered
+const static float MAX_CASCADE_DEPTH = 2500.0f;
+
+// The minimum depth span covered by all cascades, preventing
+// degenerate cascades when all visible surfaces share a depth
+const static float MIN_CASCADE_DEPTH_SPAN = 100.0f;
+
+// Blends between uniform (0.0) and logarithmic (1.0) splits
+const static float CASCADE_SPLIT_LAMBDA = 0.8f;
+
+// Determines how quickly cascade splits move toward newly-fitted
+// splits, damping flicker from frame-to-frame depth changes
+const static float CASCADE_SPLIT_ADAPTATION = 0.25f;
+
+OpenGLShadowCaster::OpenGLShadowCaster(const Light* light) : lightSnapshot(*light) {
   sourceLight = light;
   auto& shadowMapSize = light->shadowMapSize;
 
+  for (unsigned int i = 0; i < 4; i++) {
+    cascadeRanges[i] = CASCADE_PARAMETERS[i];
+  }
+
   switch (light->type) {
     case Light::LightType::DIRECTIONAL:
       glShadowBuffer = new OpenGLDirectionalShadowBuffer();
 
       glShadowBuffer->createFrameBuffer(shadowMapSize.width, shadowMapSize.height);
+
+      if (light->shadowFilter == Light::ShadowFilter::EVSM) {
+        glMomentsBuffer = new OpenGLShadowMomentsBuffer(4);
+
+        glMomentsBuffer->createFrameBuffer(shadowMapSize.width, shadowMapSize.height);
+      }
+
       break;
     case Light::LightType::SPOTLIGHT:
       glShadowBuffer = new OpenGLSpotShadowBuffer();
 
       glShadowBuffer->createFrameBuffer(shadowMapSize.width, shadowMapSize.height);
+
+      if (light->shadowFilter == Light::ShadowFilter::EVSM) {
+        glMomentsBuffer = new OpenGLShadowMomentsBuffer(1);
+
+        glMomentsBuffer->createFrameBuffer(shadowMapSize.width, shadowMapSize.height);
+      }
+
       break;
     case Light::LightType::POINT:
       glShadowBuffer = new OpenGLPointShadowBuffer();
@@ -38,6 +72,76 @@ OpenGLShadowCaster::OpenGLShadowCaster(const Light* light) {
 
 OpenGLShadowCaster::~OpenGLShadowCaster() {
   delete glShadowBuffer;
+  delete glMomentsBuffer;
+}
+
+/**
+ * Fits cascade splits to the range of visible depths, using the
+ * "practical" split scheme: a blend of logarithmic splits, which
+ * distribute shadow map resolution evenly in screen space, and
+ * uniform splits, which avoid overly thin near cascades.
+ */
+void OpenGLShadowCaster::fitCascades(const Range<float>& visibleDepthRange) {
+  float near = std::max(visibleDepthRange.start, 1.0f);
+  float far = std::min(visibleDepthRange.end, MAX_CASCADE_DEPTH);
+
+  far = std::max(far, near + MIN_CASCADE_DEPTH_SPAN);
+
+  float start = near;
+
+  for (unsigned int i = 0; i < 4; i++) {
+    float ratio = float(i + 1) / 4.0f;
+    float logSplit = near * powf(far / near, ratio);
+    float uniformSplit = near + (far - near) * ratio;
+    float split = uniformSplit + (logSplit - uniformSplit) * CASCADE_SPLIT_LAMBDA;
+    Range<float>& range = cascadeRanges[i];
+
+    range.start += (start - range.start) * CASCADE_SPLIT_ADAPTATION;
+    range.end += (split - range.end) * CASCADE_SPLIT_ADAPTATION;
+
+    start = range.end;
+  }
+}
+
+float OpenGLShadowCaster::getCascadeSplit(int cascadeIndex) const {
+  return cascadeRanges[cascadeIndex].end;
+}
+
+/**
+ * Returns the command list for one of the light's views. Only the
+ * multi-pass directional light view records more than one list, one
+ * per shadow cascade.
+ */
+/**
+ * Returns the slot of the light constants buffer holding this light's
+ * constants, as of the last update.
+ */
+unsigned int OpenGLShadowCaster::getLightConstantSlot() const {
+  return lightConstantSlot;
+}
+
+RenderCommandList& OpenGLShadowCaster::getLightViewCommands(unsigned int index) {
+  return lightViewCommands[index];
+}
+
+/**
+ * Returns the queue light view objects are sorted in, which is kept
+ * between frames so that recording doesn't reallocate it.
+ */
+OpenGLRenderQueue& OpenGLShadowCaster::getLightViewQueue() {
+  return lightViewQueue;
+}
+
+OpenGLShadowMomentsBuffer* OpenGLShadowCaster::getMomentsBuffer() {
+  return glMomentsBuffer;
+}
+
+/**
+ * Returns the light as of the last snapshot, which is safe to read
+ * while the source light goes on changing.
+ */
+const Light* OpenGLShadowCaster::getLight() const {
+  return &lightSnapshot;
 }
 
 const Light* OpenGLShadowCaster::getSourceLight() const {
@@ -45,7 +149,7 @@ const Light* OpenGLShadowCaster::getSourceLight() const {
 }
 
 Matrix4 OpenGLShadowCaster::getCascadedLightMatrix(int cascadeIndex, const Camera& camera) const {
-  const Range<float>& range = *CASCADE_PARAMETERS[cascadeIndex];
+  const Range<float>& range = cascadeRanges[cascadeIndex];
 
   float tanFov = tanf(0.5f * camera.fov * M_PI / 180.0f);
   float tanNear = tanFov * range.start;
@@ -56,7 +160,7 @@ Matrix4 OpenGLShadowCaster::getCascadedLightMatrix(int cascadeIndex, const Camer
   Vec3f nearCenter = camera.position + forward * range.start;
   Vec3f farCenter = camera.position + forward * range.end;
   Vec3f frustumCenter = nearCenter + forward * (range.end - range.start) * 0.5f;
-  Matrix4 lightTransform = Matrix4::lookAt(frustumCenter, sourceLight->direction, Vec3f(0.0f, 1.0f, 0.0f));
+  Matrix4 lightTransform = Matrix4::lookAt(frustumCenter, lightSnapshot.direction, Vec3f(0.0f, 1.0f, 0.0f));
 
   Frustum frustum;
 
@@ -74,14 +178,26 @@ Matrix4 OpenGLShadowCaster::getCascadedLightMatrix(int cascadeIndex, const Camer
 
   Bounds3d bounds = frustum.getBounds();
   Matrix4 projection = Matrix4::orthographic(bounds.top, bounds.bottom, bounds.left, bounds.right, bounds.back - 1000.0f, bounds.front);
-  Matrix4 view = Matrix4::lookAt(frustumCenter.gl(), sourceLight->direction.invert().gl(), Vec3f(0.0f, 1.0f, 0.0f));
+  Matrix4 view = Matrix4::lookAt(frustumCenter.gl(), lightSnapshot.direction.invert().gl(), Vec3f(0.0f, 1.0f, 0.0f));
 
   return (projection * view).transpose();
 }
 
 Matrix4 OpenGLShadowCaster::getLightMatrix(const Vec3f& direction, const Vec3f& top) const {
-  Matrix4 projection = Matrix4::projection({ 1024, 1024 }, 90.0f, 1.0f, sourceLight->radius);
-  Matrix4 view = Matrix4::lookAt(sourceLight->position.gl(), direction.invert().gl(), top);
+  Matrix4 projection = Matrix4::projection({ 1024, 1024 }, 90.0f, 1.0f, lightSnapshot.radius);
+  Matrix4 view = Matrix4::lookAt(lightSnapshot.position.gl(), direction.invert().gl(), top);
 
   return (projection * view).transpose();
 }
+
+/**
+ * Copies the source light's current state, before the frame's light
+ * views are recorded.
+ */
+void OpenGLShadowCaster::setLightConstantSlot(unsigned int slot) {
+  lightConstantSlot = slot;
+}
+
+void OpenGLShadowCaster::snapshotLight() {
+  lightSnapshot = *sourceLight;
+}
@@ -5,18 +5,30 @@
 #include "subsystem/entities/Light.h"
 #include "subsystem/entities/Camera.h"
 #include "subsystem/Math.h"
+#include "subsystem/RenderCommandList.h"
 #include "opengl/FrameBuffer.h"
 #include "opengl/OpenGLObject.h"
+#include "opengl/OpenGLRenderQueue.h"
 #include "opengl/AbstractBuffer.h"
+#include "opengl/OpenGLShadowMomentsBuffer.h"
 
 class OpenGLShadowCaster {
 public:
   OpenGLShadowCaster(const Light* light);
   ~OpenGLShadowCaster();
 
+  void fitCascades(const Range<float>& visibleDepthRange);
+  float getCascadeSplit(int cascadeIndex) const;
+  const Light* getLight() const;
+  unsigned int getLightConstantSlot() const;
+  RenderCommandList& getLightViewCommands(unsigned int index = 0);
+  OpenGLRenderQueue& getLightViewQueue();
+  OpenGLShadowMomentsBuffer* getMomentsBuffer();
   const Light* getSourceLight() const;
   Matrix4 getCascadedLightMatrix(int cascadeIndex, const Camera& camera) const;
   Matrix4 getLightMatrix(const Vec3f& direction, const Vec3f& top) const;
+  void setLightConstantSlot(unsigned int slot);
+  void snapshotLight();
 
   template<typename T>
   T* getShadowBuffer() {
@@ -27,5 +39,11 @@ private:
   static const float cascadeSizes[3][2];
 
   const Light* sourceLight = nullptr;
+  Light lightSnapshot;
+  Range<float> cascadeRanges[4];
+  RenderCommandList lightViewCommands[4];
+  OpenGLRenderQueue lightViewQueue;
+  unsigned int lightConstantSlot = 0;
   AbstractBuffer* glShadowBuffer = nullptr;
+  OpenGLShadowMomentsBuffer* glMomentsBuffer = nullptr;
 };
\ No newline at end of file
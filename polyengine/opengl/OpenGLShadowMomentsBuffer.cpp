@@ -0,0 +1,49 @@
+#include "opengl/OpenGLShadowMomentsBuffer.h"
+#include "opengl/FrameBuffer.h"
+
+OpenGLShadowMomentsBuffer::OpenGLShadowMomentsBuffer(unsigned int layers) {
+  this->layers = layers;
+}
+
+OpenGLShadowMomentsBuffer::~OpenGLShadowMomentsBuffer() {
+  delete blurFrameBuffer;
+}
+
+void OpenGLShadowMomentsBuffer::createFrameBuffer(unsigned int width, unsigned int height) {
+  if (frameBuffer != nullptr) {
+    delete frameBuffer;
+    delete blurFrameBuffer;
+  }
+
+  frameBuffer = new FrameBuffer(width, height, MemoryTag::GPU_SHADOW_MAPS);
+
+  frameBuffer->addColorTextureArray(GL_RGBA32F, GL_RGBA, layers, GL_CLAMP_TO_EDGE, GL_TEXTURE5);
+  frameBuffer->bindColorTextures();
+
+  blurFrameBuffer = new FrameBuffer(width, height, MemoryTag::GPU_SHADOW_MAPS);
+
+  blurFrameBuffer->addColorTextureArray(GL_RGBA32F, GL_RGBA, layers, GL_CLAMP_TO_EDGE, GL_TEXTURE6);
+  blurFrameBuffer->bindColorTextures();
+}
+
+void OpenGLShadowMomentsBuffer::generateMipmaps() {
+  frameBuffer->generateMipmaps();
+}
+
+unsigned int OpenGLShadowMomentsBuffer::getTotalLayers() const {
+  return layers;
+}
+
+void OpenGLShadowMomentsBuffer::startReadingBlurBuffer() {
+  blurFrameBuffer->startReading();
+}
+
+void OpenGLShadowMomentsBuffer::writeToBlurLayer(unsigned int layer) {
+  blurFrameBuffer->startWriting();
+  blurFrameBuffer->writeToLayer(layer);
+}
+
+void OpenGLShadowMomentsBuffer::writeToMomentsLayer(unsigned int layer) {
+  frameBuffer->startWriting();
+  frameBuffer->writeToLayer(layer);
+}
\ No newline at end of file
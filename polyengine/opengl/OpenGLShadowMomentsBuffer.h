@@ -0,0 +1,27 @@
+#pragma once
+
+#include "opengl/AbstractBuffer.h"
+
+/**
+ * Stores prefiltered exponential variance shadow map (EVSM) moments
+ * for each layer of a directional or spot light shadow map. Depth
+ * values are warped and blurred horizontally into an intermediate
+ * buffer, then blurred vertically into the final moments buffer,
+ * which is mipmapped for filtered lookups.
+ */
+class OpenGLShadowMomentsBuffer : public AbstractBuffer {
+public:
+  OpenGLShadowMomentsBuffer(unsigned int layers);
+  ~OpenGLShadowMomentsBuffer();
+
+  void createFrameBuffer(unsigned int width, unsigned int height) override;
+  void generateMipmaps();
+  unsigned int getTotalLayers() const;
+  void startReadingBlurBuffer();
+  void writeToBlurLayer(unsigned int layer);
+  void writeToMomentsLayer(unsigned int layer);
+
+private:
+  unsigned int layers;
+  FrameBuffer* blurFrameBuffer = nullptr;
+};
\ No newline at end of file
@@ -6,9 +6,10 @@ void OpenGLSpotShadowBuffer::createFrameBuffer(unsigned int width, unsigned int
     delete frameBuffer;
   }
 
-  frameBuffer = new FrameBuffer(width, height);
+  frameBuffer = new FrameBuffer(width, height, MemoryTag::GPU_SHADOW_MAPS);
 
-  frameBuffer->addColorTexture(GL_R32F, GL_RED, GL_CLAMP_TO_BORDER, GL_TEXTURE3);
-  frameBuffer->addDepthStencilBuffer();
-  frameBuffer->bindColorTextures();
+  // Spot light shadow maps use a single-layer depth texture array,
+  // letting them share shadow sampling routines with directional
+  // cascades
+  frameBuffer->addDepthTextureArray(1, GL_TEXTURE3, GL_TEXTURE4);
 }
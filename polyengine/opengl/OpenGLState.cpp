@@ -0,0 +1,459 @@
+#include <cstring>
+
+#include "opengl/OpenGLState.h"
+#include "subsystem/PerformanceProfiler.h"
+
+/**
+ * Marks shadowed state whose actual value isn't known, so the next
+ * change to it is always issued.
+ */
+const static GLuint UNKNOWN = 0xFFFFFFFF;
+
+void OpenGLState::activeTexture(GLenum unit) {
+  if (shouldIssue(unit == activeTextureUnit)) {
+    glActiveTexture(unit);
+
+    activeTextureUnit = unit;
+  }
+}
+
+void OpenGLState::bindBuffer(GLenum target, GLuint buffer) {
+  if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    // Element array buffer bindings are part of the bound vertex
+    // array's state, so they're tracked per vertex array
+    auto element = elementArrayBuffers.find(vao);
+
+    if (shouldIssue(vao != UNKNOWN && element != elementArrayBuffers.end() && element->second == buffer)) {
+      glBindBuffer(target, buffer);
+
+      if (vao != UNKNOWN) {
+        elementArrayBuffers[vao] = buffer;
+      }
+    }
+
+    return;
+  }
+
+  int index = getBufferTargetIndex(target);
+
+  if (shouldIssue(index >= 0 && buffers[index] == buffer)) {
+    glBindBuffer(target, buffer);
+
+    if (index >= 0) {
+      buffers[index] = buffer;
+    }
+  }
+}
+
+void OpenGLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+  bindBufferRange(target, index, buffer, 0, 0);
+}
+
+/**
+ * Binds a range of a buffer to an indexed binding point. A size of
+ * 0 binds the entire buffer. Indexed binds also replace the target's
+ * generic binding, which is shadowed accordingly.
+ */
+void OpenGLState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+  int targetIndex = getBufferTargetIndex(target);
+  bool isTracked = targetIndex >= 0 && index < MAX_INDEXED_BUFFERS;
+
+  if (isTracked) {
+    auto& binding = indexedBuffers[targetIndex][index];
+
+    if (!shouldIssue(binding.buffer == buffer && binding.offset == offset && binding.size == size)) {
+      return;
+    }
+
+    binding = { buffer, offset, size };
+    buffers[targetIndex] = buffer;
+  } else {
+    shouldIssue(false);
+  }
+
+  if (size == 0) {
+    glBindBufferBase(target, index, buffer);
+  } else {
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+}
+
+void OpenGLState::bindFramebuffer(GLenum target, GLuint framebuffer) {
+  bool isDrawTarget = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+  bool isReadTarget = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+
+  bool isRedundant = (
+    (!isDrawTarget || drawFramebuffer == framebuffer) &&
+    (!isReadTarget || readFramebuffer == framebuffer)
+  );
+
+  if (shouldIssue(isRedundant)) {
+    glBindFramebuffer(target, framebuffer);
+
+    if (isDrawTarget) {
+      drawFramebuffer = framebuffer;
+    }
+
+    if (isReadTarget) {
+      readFramebuffer = framebuffer;
+    }
+  }
+}
+
+void OpenGLState::bindSampler(GLuint unit, GLuint sampler) {
+  bool isTracked = unit < MAX_TEXTURE_UNITS;
+
+  if (shouldIssue(isTracked && samplers[unit] == sampler)) {
+    glBindSampler(unit, sampler);
+
+    if (isTracked) {
+      samplers[unit] = sampler;
+    }
+  }
+}
+
+/**
+ * Binds a texture to the active texture unit, e.g. in order to
+ * allocate or configure it.
+ */
+void OpenGLState::bindTexture(GLenum target, GLuint texture) {
+  bindTexture(activeTextureUnit == UNKNOWN ? GL_TEXTURE0 : activeTextureUnit, target, texture);
+}
+
+void OpenGLState::bindTexture(GLenum unit, GLenum target, GLuint texture) {
+  unsigned int unitIndex = unit - GL_TEXTURE0;
+  int targetIndex = getTextureTargetIndex(target);
+  bool isTracked = unitIndex < MAX_TEXTURE_UNITS && targetIndex >= 0;
+
+  if (shouldIssue(isTracked && textures[unitIndex][targetIndex] == texture)) {
+    activeTexture(unit);
+    glBindTexture(target, texture);
+
+    PerformanceProfiler::trackCounter(ProfiledCounter::TEXTURE_SWITCHES);
+
+    if (isTracked) {
+      textures[unitIndex][targetIndex] = texture;
+    }
+  }
+}
+
+void OpenGLState::bindVertexArray(GLuint vao) {
+  if (shouldIssue(vao == OpenGLState::vao)) {
+    glBindVertexArray(vao);
+
+    OpenGLState::vao = vao;
+  }
+}
+
+void OpenGLState::cullFace(GLenum mode) {
+  if (shouldIssue(mode == cullFaceMode)) {
+    glCullFace(mode);
+
+    cullFaceMode = mode;
+  }
+}
+
+/**
+ * Deleted objects are implicitly unbound, and their names may be
+ * reused by later objects, so any shadowed bindings to them have
+ * to be reset along with them.
+ */
+void OpenGLState::deleteBuffers(GLsizei total, const GLuint* buffers) {
+  for (GLsizei i = 0; i < total; i++) {
+    for (unsigned int target = 0; target < TOTAL_BUFFER_TARGETS; target++) {
+      if (OpenGLState::buffers[target] == buffers[i]) {
+        OpenGLState::buffers[target] = 0;
+      }
+
+      for (auto& binding : indexedBuffers[target]) {
+        if (binding.buffer == buffers[i]) {
+          binding = { 0, 0, 0 };
+        }
+      }
+    }
+
+    for (auto& entry : elementArrayBuffers) {
+      if (entry.second == buffers[i]) {
+        entry.second = 0;
+      }
+    }
+  }
+
+  glDeleteBuffers(total, buffers);
+}
+
+void OpenGLState::deleteFramebuffers(GLsizei total, const GLuint* framebuffers) {
+  for (GLsizei i = 0; i < total; i++) {
+    if (drawFramebuffer == framebuffers[i]) {
+      drawFramebuffer = 0;
+    }
+
+    if (readFramebuffer == framebuffers[i]) {
+      readFramebuffer = 0;
+    }
+  }
+
+  glDeleteFramebuffers(total, framebuffers);
+}
+
+/**
+ * A program in use is only flagged for deletion until it's no longer
+ * current, but its name may still be reused, so the shadowed program
+ * is reset so that any program with the same name is reissued.
+ */
+void OpenGLState::deleteProgram(GLuint program) {
+  if (OpenGLState::program == program) {
+    OpenGLState::program = UNKNOWN;
+  }
+
+  glDeleteProgram(program);
+}
+
+void OpenGLState::deleteSamplers(GLsizei total, const GLuint* samplers) {
+  for (GLsizei i = 0; i < total; i++) {
+    for (auto& sampler : OpenGLState::samplers) {
+      if (sampler == samplers[i]) {
+        sampler = 0;
+      }
+    }
+  }
+
+  glDeleteSamplers(total, samplers);
+}
+
+void OpenGLState::deleteTextures(GLsizei total, const GLuint* textures) {
+  for (GLsizei i = 0; i < total; i++) {
+    for (auto& unit : OpenGLState::textures) {
+      for (auto& texture : unit) {
+        if (texture == textures[i]) {
+          texture = 0;
+        }
+      }
+    }
+  }
+
+  glDeleteTextures(total, textures);
+}
+
+void OpenGLState::deleteVertexArrays(GLsizei total, const GLuint* vaos) {
+  for (GLsizei i = 0; i < total; i++) {
+    if (vao == vaos[i]) {
+      vao = 0;
+    }
+
+    elementArrayBuffers.erase(vaos[i]);
+  }
+
+  glDeleteVertexArrays(total, vaos);
+}
+
+void OpenGLState::disable(GLenum capability) {
+  int index = getCapabilityIndex(capability);
+
+  if (shouldIssue(index >= 0 && capabilities[index] == 0)) {
+    glDisable(capability);
+
+    if (index >= 0) {
+      capabilities[index] = 0;
+    }
+  }
+}
+
+void OpenGLState::enable(GLenum capability) {
+  int index = getCapabilityIndex(capability);
+
+  if (shouldIssue(index >= 0 && capabilities[index] == 1)) {
+    glEnable(capability);
+
+    if (index >= 0) {
+      capabilities[index] = 1;
+    }
+  }
+}
+
+int OpenGLState::getBufferTargetIndex(GLenum target) {
+  switch (target) {
+    case GL_ARRAY_BUFFER:
+      return BufferTarget::ARRAY_BUFFER;
+    case GL_UNIFORM_BUFFER:
+      return BufferTarget::UNIFORM_BUFFER;
+    case GL_SHADER_STORAGE_BUFFER:
+      return BufferTarget::SHADER_STORAGE_BUFFER;
+    default:
+      return -1;
+  }
+}
+
+int OpenGLState::getCapabilityIndex(GLenum capability) {
+  switch (capability) {
+    case GL_BLEND:
+      return Capability::BLEND;
+    case GL_CULL_FACE:
+      return Capability::CULL_FACE;
+    case GL_DEPTH_TEST:
+      return Capability::DEPTH_TEST;
+    case GL_STENCIL_TEST:
+      return Capability::STENCIL_TEST;
+    default:
+      return -1;
+  }
+}
+
+unsigned int OpenGLState::getIssuedCalls() {
+  return issuedCalls;
+}
+
+unsigned int OpenGLState::getSkippedCalls() {
+  return skippedCalls;
+}
+
+int OpenGLState::getTextureTargetIndex(GLenum target) {
+  switch (target) {
+    case GL_TEXTURE_2D:
+      return TextureTarget::TEXTURE_2D;
+    case GL_TEXTURE_2D_ARRAY:
+      return TextureTarget::TEXTURE_2D_ARRAY;
+    case GL_TEXTURE_CUBE_MAP:
+      return TextureTarget::TEXTURE_CUBE_MAP;
+    default:
+      return -1;
+  }
+}
+
+/**
+ * Forgets all shadowed state, so every subsequent state change is
+ * issued until the shadowed state is known again.
+ */
+void OpenGLState::invalidate() {
+  program = UNKNOWN;
+  vao = UNKNOWN;
+  drawFramebuffer = UNKNOWN;
+  readFramebuffer = UNKNOWN;
+  activeTextureUnit = UNKNOWN;
+  cullFaceMode = UNKNOWN;
+  stencilFuncState = { UNKNOWN, 0, 0 };
+  stencilOpState = { UNKNOWN, UNKNOWN, UNKNOWN };
+  stencilMaskState = UNKNOWN;
+  viewportState = { 0, 0, -1, -1 };
+
+  for (auto& unit : textures) {
+    for (auto& texture : unit) {
+      texture = UNKNOWN;
+    }
+  }
+
+  for (auto& sampler : samplers) {
+    sampler = UNKNOWN;
+  }
+
+  for (unsigned int target = 0; target < TOTAL_BUFFER_TARGETS; target++) {
+    buffers[target] = UNKNOWN;
+
+    for (auto& binding : indexedBuffers[target]) {
+      binding = { UNKNOWN, 0, 0 };
+    }
+  }
+
+  elementArrayBuffers.clear();
+
+  memset(capabilities, -1, sizeof(capabilities));
+}
+
+void OpenGLState::resetCounters() {
+  issuedCalls = 0;
+  skippedCalls = 0;
+}
+
+/**
+ * Counts a state change as either issued or skipped, returning
+ * whether it needs to be issued.
+ */
+bool OpenGLState::shouldIssue(bool isRedundant) {
+  if (isRedundant) {
+    skippedCalls++;
+  } else {
+    issuedCalls++;
+  }
+
+  return !isRedundant;
+}
+
+void OpenGLState::stencilFunc(GLenum func, GLint ref, GLuint mask) {
+  bool isRedundant = (
+    stencilFuncState.func == func &&
+    stencilFuncState.ref == ref &&
+    stencilFuncState.mask == mask
+  );
+
+  if (shouldIssue(isRedundant)) {
+    glStencilFunc(func, ref, mask);
+
+    stencilFuncState = { func, ref, mask };
+  }
+}
+
+void OpenGLState::stencilMask(GLuint mask) {
+  if (shouldIssue(mask == stencilMaskState)) {
+    glStencilMask(mask);
+
+    stencilMaskState = mask;
+  }
+}
+
+void OpenGLState::stencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass) {
+  bool isRedundant = (
+    stencilOpState.stencilFail == stencilFail &&
+    stencilOpState.depthFail == depthFail &&
+    stencilOpState.depthPass == depthPass
+  );
+
+  if (shouldIssue(isRedundant)) {
+    glStencilOp(stencilFail, depthFail, depthPass);
+
+    stencilOpState = { stencilFail, depthFail, depthPass };
+  }
+}
+
+void OpenGLState::useProgram(GLuint program) {
+  if (shouldIssue(program == OpenGLState::program)) {
+    glUseProgram(program);
+
+    PerformanceProfiler::trackCounter(ProfiledCounter::PROGRAM_SWITCHES);
+
+    OpenGLState::program = program;
+  }
+}
+
+void OpenGLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  bool isRedundant = (
+    viewportState.x == x &&
+    viewportState.y == y &&
+    viewportState.width == width &&
+    viewportState.height == height
+  );
+
+  if (shouldIssue(isRedundant)) {
+    glViewport(x, y, width, height);
+
+    viewportState = { x, y, width, height };
+  }
+}
+
+GLuint OpenGLState::program = UNKNOWN;
+GLuint OpenGLState::vao = UNKNOWN;
+GLuint OpenGLState::drawFramebuffer = UNKNOWN;
+GLuint OpenGLState::readFramebuffer = UNKNOWN;
+GLenum OpenGLState::activeTextureUnit = UNKNOWN;
+GLuint OpenGLState::textures[OpenGLState::MAX_TEXTURE_UNITS][OpenGLState::TOTAL_TEXTURE_TARGETS];
+GLuint OpenGLState::samplers[OpenGLState::MAX_TEXTURE_UNITS];
+GLuint OpenGLState::buffers[OpenGLState::TOTAL_BUFFER_TARGETS];
+OpenGLState::IndexedBufferBinding OpenGLState::indexedBuffers[OpenGLState::TOTAL_BUFFER_TARGETS][OpenGLState::MAX_INDEXED_BUFFERS];
+std::unordered_map<GLuint, GLuint> OpenGLState::elementArrayBuffers;
+char OpenGLState::capabilities[OpenGLState::TOTAL_CAPABILITIES];
+GLenum OpenGLState::cullFaceMode = UNKNOWN;
+OpenGLState::StencilFunc OpenGLState::stencilFuncState = { UNKNOWN, 0, 0 };
+OpenGLState::StencilOp OpenGLState::stencilOpState = { UNKNOWN, UNKNOWN, UNKNOWN };
+GLuint OpenGLState::stencilMaskState = UNKNOWN;
+OpenGLState::Viewport OpenGLState::viewportState = { 0, 0, -1, -1 };
+unsigned int OpenGLState::issuedCalls = 0;
+unsigned int OpenGLState::skippedCalls = 0;
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "glew.h"
+#include "glut.h"
+
+/**
+ * Shadows the OpenGL context state which the engine changes while
+ * rendering, so redundant state changes and binds can be skipped
+ * rather than submitted to the driver. All engine GL state changes
+ * must go through here, or the shadowed state will fall out of sync
+ * with the context; invalidate() can be used to resynchronize after
+ * any external code touches the context.
+ */
+class OpenGLState {
+public:
+  static void bindBuffer(GLenum target, GLuint buffer);
+  static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+  static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+  static void bindFramebuffer(GLenum target, GLuint framebuffer);
+  static void bindSampler(GLuint unit, GLuint sampler);
+  static void bindTexture(GLenum target, GLuint texture);
+  static void bindTexture(GLenum unit, GLenum target, GLuint texture);
+  static void bindVertexArray(GLuint vao);
+  static void cullFace(GLenum mode);
+  static void deleteBuffers(GLsizei total, const GLuint* buffers);
+  static void deleteFramebuffers(GLsizei total, const GLuint* framebuffers);
+  static void deleteProgram(GLuint program);
+  static void deleteSamplers(GLsizei total, const GLuint* samplers);
+  static void deleteTextures(GLsizei total, const GLuint* textures);
+  static void deleteVertexArrays(GLsizei total, const GLuint* vaos);
+  static void disable(GLenum capability);
+  static void enable(GLenum capability);
+  static unsigned int getIssuedCalls();
+  static unsigned int getSkippedCalls();
+  static void invalidate();
+  static void resetCounters();
+  static void stencilFunc(GLenum func, GLint ref, GLuint mask);
+  static void stencilMask(GLuint mask);
+  static void stencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+  static void useProgram(GLuint program);
+  static void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+  const static unsigned int MAX_TEXTURE_UNITS = 32;
+  const static unsigned int MAX_INDEXED_BUFFERS = 16;
+
+  /**
+   * Texture and buffer targets whose bindings are shadowed. Binds
+   * to any other target are always issued.
+   */
+  enum TextureTarget {
+    TEXTURE_2D,
+    TEXTURE_2D_ARRAY,
+    TEXTURE_CUBE_MAP,
+    TOTAL_TEXTURE_TARGETS
+  };
+
+  enum BufferTarget {
+    ARRAY_BUFFER,
+    UNIFORM_BUFFER,
+    SHADER_STORAGE_BUFFER,
+    TOTAL_BUFFER_TARGETS
+  };
+
+  enum Capability {
+    BLEND,
+    CULL_FACE,
+    DEPTH_TEST,
+    STENCIL_TEST,
+    TOTAL_CAPABILITIES
+  };
+
+  struct IndexedBufferBinding {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+  };
+
+  struct StencilFunc {
+    GLenum func;
+    GLint ref;
+    GLuint mask;
+  };
+
+  struct StencilOp {
+    GLenum stencilFail;
+    GLenum depthFail;
+    GLenum depthPass;
+  };
+
+  struct Viewport {
+    GLint x;
+    GLint y;
+    GLsizei width;
+    GLsizei height;
+  };
+
+  static GLuint program;
+  static GLuint vao;
+  static GLuint drawFramebuffer;
+  static GLuint readFramebuffer;
+  static GLenum activeTextureUnit;
+  static GLuint textures[MAX_TEXTURE_UNITS][TOTAL_TEXTURE_TARGETS];
+  static GLuint samplers[MAX_TEXTURE_UNITS];
+  static GLuint buffers[TOTAL_BUFFER_TARGETS];
+  static IndexedBufferBinding indexedBuffers[TOTAL_BUFFER_TARGETS][MAX_INDEXED_BUFFERS];
+  static std::unordered_map<GLuint, GLuint> elementArrayBuffers;
+  static char capabilities[TOTAL_CAPABILITIES];
+  static GLenum cullFaceMode;
+  static StencilFunc stencilFuncState;
+  static StencilOp stencilOpState;
+  static GLuint stencilMaskState;
+  static Viewport viewportState;
+  static unsigned int issuedCalls;
+  static unsigned int skippedCalls;
+
+  static void activeTexture(GLenum unit);
+  static int getBufferTargetIndex(GLenum target);
+  static int getCapabilityIndex(GLenum capability);
+  static int getTextureTargetIndex(GLenum target);
+  static bool shouldIssue(bool isRedundant);
+};
\ No newline at end of file
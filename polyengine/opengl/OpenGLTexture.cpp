@@ -1,6 +1,8 @@
 #include "glew.h"
 #include "glut.h"
 #include "opengl/OpenGLTexture.h"
+#include "opengl/OpenGLState.h"
+#include "subsystem/MemoryTracker.h"
 
 OpenGLTexture::OpenGLTexture(const Texture* texture, GLenum unit) {
   this->unit = unit;
@@ -16,13 +18,22 @@ OpenGLTexture::OpenGLTexture(const Texture* texture, GLenum unit) {
   glTexImage2D(GL_TEXTURE_2D, 0, format, surface->w, surface->h, 0, format, GL_UNSIGNED_BYTE, surface->pixels);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  totalBytes = surface->w * surface->h * (hasAlpha ? 4 : 3);
+
+  MemoryTracker::trackAllocation(MemoryTag::GPU_TEXTURES, totalBytes);
 }
 
 OpenGLTexture::~OpenGLTexture() {
-  glDeleteTextures(1, &id);
+  OpenGLState::deleteTextures(1, &id);
+
+  MemoryTracker::trackFree(MemoryTag::GPU_TEXTURES, totalBytes);
+}
+
+GLuint OpenGLTexture::getId() const {
+  return id;
 }
 
 void OpenGLTexture::use() {
-  glActiveTexture(unit);
-  glBindTexture(GL_TEXTURE_2D, id);
+  OpenGLState::bindTexture(unit, GL_TEXTURE_2D, id);
 }
\ No newline at end of file
@@ -8,9 +8,11 @@ public:
   OpenGLTexture(const Texture* texture, GLenum unit);
   ~OpenGLTexture();
 
+  GLuint getId() const;
   void use();
 
 private:
   GLuint id;
   GLenum unit;
+  unsigned int totalBytes = 0;
 };
\ No newline at end of file
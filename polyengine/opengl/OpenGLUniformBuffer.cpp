@@ -0,0 +1,86 @@
+#include <cstring>
+
+#include "opengl/OpenGLUniformBuffer.h"
+#include "opengl/OpenGLState.h"
+#include "subsystem/MemoryTracker.h"
+#include "subsystem/PerformanceProfiler.h"
+
+OpenGLUniformBuffer::OpenGLUniformBuffer(GLuint binding, unsigned int blockSize) {
+  GLint alignment = 256;
+
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+  this->binding = binding;
+  this->blockSize = blockSize;
+
+  slotSize = ((blockSize + alignment - 1) / alignment) * alignment;
+
+  glGenBuffers(1, &ubo);
+  OpenGLState::bindBuffer(GL_UNIFORM_BUFFER, ubo);
+  glBufferData(GL_UNIFORM_BUFFER, slotSize, 0, GL_DYNAMIC_DRAW);
+
+  allocatedSize = slotSize;
+
+  MemoryTracker::trackAllocation(MemoryTag::GPU_UNIFORMS, allocatedSize);
+
+  bind();
+}
+
+OpenGLUniformBuffer::~OpenGLUniformBuffer() {
+  OpenGLState::deleteBuffers(1, &ubo);
+
+  MemoryTracker::trackFree(MemoryTag::GPU_UNIFORMS, allocatedSize);
+}
+
+void OpenGLUniformBuffer::bind() {
+  bind(0);
+}
+
+void OpenGLUniformBuffer::bind(unsigned int slot) {
+  OpenGLState::bindBufferRange(GL_UNIFORM_BUFFER, binding, ubo, slot * slotSize, blockSize);
+}
+
+GLint OpenGLUniformBuffer::getBlockBinding(const char* blockName) {
+  if (strcmp(blockName, "FrameConstants") == 0) {
+    return UniformBlockBinding::FRAME_CONSTANTS_BINDING;
+  } else if (strcmp(blockName, "LightConstants") == 0) {
+    return UniformBlockBinding::LIGHT_CONSTANTS_BINDING;
+  } else if (strcmp(blockName, "DrawConstants") == 0) {
+    return UniformBlockBinding::DRAW_CONSTANTS_BINDING;
+  }
+
+  return -1;
+}
+
+void OpenGLUniformBuffer::update(const void* data) {
+  OpenGLState::bindBuffer(GL_UNIFORM_BUFFER, ubo);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, blockSize, data);
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::BYTES_UPLOADED, blockSize);
+}
+
+/**
+ * Uploads a contiguous array of blocks into consecutive slots. The
+ * buffer store is orphaned on each upload, so draws still reading
+ * the previous contents don't stall the update.
+ */
+void OpenGLUniformBuffer::update(const void* data, unsigned int totalSlots) {
+  if (totalSlots == 0) {
+    return;
+  }
+
+  slotData.resize(totalSlots * slotSize);
+
+  for (unsigned int i = 0; i < totalSlots; i++) {
+    memcpy(&slotData[i * slotSize], (const char*)data + i * blockSize, blockSize);
+  }
+
+  OpenGLState::bindBuffer(GL_UNIFORM_BUFFER, ubo);
+  glBufferData(GL_UNIFORM_BUFFER, totalSlots * slotSize, 0, GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, totalSlots * slotSize, slotData.data());
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::BYTES_UPLOADED, totalSlots * slotSize);
+  MemoryTracker::trackResize(MemoryTag::GPU_UNIFORMS, allocatedSize, totalSlots * slotSize);
+
+  allocatedSize = totalSlots * slotSize;
+}
\ No newline at end of file
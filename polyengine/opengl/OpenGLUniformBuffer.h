@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+
+#include "glew.h"
+#include "glut.h"
+
+/**
+ * Binding points for uniform blocks shared between programs. Blocks
+ * are assigned to these by name when programs are linked.
+ */
+enum UniformBlockBinding {
+  FRAME_CONSTANTS_BINDING = 0,
+  LIGHT_CONSTANTS_BINDING = 1,
+  DRAW_CONSTANTS_BINDING = 2
+};
+
+/**
+ * std140 mirror of FrameConstants in shaders/helpers/frame-constants.glsl.
+ */
+struct FrameConstants {
+  float projectionMatrix[16];
+  float viewMatrix[16];
+  float inverseViewProjectionMatrix[16];
+  float cameraPosition[3];
+  float time;
+};
+
+/**
+ * std140 mirror of LightConstants in shaders/helpers/light-constants.glsl.
+ */
+struct LightConstants {
+  float lightMatrices[6][16];
+  float cascadeSplits[4];
+  float position[3];
+  float padding0;
+  float direction[3];
+  float padding1;
+  float color[3];
+  float radius;
+  int type;
+  int padding2[3];
+};
+
+/**
+ * std140 mirror of DrawConstants in shaders/helpers/draw-constants.glsl.
+ */
+struct DrawConstants {
+  int cascadeLimit;
+  int padding[3];
+};
+
+static_assert(sizeof(FrameConstants) == 208, "FrameConstants must match its std140 layout");
+static_assert(sizeof(LightConstants) == 464, "LightConstants must match its std140 layout");
+static_assert(sizeof(DrawConstants) == 16, "DrawConstants must match its std140 layout");
+
+/**
+ * A uniform buffer holding one or more copies of a uniform block.
+ * Multiple copies are stored in slots aligned to the implementation's
+ * offset alignment, so each can be uploaded together once and bound
+ * individually as it's needed.
+ */
+class OpenGLUniformBuffer {
+public:
+  OpenGLUniformBuffer(GLuint binding, unsigned int blockSize);
+  ~OpenGLUniformBuffer();
+
+  static GLint getBlockBinding(const char* blockName);
+
+  void bind();
+  void bind(unsigned int slot);
+  void update(const void* data);
+  void update(const void* data, unsigned int totalSlots);
+
+private:
+  GLuint ubo = 0;
+  GLuint binding;
+  unsigned int blockSize;
+  unsigned int slotSize;
+  unsigned int allocatedSize = 0;
+  std::vector<char> slotData;
+};
\ No newline at end of file
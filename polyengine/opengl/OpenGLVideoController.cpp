@@ -1,6 +1,9 @@
+#include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <ctime>
 #include <algorithm>
+#include <chrono>
 
 #include "SDL.h"
 #include "glew.h"
@@ -11,6 +14,8 @@
 #include "opengl/OpenGLObject.h"
 #include "opengl/OpenGLScreenQuad.h"
 #include "opengl/OpenGLDebugger.h"
+#include "opengl/OpenGLGpuTimer.h"
+#include "opengl/OpenGLState.h"
 #include "opengl/ShaderProgram.h"
 #include "opengl/ShaderLoader.h"
 #include "opengl/FrameBuffer.h"
@@ -21,9 +26,11 @@
 #include "subsystem/entities/Object.h"
 #include "subsystem/entities/Light.h"
 #include "subsystem/entities/Instance.h"
+#include "subsystem/JobSystem.h"
 #include "subsystem/Math.h"
 #include "subsystem/PerformanceProfiler.h"
 #include "subsystem/Window.h"
+#include "subsystem/ZoneProfiler.h"
 
 OpenGLVideoController::OpenGLVideoController() {
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
@@ -39,19 +46,75 @@ void OpenGLVideoController::createPostShaders() {
   glPostShaderPipeline->addPostShader(new BloomShader());
   glPostShaderPipeline->addPostShader(new DofShader());
 
-  glPostShaderPipeline->createFrameBuffers(Window::size);
+  glPostShaderPipeline->fuseStages();
+}
+
+/**
+ * Builds the passes which make up each frame, importing the G-Buffer
+ * and rendering lighting into a transient scene buffer. The scene
+ * buffer tests against a copy of the G-Buffer's depth/stencil buffer,
+ * since lighting samples the original. The post shaders then chain
+ * off of the scene buffer, and the graph aliases any transient
+ * targets with non-overlapping lifetimes.
+ */
+void OpenGLVideoController::createRenderGraph() {
+  glRenderGraph->clear();
+
+  auto gBufferTarget = glRenderGraph->importFrameBuffer("g-buffer", gBuffer->getFrameBuffer());
+
+  sceneBuffer = glRenderGraph->createTexture("scene", { GL_RGBA32F, GL_RGBA });
+
+  glRenderGraph->setDepthStencilSource(sceneBuffer, gBuffer->getDepthStencilCopy());
+
+  glRenderGraph->addPass("geometry", {}, gBufferTarget, [=]() {
+    gBuffer->startWriting();
+
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    renderGeometry();
+  });
+
+  glRenderGraph->addPass("lighting", { gBufferTarget }, sceneBuffer, [=]() {
+    gBuffer->copyDepthStencil();
+    writeToSceneBuffer();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    gBuffer->startReading();
+
+    glIlluminator->renderNonShadowCasterLights();
+    glIlluminator->renderShadowCasterLights();
+    renderResolve();
+  });
+
+  glPostShaderPipeline->createPasses(*glRenderGraph, sceneBuffer);
+  glRenderGraph->compile(Window::size);
 }
 
 void OpenGLVideoController::createPreShaders() {
-  glPreShaders.push(new OpenGLPreShader("./shaders/pre-fx/fog.fragment.glsl"));
+  glPreShaders.push(new OpenGLPreShader("pre-fx/fog.glsl"));
+
+  std::vector<std::string> stagePaths;
+
+  for (auto* shader : glPreShaders) {
+    stagePaths.push_back(shader->getStagePath());
+  }
+
+  resolveProgram.create();
+  resolveProgram.attachShader(ShaderLoader::loadVertexShader("./shaders/quad.vertex.glsl"));
+  resolveProgram.attachShader(ShaderLoader::loadFragmentShader("./shaders/resolve.fragment.glsl", stagePaths));
+  resolveProgram.link();
 }
 
-Matrix4 OpenGLVideoController::createViewMatrix() {
-  const Camera& camera = scene->getCamera();
+Matrix4 OpenGLVideoController::createProjectionMatrix() {
+  return Matrix4::projection(Window::size, frameCamera.fov * 0.5f, 1.0f, 10000.0f).transpose();
+}
 
+Matrix4 OpenGLVideoController::createViewMatrix() {
   return (
-    Matrix4::rotate(camera.orientation) *
-    Matrix4::translate(camera.position.invert().gl())
+    Matrix4::rotate(frameCamera.orientation) *
+    Matrix4::translate(frameCamera.position.invert().gl())
   ).transpose();
 }
 
@@ -59,51 +122,92 @@ void OpenGLVideoController::onDestroy() {
   glPreShaders.free();
   glObjects.free();
   glShadowCasters.free();
+  glEntityHandles.clear();
 
   OpenGLObject::freeCachedResources();
+  OpenGLGpuTimer::free();
 
   delete gBuffer;
   delete glIlluminator;
   delete glPostShaderPipeline;
-
-  SDL_GL_DeleteContext(glContext);
+  delete glRenderGraph;
+  delete frameConstantsBuffer;
+  delete drawConstantsBuffer;
+  delete frameFences;
+
+  if (offscreenContext != nullptr) {
+    delete offscreenContext;
+  } else {
+    SDL_GL_DeleteContext(glContext);
+  }
 }
 
 void OpenGLVideoController::onEntityAdded(Entity* entity) {
   if (entity->isOfType<Object>() && !entity->isOfType<Instance>()) {
-    glObjects.push(new OpenGLObject((Object*)entity));
+    glEntityHandles[entity] = glObjects.push(new OpenGLObject((Object*)entity));
   } else if (entity->isOfType<Light>() && ((Light*)entity)->canCastShadows) {
-    glShadowCasters.push(new OpenGLShadowCaster((Light*)entity));
+    glEntityHandles[entity] = glShadowCasters.push(new OpenGLShadowCaster((Light*)entity));
   }
 
   OpenGLDebugger::checkErrors("Entity Added");
 }
 
+/**
+ * Deletes the glObject or glShadowCaster created for a removed entity,
+ * if any. Instances and lights which can't cast shadows have neither.
+ * Removals are only dispatched between frames, so nothing recorded
+ * for rendering can still refer to them.
+ */
 void OpenGLVideoController::onEntityRemoved(Entity* entity) {
-  // TODO: Delete removed glObjects/glShadowCasters
-  // from memory, since HeapList no longer does
+  auto entry = glEntityHandles.find(entity);
+
+  if (entry == glEntityHandles.end()) {
+    return;
+  }
+
+  SlotHandle handle = entry->second;
+
   if (entity->isOfType<Object>()) {
-    glObjects.removeWhere([=](OpenGLObject* glObject) {
-      return glObject->getSourceObject() == entity;
-    });
-  } else if (entity->isOfType<Light>() && ((Light*)entity)->canCastShadows) {
-    glShadowCasters.removeWhere([=](OpenGLShadowCaster* glShadowCaster) {
-      return glShadowCaster->getSourceLight() == entity;
-    });
+    delete glObjects.get(handle);
+
+    glObjects.remove(handle);
+  } else {
+    delete glShadowCasters.get(handle);
+
+    glShadowCasters.remove(handle);
   }
+
+  glEntityHandles.erase(entry);
 }
 
+/**
+ * Creates the context for the window, or without one, e.g. in a
+ * headless Window, an offscreen context rendering to a pbuffer.
+ */
 void OpenGLVideoController::onInit(SDL_Window* sdlWindow) {
-  glContext = SDL_GL_CreateContext(sdlWindow);
+  if (sdlWindow != nullptr) {
+    glContext = SDL_GL_CreateContext(sdlWindow);
+  } else {
+    offscreenContext = new OpenGLOffscreenContext();
+
+    if (!offscreenContext->create(Window::size.width, Window::size.height)) {
+      exit(EXIT_FAILURE);
+    }
+  }
+
   glewExperimental = true;
 
   glewInit();
 
-  glEnable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_STENCIL_TEST);
-  glCullFace(GL_BACK);
-  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+  hasGpuMemoryInfo = glewIsSupported("GL_NVX_gpu_memory_info");
+
+  // Context state is unknown until first set through the state cache
+  OpenGLState::invalidate();
+  OpenGLState::enable(GL_CULL_FACE);
+  OpenGLState::enable(GL_DEPTH_TEST);
+  OpenGLState::enable(GL_STENCIL_TEST);
+  OpenGLState::cullFace(GL_BACK);
+  OpenGLState::stencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
   glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ZERO);
 
   SDL_GL_SetSwapInterval(0);
@@ -111,43 +215,87 @@ void OpenGLVideoController::onInit(SDL_Window* sdlWindow) {
   gBuffer = new GBuffer();
   glIlluminator = new OpenGLIlluminator();
   glPostShaderPipeline = new OpenGLPostShaderPipeline();
+  glRenderGraph = new OpenGLRenderGraph();
+  frameConstantsBuffer = new OpenGLUniformBuffer(UniformBlockBinding::FRAME_CONSTANTS_BINDING, sizeof(FrameConstants));
+  drawConstantsBuffer = new OpenGLUniformBuffer(UniformBlockBinding::DRAW_CONSTANTS_BINDING, sizeof(DrawConstants));
+  frameFences = new OpenGLFrameFences();
+
+  drawConstantsBuffer->update(&drawConstants);
 
   gBuffer->createFrameBuffer(Window::size.width, Window::size.height);
   glIlluminator->setVideoController(this);
 
   createPreShaders();
   createPostShaders();
-
-  gBuffer->getFrameBuffer()->shareDepthStencilBuffer(glPostShaderPipeline->getFirstShader()->getFrameBuffer());
+  createRenderGraph();
 
   OpenGLDebugger::checkErrors("Initialization");
 }
 
+void OpenGLVideoController::onKeyDown(SDL_Keycode code) {
+  if (code == SDLK_F1) {
+    glIlluminator->toggleCascadeRenderMode();
+  }
+}
+
+/**
+ * Takes everything the frame renders from the scene: the camera,
+ * each object's instance data and each light, and the recorded
+ * command lists for every view. Rendering reads none of the scene
+ * itself, so that when pipelined, the scene can be simulated for the
+ * next frame while this one renders.
+ */
+void OpenGLVideoController::onPrepareFrame() {
+  PROFILE_ZONE("OpenGLVideoController::onPrepareFrame");
+
+  frameCamera = scene->getCamera();
+  frameRunningTime = scene->getRunningTime();
+
+  for (auto* glObject : glObjects) {
+    glObject->snapshotInstanceData(isPipelined);
+  }
+
+  glIlluminator->prepareLights();
+
+  recordCommandLists();
+}
+
 void OpenGLVideoController::onRender(SDL_Window* sdlWindow) {
-  gBuffer->startWriting();
+  PROFILE_ZONE("OpenGLVideoController::onRender");
+
+  // Command lists are recorded while the GPU may still be busy with
+  // the previous frame, and only once they're ready to be submitted
+  // is there any need to wait for it
+  PerformanceProfiler::trackGpuWaitTime(frameFences->wait());
 
-  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+  OpenGLGpuTimer::beginFrame();
 
-  renderGeometry();
+  {
+    PROFILE_GPU_ZONE("frame");
 
-  glPostShaderPipeline->getFirstShader()->writeToInputBuffer();
-  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-  glClear(GL_COLOR_BUFFER_BIT);
-  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-  gBuffer->startReading();
+    glRenderGraph->execute();
+  }
+
+  OpenGLGpuTimer::endFrame();
 
-  renderEmissiveSurfaces();
-  glIlluminator->renderNonShadowCasterLights();
-  glIlluminator->renderShadowCasterLights();
-  renderPreShaders();
-  glPostShaderPipeline->render();
   trackMemoryUsage();
 
-  glStencilMask(0xFF);
+  OpenGLState::stencilMask(0xFF);
+
+  PerformanceProfiler::trackStateChanges(OpenGLState::getIssuedCalls(), OpenGLState::getSkippedCalls());
+  OpenGLState::resetCounters();
 
-  SDL_GL_SwapWindow(sdlWindow);
-  glFinish();
+  {
+    PROFILE_ZONE("Swap");
+
+    if (offscreenContext != nullptr) {
+      offscreenContext->swap();
+    } else {
+      SDL_GL_SwapWindow(sdlWindow);
+    }
+  }
+
+  frameFences->signal();
 
   OpenGLDebugger::checkErrors("onRender");
 }
@@ -155,6 +303,7 @@ void OpenGLVideoController::onRender(SDL_Window* sdlWindow) {
 void OpenGLVideoController::onSceneChange(AbstractScene* scene) {
   glObjects.free();
   glShadowCasters.free();
+  glEntityHandles.clear();
 
   for (auto* object : scene->getStage().getObjects()) {
     onEntityAdded(object);
@@ -174,105 +323,243 @@ void OpenGLVideoController::onSceneChange(AbstractScene* scene) {
 }
 
 void OpenGLVideoController::onScreenSizeChange() {
-  glViewport(0, 0, Window::size.width, Window::size.height);
-
-  glPostShaderPipeline->createFrameBuffers(Window::size);
+  OpenGLState::viewport(0, 0, Window::size.width, Window::size.height);
 
   gBuffer->createFrameBuffer(Window::size.width, Window::size.height);
-  gBuffer->getFrameBuffer()->shareDepthStencilBuffer(glPostShaderPipeline->getFirstShader()->getFrameBuffer());
+
+  createRenderGraph();
 }
 
-void OpenGLVideoController::renderEmissiveSurfaces() {
-  auto& albedoProgram = gBuffer->getShaderProgram(GBuffer::Shader::ALBEDO);
+/**
+ * Records the command lists for every view rendered this frame, each
+ * as its own job. Recording only reads scene state, which
+ * doesn't change until the next update, so views can be recorded
+ * independently of one another and of the render thread.
+ */
+void OpenGLVideoController::recordCommandLists() {
+  PROFILE_ZONE("OpenGLVideoController::recordCommandLists");
 
-  albedoProgram.use();
-  albedoProgram.setInt("colorTexture", 0);
-  albedoProgram.setInt("normalDepthTexture", 1);
+  auto start = std::chrono::high_resolution_clock::now();
+  JobCounter counter;
 
-  glDisable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_STENCIL_TEST);
-  glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
+  JobSystem::run([=]() {
+    recordGeometry();
+  }, counter);
 
-  OpenGLScreenQuad::draw();
-}
+  glIlluminator->recordLightViews(counter);
 
-void OpenGLVideoController::renderGeometry() {
-  auto& geometryProgram = gBuffer->getShaderProgram(GBuffer::Shader::GEOMETRY);
+  JobSystem::wait(counter);
 
-  glEnable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_STENCIL_TEST);
+  std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
 
-  geometryProgram.use();
-  geometryProgram.setInt("modelTexture", 7);
-  geometryProgram.setInt("normalMap", 8);
+  PerformanceProfiler::trackCommandRecordTime(duration.count());
+}
 
-  Matrix4 projectionMatrix = Matrix4::projection(Window::size, scene->getCamera().fov * 0.5f, 1.0f, 10000.0f).transpose();
-  Matrix4 viewMatrix = createViewMatrix();
+/**
+ * Records the geometry view. Emissive objects are drawn first without
+ * writing to the stencil buffer, so lighting passes skip them; all
+ * other objects are then grouped by program variant and textures,
+ * and drawn front to back.
+ */
+void OpenGLVideoController::recordGeometry() {
+  PROFILE_ZONE("OpenGLVideoController::recordGeometry");
 
-  auto renderObject = [&](OpenGLObject* glObject) {
-    geometryProgram.setMatrix4("projectionMatrix", projectionMatrix);
-    geometryProgram.setMatrix4("viewMatrix", viewMatrix);
-    geometryProgram.setBool("hasTexture", glObject->hasTexture());
-    geometryProgram.setBool("hasNormalMap", glObject->hasNormalMap());
+  auto& geometryPrograms = gBuffer->getGeometryPrograms();
+  const Vec3f& cameraPosition = scene->getCamera().position;
+  unsigned int totalConsideredInstances = 0;
 
-    setObjectEffects(geometryProgram, glObject);
+  geometryQueue.clear();
+  geometryCommands.clear();
 
-    glObject->render();
-  };
+  for (auto* glObject : glObjects) {
+    auto* sourceObject = glObject->getSourceObject();
 
-  glStencilFunc(GL_ALWAYS, 1, 0xFF);
-  glStencilMask(0x00);
+    totalConsideredInstances += sourceObject->getTotalInstances();
 
-  for (auto* glObject : glObjects) {
-    if (glObject->getSourceObject()->isEmissive) {
-      renderObject(glObject);
+    if (sourceObject->getTotalRenderableInstances() == 0) {
+      continue;
     }
+
+    uint64_t key = OpenGLRenderQueue::createSortKey(
+      RenderPass::GEOMETRY_PASS,
+      sourceObject->isEmissive ? 0 : 1,
+      geometryPrograms.getVariantFlags(glObject->getShaderVariant()),
+      glObject->getMaterialId(),
+      sourceObject->getBoundsDistance(cameraPosition)
+    );
+
+    geometryQueue.submit(key, glObject);
   }
 
-  glStencilMask(0xFF);
+  geometryQueue.sort();
 
-  for (auto* glObject : glObjects) {
-    if (!glObject->getSourceObject()->isEmissive) {
-      renderObject(glObject);
+  for (auto& packet : geometryQueue.getPackets()) {
+    auto* glObject = packet.glObject;
+    auto* sourceObject = glObject->getSourceObject();
+
+    if (geometryCommands.setPipeline(&geometryPrograms, geometryPrograms.getVariantFlags(glObject->getShaderVariant()))) {
+      geometryCommands.setInt("modelTexture", 7);
+      geometryCommands.setInt("normalMap", 8);
     }
+
+    geometryCommands.setStencilMask(sourceObject->isEmissive ? 0x00 : 0xFF);
+    geometryCommands.draw(glObject, sourceObject, false);
   }
 
-  glStencilMask(0x00);
+  PerformanceProfiler::trackViewInstances("camera", totalConsideredInstances, geometryCommands.getTotalDrawnInstances());
 }
 
-void OpenGLVideoController::renderPreShaders() {
-  glEnable(GL_BLEND);
+void OpenGLVideoController::renderGeometry() {
+  OpenGLState::enable(GL_CULL_FACE);
+  OpenGLState::enable(GL_DEPTH_TEST);
+  OpenGLState::enable(GL_STENCIL_TEST);
+  OpenGLState::stencilFunc(GL_ALWAYS, 1, 0xFF);
 
-  for (auto* shader : glPreShaders) {
-    shader->getProgram().use();
-    shader->getProgram().setInt("colorTexture", 0);
-    shader->getProgram().setInt("normalDepthTexture", 1);
-    shader->getProgram().setInt("positionTexture", 2);
-    shader->render();
-  }
+  updateFrameConstants(createProjectionMatrix(), createViewMatrix());
+  replay(geometryCommands);
 
-  glDisable(GL_BLEND);
+  OpenGLState::stencilMask(0x00);
 }
 
-void OpenGLVideoController::setObjectEffects(ShaderProgram& program, OpenGLObject* glObject) {
-  unsigned int effects = glObject->getSourceObject()->effects;
+/**
+ * Resolves emissive surfaces and applies any pre-fx stages in one
+ * full-screen pass, blended over the accumulated lighting. Emissive
+ * surfaces receive no lighting, so blending leaves their albedo as-is.
+ */
+void OpenGLVideoController::renderResolve() {
+  PROFILE_GPU_ZONE("resolve");
+
+  resolveProgram.use();
+  setGBufferUniforms(resolveProgram);
+
+  OpenGLState::disable(GL_DEPTH_TEST);
+  OpenGLState::disable(GL_CULL_FACE);
+  OpenGLState::disable(GL_STENCIL_TEST);
+  OpenGLState::enable(GL_BLEND);
+
+  OpenGLScreenQuad::draw();
+
+  OpenGLState::disable(GL_BLEND);
+}
 
-  program.setFloat("time", scene->getRunningTime());
-  program.setInt("treeTransformFactor", (effects & ObjectEffects::TREE_ANIMATION) ? 1.0f : 0.0f);
-  program.setInt("grassTransformFactor", (effects & ObjectEffects::GRASS_ANIMATION) ? 1.0f : 0.0f);
+/**
+ * Binds G-Buffer sampler units for any program reading the G-Buffer.
+ * The matrix needed to rebuild world positions from depth is part of
+ * the frame constants.
+ */
+void OpenGLVideoController::setGBufferUniforms(ShaderProgram& program) {
+  program.setInt("colorTexture", 0);
+  program.setInt("normalTexture", 1);
+  program.setInt("depthTexture", 2);
 }
 
 void OpenGLVideoController::trackMemoryUsage() {
   GLint totalMemory = 0;
   GLint availableMemory = 0;
-  const char* vendor = (const char*)glGetString(GL_VENDOR);
 
-  if (strcmp(vendor, "NVIDIA Corporation") == 0) {
+  // Driver-reported usage is only available on NVIDIA; engine-tracked
+  // usage is reported through MemoryTracker regardless
+  if (hasGpuMemoryInfo) {
     glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &totalMemory);
     glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &availableMemory);
   }
 
   PerformanceProfiler::trackGpuMemory(totalMemory / 1000, (totalMemory - availableMemory) / 1000);
+}
+
+/**
+ * Replays a recorded command list. Pipeline handles refer to shader
+ * program variant sets, and draw handles to OpenGL objects, so any
+ * variants not yet compiled are compiled here on the render thread.
+ */
+void OpenGLVideoController::replay(const RenderCommandList& commandList) {
+  PROFILE_ZONE("OpenGLVideoController::replay");
+
+  auto start = std::chrono::high_resolution_clock::now();
+  ShaderProgram* activeProgram = nullptr;
+
+  for (auto& command : commandList.getCommands()) {
+    switch (command.type) {
+      case RenderCommandType::SET_PIPELINE: {
+        auto* programs = (ShaderProgramVariants*)command.pipeline.handle;
+
+        activeProgram = &programs->getVariant(command.pipeline.variant);
+        activeProgram->use();
+        break;
+      }
+      case RenderCommandType::SET_INT:
+        activeProgram->setInt(command.uniform.name, command.uniform.value);
+        break;
+      case RenderCommandType::SET_STENCIL_MASK:
+        OpenGLState::stencilMask(command.stencil.mask);
+        break;
+      case RenderCommandType::SET_DRAW_CONSTANTS:
+        updateDrawConstants(command.drawConstants.cascadeLimit);
+        break;
+      case RenderCommandType::DRAW_OBJECT: {
+        auto* glObject = (OpenGLObject*)command.draw.handle;
+
+        if (command.draw.useShadowLod) {
+          glObject->renderShadowLod();
+        } else {
+          glObject->render();
+        }
+
+        break;
+      }
+      case RenderCommandType::DRAW_INSTANCES:
+        ((OpenGLObject*)command.draw.handle)->renderInstances(
+          commandList.getInstanceMatrices(command),
+          commandList.getInstanceColors(command),
+          commandList.getInstanceObjectIds(command),
+          command.draw.totalInstances,
+          command.draw.useShadowLod
+        );
+
+        break;
+    }
+  }
+
+  std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+
+  PerformanceProfiler::trackCommandReplayTime(duration.count());
+}
+
+/**
+ * Per-draw constants are shared between programs, so they only need
+ * to be re-uploaded when they actually change.
+ */
+void OpenGLVideoController::updateDrawConstants(int cascadeLimit) {
+  if (cascadeLimit != drawConstants.cascadeLimit) {
+    drawConstants.cascadeLimit = cascadeLimit;
+
+    drawConstantsBuffer->update(&drawConstants);
+  }
+}
+
+/**
+ * Uploads the constants shared by every program over the frame. The
+ * matrices are stored transposed for OpenGL, so the inverse view-
+ * projection matrix is built from their row-major forms.
+ */
+void OpenGLVideoController::updateFrameConstants(const Matrix4& projectionMatrix, const Matrix4& viewMatrix) {
+  FrameConstants constants;
+  Matrix4 inverseViewProjectionMatrix = (projectionMatrix.transpose() * viewMatrix.transpose()).inverse().transpose();
+  const Vec3f& cameraPosition = frameCamera.position;
+
+  memcpy(constants.projectionMatrix, projectionMatrix.m, sizeof(constants.projectionMatrix));
+  memcpy(constants.viewMatrix, viewMatrix.m, sizeof(constants.viewMatrix));
+  memcpy(constants.inverseViewProjectionMatrix, inverseViewProjectionMatrix.m, sizeof(constants.inverseViewProjectionMatrix));
+
+  constants.cameraPosition[0] = cameraPosition.x;
+  constants.cameraPosition[1] = cameraPosition.y;
+  constants.cameraPosition[2] = cameraPosition.z;
+  constants.time = frameRunningTime;
+
+  frameConstantsBuffer->update(&constants);
+  frameConstantsBuffer->bind();
+}
+
+void OpenGLVideoController::writeToSceneBuffer() {
+  glRenderGraph->startWriting(sceneBuffer);
 }
\ No newline at end of file
@@ -2,21 +2,29 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include "SDL.h"
 #include "subsystem/AbstractVideoController.h"
 #include "opengl/ShaderProgram.h"
+#include "opengl/ShaderProgramVariants.h"
+#include "opengl/OpenGLFrameFences.h"
 #include "opengl/OpenGLObject.h"
+#include "opengl/OpenGLOffscreenContext.h"
 #include "opengl/OpenGLShadowCaster.h"
 #include "opengl/FrameBuffer.h"
 #include "opengl/OpenGLPostShaderPipeline.h"
 #include "opengl/OpenGLPreShader.h"
+#include "opengl/OpenGLRenderGraph.h"
+#include "opengl/OpenGLRenderQueue.h"
+#include "opengl/OpenGLUniformBuffer.h"
 #include "opengl/GBuffer.h"
 #include "subsystem/Geometry.h"
 #include "subsystem/entities/Entity.h"
 #include "subsystem/entities/Object.h"
 #include "subsystem/entities/Light.h"
-#include "subsystem/HeapList.h"
+#include "subsystem/SlotMap.h"
+#include "subsystem/RenderCommandList.h"
 #include "glut.h"
 
 class OpenGLVideoController final : public AbstractVideoController {
@@ -27,28 +35,51 @@ public:
 
   void onDestroy() override;
   void onInit(SDL_Window* sdlWindow) override;
+  void onKeyDown(SDL_Keycode code) override;
+  void onPrepareFrame() override;
   void onRender(SDL_Window* sdlWindow) override;
   void onSceneChange(AbstractScene* scene) override;
   void onScreenSizeChange() override;
 
 private:
-  SDL_GLContext glContext;
+  SDL_GLContext glContext = nullptr;
+  OpenGLOffscreenContext* offscreenContext = nullptr;
   GBuffer* gBuffer = nullptr;
   OpenGLIlluminator* glIlluminator = nullptr;
   OpenGLPostShaderPipeline* glPostShaderPipeline = nullptr;
-  HeapList<OpenGLPreShader> glPreShaders;
-  HeapList<OpenGLObject> glObjects;
-  HeapList<OpenGLShadowCaster> glShadowCasters;
+  OpenGLRenderGraph* glRenderGraph = nullptr;
+  OpenGLUniformBuffer* frameConstantsBuffer = nullptr;
+  OpenGLUniformBuffer* drawConstantsBuffer = nullptr;
+  OpenGLFrameFences* frameFences = nullptr;
+  DrawConstants drawConstants = {};
+  OpenGLRenderQueue geometryQueue;
+  RenderCommandList geometryCommands;
+  OpenGLRenderGraph::Resource sceneBuffer;
+  SlotMap<OpenGLPreShader> glPreShaders;
+  SlotMap<OpenGLObject> glObjects;
+  SlotMap<OpenGLShadowCaster> glShadowCasters;
+  std::unordered_map<const Entity*, SlotHandle> glEntityHandles;
+  ShaderProgram resolveProgram;
+  Camera frameCamera;
+  float frameRunningTime = 0.0f;
+  bool hasGpuMemoryInfo = false;
 
   void createPostShaders();
   void createPreShaders();
+  Matrix4 createProjectionMatrix();
+  void createRenderGraph();
   Matrix4 createViewMatrix();
   void onEntityAdded(Entity* entity);
   void onEntityRemoved(Entity* entity);
-  void renderEmissiveSurfaces();
+  void recordCommandLists();
+  void recordGeometry();
   void renderGeometry();
-  void renderPreShaders();
+  void renderResolve();
   void renderShadowCasters();
-  void setObjectEffects(ShaderProgram& program, OpenGLObject* glObject);
+  void replay(const RenderCommandList& commandList);
+  void setGBufferUniforms(ShaderProgram& program);
   void trackMemoryUsage();
+  void updateDrawConstants(int cascadeLimit);
+  void updateFrameConstants(const Matrix4& projectionMatrix, const Matrix4& viewMatrix);
+  void writeToSceneBuffer();
 };
\ No newline at end of file
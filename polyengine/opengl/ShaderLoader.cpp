@@ -8,11 +8,11 @@
 
 const std::string SHADER_DIRECTORY = "shaders/";
 const std::string INCLUDE_DIRECTIVE = "#include <";
+const std::string STAGES_DIRECTIVE = "#pragma stages";
 
-GLuint ShaderLoader::load(GLenum shaderType, const char* path) {
+static GLuint compile(GLenum shaderType, std::string source, const char* path) {
   GLuint shader = glCreateShader(shaderType);
 
-  std::string source = FileLoader::load(path);
   std::map<std::string, bool> includeMap;
   std::size_t includeStart;
 
@@ -55,10 +55,74 @@ GLuint ShaderLoader::load(GLenum shaderType, const char* path) {
   return shader;
 }
 
+GLuint ShaderLoader::load(GLenum shaderType, const char* path) {
+  return compile(shaderType, FileLoader::load(path), path);
+}
+
+/**
+ * Loads a shader with a list of #defines injected after its #version
+ * directive, allowing features to be toggled at compile time.
+ */
+GLuint ShaderLoader::load(GLenum shaderType, const char* path, const std::vector<std::string>& defines) {
+  std::string source = FileLoader::load(path);
+  std::string defineDirectives;
+  std::size_t versionEnd = source.find("\n") + 1;
+
+  for (auto& define : defines) {
+    defineDirectives += "#define " + define + "\n";
+  }
+
+  source.insert(versionEnd, defineDirectives);
+
+  return compile(shaderType, source, path);
+}
+
+GLuint ShaderLoader::loadComputeShader(const char* path) {
+  return load(GL_COMPUTE_SHADER, path);
+}
+
 GLuint ShaderLoader::loadFragmentShader(const char* path) {
   return load(GL_FRAGMENT_SHADER, path);
 }
 
+/**
+ * Loads a fragment shader with a sequence of stage snippets fused
+ * into it at its #pragma stages directive. Each snippet defines a
+ * function named STAGE, and can call PREVIOUS_STAGE to apply the
+ * stages before it. The first stage's PREVIOUS_STAGE is the shader's
+ * own STAGE_SOURCE, and the shader applies FINAL_STAGE to compute
+ * the combined result of every stage.
+ */
+GLuint ShaderLoader::loadFragmentShader(const char* path, const std::vector<std::string>& stagePaths) {
+  std::string source = FileLoader::load(path);
+  std::string stages;
+  std::string previousStage = "STAGE_SOURCE";
+
+  for (unsigned int i = 0; i < stagePaths.size(); i++) {
+    std::string stage = "stage" + std::to_string(i);
+
+    stages += "#define STAGE " + stage + "\n";
+    stages += "#define PREVIOUS_STAGE " + previousStage + "\n";
+    stages += INCLUDE_DIRECTIVE + stagePaths[i] + ">\n";
+    stages += "#undef STAGE\n";
+    stages += "#undef PREVIOUS_STAGE\n\n";
+
+    previousStage = stage;
+  }
+
+  stages += "#define FINAL_STAGE " + previousStage;
+
+  std::size_t stagesStart = source.find(STAGES_DIRECTIVE);
+
+  if (stagesStart != std::string::npos) {
+    source.replace(stagesStart, STAGES_DIRECTIVE.length(), stages);
+  } else {
+    printf("[ShaderLoader] Missing %s directive in shader: %s\n", STAGES_DIRECTIVE.c_str(), path);
+  }
+
+  return compile(GL_FRAGMENT_SHADER, source, path);
+}
+
 GLuint ShaderLoader::loadGeometryShader(const char* path) {
   return load(GL_GEOMETRY_SHADER, path);
 }
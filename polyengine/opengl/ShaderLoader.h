@@ -1,10 +1,16 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "glut.h"
 
 namespace ShaderLoader {
   GLuint load(GLenum shaderType, const char* path);
+  GLuint load(GLenum shaderType, const char* path, const std::vector<std::string>& defines);
+  GLuint loadComputeShader(const char* path);
   GLuint loadFragmentShader(const char* path);
+  GLuint loadFragmentShader(const char* path, const std::vector<std::string>& stagePaths);
   GLuint loadGeometryShader(const char* path);
   GLuint loadVertexShader(const char* path);
 };
\ No newline at end of file
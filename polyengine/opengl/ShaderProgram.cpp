@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <string>
 
 #include "glew.h"
@@ -5,55 +6,155 @@
 #include "opengl/ShaderProgram.h"
 #include "opengl/ShaderLoader.h"
 #include "opengl/OpenGLDebugger.h"
+#include "opengl/OpenGLState.h"
+#include "opengl/OpenGLUniformBuffer.h"
+#include "subsystem/PerformanceProfiler.h"
+
+/**
+ * Hashes uniform names with 32-bit FNV-1a, so uniform locations can
+ * be looked up without allocating strings for each call.
+ */
+static unsigned int getNameHash(const char* name) {
+  unsigned int hash = 2166136261U;
+
+  while (*name != '\0') {
+    hash ^= (unsigned char)*name++;
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
 
 ShaderProgram::~ShaderProgram() {
-  glDeleteProgram(program);
+  OpenGLState::deleteProgram(program);
 }
 
 void ShaderProgram::attachShader(GLuint shader) {
   glAttachShader(program, shader);
 }
 
+/**
+ * Assigns any shared uniform blocks used by the program to their
+ * fixed binding points, as uniform block bindings can't be declared
+ * in GLSL 3.30 shaders.
+ */
+void ShaderProgram::bindUniformBlocks() {
+  GLint totalBlocks = 0;
+  char name[64];
+
+  glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &totalBlocks);
+
+  for (GLint i = 0; i < totalBlocks; i++) {
+    glGetActiveUniformBlockName(program, i, sizeof(name), 0, name);
+
+    GLint binding = OpenGLUniformBuffer::getBlockBinding(name);
+
+    if (binding >= 0) {
+      glUniformBlockBinding(program, i, binding);
+    }
+  }
+}
+
+/**
+ * Reflects the program's active uniforms after linking, caching each
+ * of their locations by name hash. Arrays are cached per element, so
+ * e.g. "lights[2]" can be set directly.
+ */
+void ShaderProgram::cacheUniformLocations() {
+  GLint totalUniforms = 0;
+  char name[128];
+
+  uniformLocations.clear();
+
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &totalUniforms);
+
+  for (GLint i = 0; i < totalUniforms; i++) {
+    GLint size;
+    GLenum type;
+
+    glGetActiveUniform(program, i, sizeof(name), 0, &size, &type, name);
+
+    GLint location = glGetUniformLocation(program, name);
+
+    // Uniforms within blocks have no location
+    if (location == -1) {
+      continue;
+    }
+
+    std::string uniformName = name;
+    std::size_t arrayStart = uniformName.find("[0]");
+
+    if (arrayStart != std::string::npos) {
+      std::string baseName = uniformName.substr(0, arrayStart);
+
+      uniformLocations[getNameHash(baseName.c_str())] = location;
+
+      for (GLint e = 0; e < size; e++) {
+        std::string elementName = baseName + "[" + std::to_string(e) + "]" + uniformName.substr(arrayStart + 3);
+
+        uniformLocations[getNameHash(elementName.c_str())] = glGetUniformLocation(program, elementName.c_str());
+      }
+    } else {
+      uniformLocations[getNameHash(name)] = location;
+    }
+  }
+}
+
 void ShaderProgram::create() {
   program = glCreateProgram();
 }
 
 GLint ShaderProgram::getUniformLocation(const char* name) const {
-  return glGetUniformLocation(program, name);
+  auto entry = uniformLocations.find(getNameHash(name));
+
+  return entry != uniformLocations.end() ? entry->second : -1;
 }
 
-GLint ShaderProgram::getUniformLocation(std::string name) const {
-  return glGetUniformLocation(program, name.c_str());
+GLint ShaderProgram::getUniformLocation(const std::string& name) const {
+  return getUniformLocation(name.c_str());
 }
 
 void ShaderProgram::link() {
   glLinkProgram(program);
+
+  bindUniformBlocks();
+  cacheUniformLocations();
 }
 
-void ShaderProgram::setBool(std::string name, bool value) const {
+void ShaderProgram::setBool(const char* name, bool value) const {
   setInt(name, value);
 }
 
-void ShaderProgram::setFloat(std::string name, float value) const {
+void ShaderProgram::setFloat(const char* name, float value) const {
   glUniform1f(getUniformLocation(name), value);
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::UNIFORM_SETS);
 }
 
-void ShaderProgram::setInt(std::string name, int value) const {
+void ShaderProgram::setInt(const char* name, int value) const {
   glUniform1i(getUniformLocation(name), value);
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::UNIFORM_SETS);
 }
 
-void ShaderProgram::setMatrix4(std::string name, const Matrix4& value) const {
+void ShaderProgram::setMatrix4(const char* name, const Matrix4& value) const {
   glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, value.m);
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::UNIFORM_SETS);
 }
 
-void ShaderProgram::setVec2f(std::string name, const Vec2f& value) const {
+void ShaderProgram::setVec2f(const char* name, const Vec2f& value) const {
   glUniform2fv(getUniformLocation(name), 1, value.float2());
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::UNIFORM_SETS);
 }
 
-void ShaderProgram::setVec3f(std::string name, const Vec3f& value) const {
+void ShaderProgram::setVec3f(const char* name, const Vec3f& value) const {
   glUniform3fv(getUniformLocation(name), 1, value.float3());
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::UNIFORM_SETS);
 }
 
 void ShaderProgram::use() const {
-  glUseProgram(program);
+  OpenGLState::useProgram(program);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 #include "glew.h"
 #include "glut.h"
@@ -14,16 +15,20 @@ public:
   void attachShader(GLuint shader);
   void create();
   GLint getUniformLocation(const char* name) const;
-  GLint getUniformLocation(std::string name) const;
+  GLint getUniformLocation(const std::string& name) const;
   void link();
-  void setBool(std::string name, bool value) const;
-  void setFloat(std::string name, float value) const;
-  void setInt(std::string name, int value) const;
-  void setMatrix4(std::string name, const Matrix4& value) const;
-  void setVec2f(std::string name, const Vec2f& value) const;
-  void setVec3f(std::string name, const Vec3f& value) const;
+  void setBool(const char* name, bool value) const;
+  void setFloat(const char* name, float value) const;
+  void setInt(const char* name, int value) const;
+  void setMatrix4(const char* name, const Matrix4& value) const;
+  void setVec2f(const char* name, const Vec2f& value) const;
+  void setVec3f(const char* name, const Vec3f& value) const;
   void use() const;
 
 private:
   GLuint program = -1;
+  std::unordered_map<unsigned int, GLint> uniformLocations;
+
+  void bindUniformBlocks();
+  void cacheUniformLocations();
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include <cstdio>
+
+#include "glew.h"
+#include "glut.h"
+#include "opengl/ShaderProgramVariants.h"
+#include "opengl/ShaderLoader.h"
+
+ShaderProgramVariants::~ShaderProgramVariants() {
+  for (auto& [ flags, program ] : variantMap) {
+    delete program;
+  }
+
+  variantMap.clear();
+}
+
+void ShaderProgramVariants::addDefine(unsigned int flag, std::string define) {
+  defineMap[flag] = define;
+  definedFlags |= flag;
+}
+
+ShaderProgram* ShaderProgramVariants::createVariant(unsigned int flags) {
+  std::vector<std::string> defines;
+  auto* program = new ShaderProgram();
+
+  for (auto& [ flag, define ] : defineMap) {
+    if (flags & flag) {
+      defines.push_back(define);
+    }
+  }
+
+  program->create();
+  program->attachShader(ShaderLoader::load(GL_VERTEX_SHADER, vertexShaderPath, defines));
+
+  if (geometryShaderPath != nullptr) {
+    program->attachShader(ShaderLoader::load(GL_GEOMETRY_SHADER, geometryShaderPath, defines));
+  }
+
+  program->attachShader(ShaderLoader::load(GL_FRAGMENT_SHADER, fragmentShaderPath, defines));
+  program->link();
+
+  printf("[ShaderProgramVariants] Compiled variant %u of %s\n", flags, vertexShaderPath);
+
+  return program;
+}
+
+/**
+ * Returns the variant of the program for the given flags, compiling
+ * it on first use. Flags without a registered #define don't affect
+ * the program, and are ignored so they share a cached variant.
+ */
+ShaderProgram& ShaderProgramVariants::getVariant(unsigned int flags) {
+  flags &= definedFlags;
+
+  auto entry = variantMap.find(flags);
+
+  if (entry != variantMap.end()) {
+    return *entry->second;
+  }
+
+  auto* program = createVariant(flags);
+
+  variantMap.emplace(flags, program);
+
+  return *program;
+}
+
+/**
+ * Returns the flags which actually distinguish the variant used for
+ * the given flags, e.g. to group objects sharing a variant.
+ */
+unsigned int ShaderProgramVariants::getVariantFlags(unsigned int flags) const {
+  return flags & definedFlags;
+}
+
+unsigned int ShaderProgramVariants::getTotalVariants() const {
+  return variantMap.size();
+}
+
+void ShaderProgramVariants::setFragmentShader(const char* path) {
+  fragmentShaderPath = path;
+}
+
+void ShaderProgramVariants::setGeometryShader(const char* path) {
+  geometryShaderPath = path;
+}
+
+void ShaderProgramVariants::setVertexShader(const char* path) {
+  vertexShaderPath = path;
+}
\ No newline at end of file
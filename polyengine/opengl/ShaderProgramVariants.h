@@ -0,0 +1,36 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "opengl/ShaderProgram.h"
+
+/**
+ * Lazily compiles and caches permutations of a shader program. Each
+ * variant is keyed by a bitmask of flags, and every registered flag
+ * set in the mask injects a #define into the program's shaders, so
+ * features a variant doesn't use are compiled out entirely.
+ */
+class ShaderProgramVariants {
+public:
+  ~ShaderProgramVariants();
+
+  void addDefine(unsigned int flag, std::string define);
+  ShaderProgram& getVariant(unsigned int flags);
+  unsigned int getVariantFlags(unsigned int flags) const;
+  unsigned int getTotalVariants() const;
+  void setFragmentShader(const char* path);
+  void setGeometryShader(const char* path);
+  void setVertexShader(const char* path);
+
+private:
+  const char* vertexShaderPath = nullptr;
+  const char* geometryShaderPath = nullptr;
+  const char* fragmentShaderPath = nullptr;
+  unsigned int definedFlags = 0;
+  std::map<unsigned int, std::string> defineMap;
+  std::map<unsigned int, ShaderProgram*> variantMap;
+
+  ShaderProgram* createVariant(unsigned int flags);
+};
\ No newline at end of file
@@ -5,6 +5,4 @@
 class AntiAliasingShader : public AbstractOpenGLPostShader {
 public:
   void onInit() override;
-  void onConfigureFrameBuffer() override;
-  void onRender() override;
 };
\ No newline at end of file
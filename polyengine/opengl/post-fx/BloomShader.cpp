@@ -1,70 +1,82 @@
 #include "opengl/post-fx/BloomShader.h"
 #include "opengl/OpenGLScreenQuad.h"
 
-BloomShader::~BloomShader() {
-  delete downsample1;
-  delete downsample2;
-  delete downsample3_h;
-  delete downsample3_v;
+bool BloomShader::hasIntermediatePasses() const {
+  return true;
+}
+
+/**
+ * Bloom is separated, downsampled, blurred and upsampled through
+ * targets sized relative to the window. Since these are transient,
+ * the render graph is free to alias the downsampled and blurred
+ * targets onto one another wherever their lifetimes don't overlap.
+ * The final combine is a stage, so any stages after it can be fused
+ * into the same pass.
+ */
+void BloomShader::onCreatePasses(OpenGLRenderGraph& graph, OpenGLRenderGraph::Resource input, OpenGLRenderGraph::Resource output) {
+  auto half = graph.createTexture("bloom-half", { GL_RGB32F, GL_RGB, 0.5f });
+  auto quarter = graph.createTexture("bloom-quarter", { GL_RGB32F, GL_RGB, 0.25f });
+  auto eighth = graph.createTexture("bloom-eighth", { GL_RGB32F, GL_RGB, 0.125f });
+  auto eighthBlurred = graph.createTexture("bloom-eighth-blurred", { GL_RGB32F, GL_RGB, 0.125f });
+  auto quarterBlurred = graph.createTexture("bloom-quarter-blurred", { GL_RGB32F, GL_RGB, 0.25f });
+  auto halfBlurred = graph.createTexture("bloom-half-blurred", { GL_RGB32F, GL_RGB, 0.5f });
+
+  graph.addPass("bloom-color-separation", { input }, half, [=, &graph]() {
+    getShaderProgram("color-separation")->use();
+    getShaderProgram("color-separation")->setInt("colorDepthIn", 0);
+
+    graph.startReading(input, GL_TEXTURE0);
+    graph.startWriting(half);
+    OpenGLScreenQuad::draw();
+  });
+
+  graph.addPass("bloom-downsample", { half }, quarter, [=, &graph]() {
+    graph.blit(half, quarter);
+  });
+
+  graph.addPass("bloom-downsample", { quarter }, eighth, [=, &graph]() {
+    graph.blit(quarter, eighth);
+  });
+
+  graph.addPass("bloom-blur-horizontal", { eighth }, eighthBlurred, [=, &graph]() {
+    getShaderProgram("blur")->use();
+    getShaderProgram("blur")->setInt("colorIn", 0);
+    getShaderProgram("blur")->setVec2f("direction", Vec2f(1.0f, 0.0f));
+
+    graph.startReading(eighth, GL_TEXTURE0);
+    graph.startWriting(eighthBlurred);
+    OpenGLScreenQuad::draw();
+  });
+
+  graph.addPass("bloom-blur-vertical", { eighthBlurred }, quarterBlurred, [=, &graph]() {
+    getShaderProgram("blur")->use();
+    getShaderProgram("blur")->setInt("colorIn", 0);
+    getShaderProgram("blur")->setVec2f("direction", Vec2f(0.0f, 1.0f));
+
+    graph.startReading(eighthBlurred, GL_TEXTURE0);
+    graph.startWriting(quarterBlurred);
+    OpenGLScreenQuad::draw();
+  });
+
+  graph.addPass("bloom-upsample", { quarterBlurred }, halfBlurred, [=, &graph]() {
+    graph.blit(quarterBlurred, halfBlurred);
+  });
+
+  glRenderGraph = &graph;
+  bloomColor = halfBlurred;
+
+  addStagePass(graph, { input, halfBlurred }, input, output);
 }
 
 void BloomShader::onInit() {
   addShaderProgram("color-separation", "./shaders/post-fx/bloom-color-separation.fragment.glsl");
   addShaderProgram("blur", "./shaders/post-fx/bloom-blur.fragment.glsl");
-  addShaderProgram("combine", "./shaders/post-fx/bloom-combine.fragment.glsl");
-
-  downsample1 = new FrameBuffer(960, 540);
-  downsample2 = new FrameBuffer(480, 270);
-  downsample3_h = new FrameBuffer(240, 135);
-  downsample3_v = new FrameBuffer(240, 135);
-
-  downsample1->addColorTexture(GL_RGB32F, GL_RGB, GL_CLAMP_TO_EDGE, GL_TEXTURE1);
-  downsample2->addColorTexture(GL_RGB32F, GL_RGB, GL_CLAMP_TO_EDGE, GL_TEXTURE0);
-  downsample3_h->addColorTexture(GL_RGB32F, GL_RGB, GL_CLAMP_TO_EDGE, GL_TEXTURE0);
-  downsample3_v->addColorTexture(GL_RGB32F, GL_RGB, GL_CLAMP_TO_EDGE, GL_TEXTURE0);
-
-  downsample1->bindColorTextures();
-  downsample2->bindColorTextures();
-  downsample3_h->bindColorTextures();
-  downsample3_v->bindColorTextures();
-}
 
-void BloomShader::onConfigureFrameBuffer() {
-  frameBuffer->addColorTexture(GL_RGBA32F, GL_RGBA, GL_CLAMP_TO_EDGE);
+  setStage("post-fx/stages/bloom-combine.glsl", 1);
 }
 
-void BloomShader::onRender() {
-  getShaderProgram("color-separation")->use();
-  getShaderProgram("color-separation")->setInt("colorDepthIn", 0);
-
-  frameBuffer->startReading();
-  downsample1->startWriting();
-  OpenGLScreenQuad::draw();
-
-  downsample1->blit(downsample2);
-  downsample2->blit(downsample3_h);
-
-  getShaderProgram("blur")->use();
-  getShaderProgram("blur")->setInt("colorIn", 0);
-  getShaderProgram("blur")->setVec2f("direction", Vec2f(1.0f, 0.0f));
-
-  downsample3_h->startReading();
-  downsample3_v->startWriting();
-  OpenGLScreenQuad::draw();
-
-  getShaderProgram("blur")->setVec2f("direction", Vec2f(0.0f, 1.0f));
-
-  downsample3_v->startReading();
-  downsample2->startWriting();
-  OpenGLScreenQuad::draw();
-
-  downsample2->blit(downsample1);
-
-  getShaderProgram("combine")->use();
-  getShaderProgram("combine")->setInt("colorDepthIn", 0);
-  getShaderProgram("combine")->setInt("bloomColorIn", 1);
+void BloomShader::onRenderStage(ShaderProgram& program) {
+  program.setInt("bloomColorIn", 1);
 
-  downsample1->startReading();
-  frameBuffer->startReading();
-  writeToOutputBuffer();
+  glRenderGraph->startReading(bloomColor, GL_TEXTURE1);
 }
\ No newline at end of file
@@ -1,19 +1,16 @@
 #pragma once
 
 #include "opengl/AbstractOpenGLPostShader.h"
-#include "opengl/FrameBuffer.h"
+#include "opengl/OpenGLRenderGraph.h"
 
 class BloomShader : public AbstractOpenGLPostShader {
 public:
-  ~BloomShader();
-
-  void onInit();
-  void onConfigureFrameBuffer();
-  void onRender();
+  bool hasIntermediatePasses() const override;
+  void onCreatePasses(OpenGLRenderGraph& graph, OpenGLRenderGraph::Resource input, OpenGLRenderGraph::Resource output) override;
+  void onInit() override;
+  void onRenderStage(ShaderProgram& program) override;
 
 private:
-  FrameBuffer* downsample1 = nullptr;
-  FrameBuffer* downsample2 = nullptr;
-  FrameBuffer* downsample3_h = nullptr;
-  FrameBuffer* downsample3_v = nullptr;
+  OpenGLRenderGraph* glRenderGraph = nullptr;
+  OpenGLRenderGraph::Resource bloomColor;
 };
\ No newline at end of file
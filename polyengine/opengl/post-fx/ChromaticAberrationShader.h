@@ -5,6 +5,4 @@
 class ChromaticAberrationShader : public AbstractOpenGLPostShader {
 public:
   void onInit() override;
-  void onConfigureFrameBuffer() override;
-  void onRender() override;
 };
\ No newline at end of file
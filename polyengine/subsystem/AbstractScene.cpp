@@ -4,6 +4,14 @@
 #include "subsystem/AbstractScene.h"
 #include "subsystem/RNG.h"
 
+void AbstractScene::dispatchEntityEvents() {
+  stage.dispatchEntityEvents();
+}
+
+Camera& AbstractScene::getCamera() {
+  return camera;
+}
+
 const Camera& AbstractScene::getCamera() const {
   return camera;
 }
@@ -26,4 +34,8 @@ void AbstractScene::onEntityRemoved(Callback<Entity*> handler) {
 
 void AbstractScene::onUpdate(float dt) {
   stage.update(dt);
+}
+
+void AbstractScene::setEntityEventsDeferred(bool areEntityEventsDeferred) {
+  stage.setEntityEventsDeferred(areEntityEventsDeferred);
 }
\ No newline at end of file
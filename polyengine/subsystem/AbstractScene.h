@@ -15,12 +15,15 @@ class AbstractScene : public LifeCycle {
 public:
   virtual ~AbstractScene() {};
 
+  void dispatchEntityEvents();
+  Camera& getCamera();
   const Camera& getCamera() const;
   virtual InputSystem& getInputSystem() final;
   virtual const Stage& getStage() const final;
   void onEntityAdded(Callback<Entity*> handler);
   void onEntityRemoved(Callback<Entity*> handler);
   virtual void onUpdate(float dt) override;
+  void setEntityEventsDeferred(bool areEntityEventsDeferred);
 
 protected:
   using super = AbstractScene;
@@ -1,6 +1,10 @@
 #include "SDL.h"
 #include "subsystem/AbstractVideoController.h"
 
+void AbstractVideoController::setPipelined(bool isPipelined) {
+  this->isPipelined = isPipelined;
+}
+
 void AbstractVideoController::setScene(AbstractScene* scene) {
   this->scene = scene;
 
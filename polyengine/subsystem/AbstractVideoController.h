@@ -4,18 +4,29 @@
 #include "subsystem/Math.h"
 #include "subsystem/AbstractScene.h"
 
+/**
+ * Renders frames in two phases. onPrepareFrame copies everything a
+ * frame needs out of the scene, and onRender renders the frame only
+ * from what was copied. When pipelined, the scene is being simulated
+ * for the next frame while onRender runs, so only onPrepareFrame may
+ * read it.
+ */
 class AbstractVideoController {
 public:
   virtual ~AbstractVideoController() {};
 
   virtual void onDestroy() {};
   virtual void onInit(SDL_Window* sdlWindow) = 0;
+  virtual void onKeyDown(SDL_Keycode code) {};
+  virtual void onPrepareFrame() {};
   virtual void onRender(SDL_Window* sdlWindow) = 0;
   virtual void onSceneChange(AbstractScene* scene) = 0;
   virtual void onScreenSizeChange() {};
+  virtual void setPipelined(bool isPipelined) final;
   virtual void setScene(AbstractScene* scene) final;
   virtual void toggleFullScreen(SDL_Window* sdlWindow) final;
 
 protected:
   AbstractScene* scene = nullptr;
+  bool isPipelined = false;
 };
\ No newline at end of file
@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+
+#include "subsystem/Benchmark.h"
+#include "subsystem/PerformanceProfiler.h"
+
+struct BenchmarkSummary {
+  float mean = 0.0f;
+  float p50 = 0.0f;
+  float p95 = 0.0f;
+  float p99 = 0.0f;
+};
+
+/**
+ * Differences smaller than this are treated as noise when comparing
+ * against a baseline, regardless of tolerance, since relative changes
+ * in near-zero timings are meaningless.
+ */
+constexpr static float MINIMUM_REGRESSION = 0.05f;
+
+static Vec3f getCatmullRomPoint(const Vec3f& p0, const Vec3f& p1, const Vec3f& p2, const Vec3f& p3, float t) {
+  float t2 = t * t;
+  float t3 = t2 * t;
+
+  return (
+    p1 * 2.0f +
+    (p2 - p0) * t +
+    (p0 * 2.0f - p1 * 5.0f + p2 * 4.0f - p3) * t2 +
+    (p1 * 3.0f - p0 - p2 * 3.0f + p3) * t3
+  ) * 0.5f;
+}
+
+static BenchmarkSummary summarize(std::vector<float> values) {
+  BenchmarkSummary summary;
+
+  if (values.size() == 0) {
+    return summary;
+  }
+
+  std::sort(values.begin(), values.end());
+
+  auto getPercentile = [&](float percentile) {
+    int index = (int)std::ceil(percentile / 100.0f * values.size()) - 1;
+
+    return values[std::clamp(index, 0, (int)values.size() - 1)];
+  };
+
+  float total = 0.0f;
+
+  for (float value : values) {
+    total += value;
+  }
+
+  summary.mean = total / values.size();
+  summary.p50 = getPercentile(50.0f);
+  summary.p95 = getPercentile(95.0f);
+  summary.p99 = getPercentile(99.0f);
+
+  return summary;
+}
+
+static std::map<std::string, BenchmarkSummary> readSummaries(const char* path) {
+  std::map<std::string, BenchmarkSummary> summaries;
+  std::ifstream file(path);
+  std::string line;
+
+  if (file.fail()) {
+    printf("[Benchmark] Error opening results: %s\n", path);
+  }
+
+  while (std::getline(file, line)) {
+    char name[64];
+    BenchmarkSummary summary;
+
+    if (sscanf(line.c_str(), " \"%63[^\"]\": { \"mean\": %f, \"p50\": %f, \"p95\": %f, \"p99\": %f }", name, &summary.mean, &summary.p50, &summary.p95, &summary.p99) == 5) {
+      summaries.emplace(name, summary);
+    }
+  }
+
+  return summaries;
+}
+
+Benchmark::Benchmark(const char* scriptPath, const char* resultsPath) {
+  this->resultsPath = resultsPath;
+
+  loadScript(scriptPath);
+}
+
+/**
+ * Compares the summary of a benchmark run against a baseline summary,
+ * reporting any metric whose percentiles grew by more than the given
+ * fraction. Returns false if any regressions were found.
+ */
+bool Benchmark::compare(const char* baselinePath, const char* resultsPath, float tolerance) {
+  auto baselineSummaries = readSummaries(baselinePath);
+  auto resultSummaries = readSummaries(resultsPath);
+  bool hasRegressions = false;
+
+  for (auto& [ name, result ] : resultSummaries) {
+    if (baselineSummaries.find(name) == baselineSummaries.end()) {
+      continue;
+    }
+
+    auto& baseline = baselineSummaries.at(name);
+
+    auto isRegression = [&](float baselineValue, float resultValue) {
+      return (
+        resultValue - baselineValue > MINIMUM_REGRESSION &&
+        resultValue > baselineValue * (1.0f + tolerance)
+      );
+    };
+
+    bool isMetricRegression = (
+      isRegression(baseline.p50, result.p50) ||
+      isRegression(baseline.p95, result.p95) ||
+      isRegression(baseline.p99, result.p99)
+    );
+
+    printf(
+      "[Benchmark] %-16s p50 %8.3f -> %8.3f, p95 %8.3f -> %8.3f, p99 %8.3f -> %8.3f%s\n",
+      name.c_str(),
+      baseline.p50, result.p50,
+      baseline.p95, result.p95,
+      baseline.p99, result.p99,
+      isMetricRegression ? "  REGRESSION" : ""
+    );
+
+    hasRegressions = hasRegressions || isMetricRegression;
+  }
+
+  return !hasRegressions;
+}
+
+/**
+ * Replays any scripted input events due by the current frame through
+ * the scene's input system, as if they'd been polled from SDL.
+ */
+void Benchmark::dispatchEvents(AbstractScene* scene) {
+  float time = getCurrentTime();
+
+  while (nextEventIndex < events.size() && events[nextEventIndex].time <= time) {
+    scene->getInputSystem().handleEvent(events[nextEventIndex++].event);
+  }
+}
+
+float Benchmark::getCurrentTime() const {
+  return currentFrame * timeStep;
+}
+
+unsigned int Benchmark::getSeed() const {
+  return seed;
+}
+
+float Benchmark::getTimeStep() const {
+  return timeStep;
+}
+
+/**
+ * Returns the number of frames needed to reach the last camera
+ * keyframe or scripted event, whichever comes later.
+ */
+unsigned int Benchmark::getTotalFrames() const {
+  float duration = 0.0f;
+
+  if (cameraKeyframes.size() > 0) {
+    duration = cameraKeyframes.back().time;
+  }
+
+  if (events.size() > 0) {
+    duration = std::max(duration, events.back().time);
+  }
+
+  return (unsigned int)std::ceil(duration / timeStep) + 1;
+}
+
+void Benchmark::loadScript(const char* scriptPath) {
+  std::ifstream file(scriptPath);
+  std::string line;
+
+  if (file.fail()) {
+    printf("[Benchmark] Error opening script: %s\n", scriptPath);
+
+    return;
+  }
+
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    std::string directive;
+
+    stream >> directive;
+
+    if (directive == "seed") {
+      stream >> seed;
+    } else if (directive == "timestep") {
+      stream >> timeStep;
+    } else if (directive == "camera") {
+      CameraKeyframe keyframe;
+
+      stream >> keyframe.time;
+      stream >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z;
+      stream >> keyframe.orientation.x >> keyframe.orientation.y;
+
+      cameraKeyframes.push_back(keyframe);
+    } else if (directive == "click" || directive == "keydown" || directive == "keyup") {
+      ScriptedEvent scriptedEvent;
+
+      memset(&scriptedEvent.event, 0, sizeof(SDL_Event));
+
+      stream >> scriptedEvent.time;
+
+      if (directive == "click") {
+        scriptedEvent.event.type = SDL_MOUSEBUTTONDOWN;
+        scriptedEvent.event.button.button = SDL_BUTTON_LEFT;
+        scriptedEvent.event.button.state = SDL_PRESSED;
+      } else {
+        std::string keyName;
+
+        stream >> keyName;
+
+        scriptedEvent.event.type = directive == "keydown" ? SDL_KEYDOWN : SDL_KEYUP;
+        scriptedEvent.event.key.keysym.sym = SDL_GetKeyFromName(keyName.c_str());
+      }
+
+      events.push_back(scriptedEvent);
+    }
+  }
+
+  auto byTime = [](auto& a, auto& b) {
+    return a.time < b.time;
+  };
+
+  std::stable_sort(cameraKeyframes.begin(), cameraKeyframes.end(), byTime);
+  std::stable_sort(events.begin(), events.end(), byTime);
+}
+
+/**
+ * Samples the frame's timings, along with the counters collected by
+ * the performance profiler over the frame.
+ */
+void Benchmark::trackFrame(float updateTime, float renderTime) {
+  auto& profile = PerformanceProfiler::getProfile();
+  BenchmarkSample sample;
+
+  sample.frameTime = updateTime + renderTime;
+  sample.updateTime = updateTime;
+  sample.renderTime = renderTime;
+  sample.commandRecordTime = profile.commandRecordTime;
+  sample.commandReplayTime = profile.commandReplayTime;
+  sample.gpuFrameTime = PerformanceProfiler::getGpuPassTime("frame");
+  sample.cascadeRenderTime = PerformanceProfiler::getGpuPassTime("shadow-cascades");
+  sample.totalDrawCalls = profile.totalDrawCalls;
+  sample.totalStateChanges = profile.totalStateChanges;
+  sample.totalObjects = profile.totalObjects;
+  sample.totalPolygons = profile.totalPolygons;
+
+  // Counters are published at the end of each frame, so these
+  // are from the frame before
+  sample.bytesUploaded = profile.counters[ProfiledCounter::BYTES_UPLOADED];
+  sample.heapAllocations = profile.counters[ProfiledCounter::HEAP_ALLOCATIONS];
+
+  samples.push_back(sample);
+
+  currentFrame++;
+}
+
+/**
+ * Moves the camera along a Catmull-Rom spline through the scripted
+ * keyframes, overriding any movement applied by the scene itself.
+ */
+void Benchmark::updateCamera(AbstractScene* scene) {
+  if (cameraKeyframes.size() == 0) {
+    return;
+  }
+
+  float time = getCurrentTime();
+  int last = cameraKeyframes.size() - 1;
+  int index = 0;
+
+  while (index < last && cameraKeyframes[index + 1].time <= time) {
+    index++;
+  }
+
+  auto& camera = scene->getCamera();
+  auto& k0 = cameraKeyframes[std::max(index - 1, 0)];
+  auto& k1 = cameraKeyframes[index];
+  auto& k2 = cameraKeyframes[std::min(index + 1, last)];
+  auto& k3 = cameraKeyframes[std::min(index + 2, last)];
+  float span = k2.time - k1.time;
+  float t = span > 0.0f ? std::clamp((time - k1.time) / span, 0.0f, 1.0f) : 0.0f;
+
+  camera.position = getCatmullRomPoint(k0.position, k1.position, k2.position, k3.position, t);
+  camera.orientation = getCatmullRomPoint(k0.orientation, k1.orientation, k2.orientation, k3.orientation, t);
+}
+
+/**
+ * Writes every frame sample to <results path>.csv, and a summary of
+ * each metric to <results path>.json.
+ */
+void Benchmark::writeResults() const {
+  std::ofstream csv(resultsPath + ".csv");
+
+  csv << "frame,frame_ms,update_ms,render_ms,record_ms,replay_ms,gpu_ms,cascade_gpu_ms,draw_calls,state_changes,objects,polygons,bytes_uploaded,heap_allocations\n";
+
+  for (unsigned int i = 0; i < samples.size(); i++) {
+    auto& sample = samples[i];
+
+    csv
+      << i << ","
+      << sample.frameTime << ","
+      << sample.updateTime << ","
+      << sample.renderTime << ","
+      << sample.commandRecordTime << ","
+      << sample.commandReplayTime << ","
+      << sample.gpuFrameTime << ","
+      << sample.cascadeRenderTime << ","
+      << sample.totalDrawCalls << ","
+      << sample.totalStateChanges << ","
+      << sample.totalObjects << ","
+      << sample.totalPolygons << ","
+      << sample.bytesUploaded << ","
+      << sample.heapAllocations << "\n";
+  }
+
+  std::vector<std::pair<const char*, std::function<float(const BenchmarkSample&)>>> metrics = {
+    { "frame_ms", [](auto& sample) { return sample.frameTime; } },
+    { "update_ms", [](auto& sample) { return sample.updateTime; } },
+    { "render_ms", [](auto& sample) { return sample.renderTime; } },
+    { "record_ms", [](auto& sample) { return sample.commandRecordTime; } },
+    { "replay_ms", [](auto& sample) { return sample.commandReplayTime; } },
+    { "gpu_ms", [](auto& sample) { return sample.gpuFrameTime; } },
+    { "cascade_gpu_ms", [](auto& sample) { return sample.cascadeRenderTime; } },
+    { "draw_calls", [](auto& sample) { return (float)sample.totalDrawCalls; } },
+    { "state_changes", [](auto& sample) { return (float)sample.totalStateChanges; } },
+    { "bytes_uploaded", [](auto& sample) { return (float)sample.bytesUploaded; } },
+    { "heap_allocations", [](auto& sample) { return (float)sample.heapAllocations; } }
+  };
+
+  std::ofstream json(resultsPath + ".json");
+  char line[256];
+
+  json << "{\n";
+  json << "  \"frames\": " << samples.size() << ",\n";
+  json << "  \"seed\": " << seed << ",\n";
+  json << "  \"timestep\": " << timeStep << ",\n";
+  json << "  \"metrics\": {\n";
+
+  for (unsigned int i = 0; i < metrics.size(); i++) {
+    auto& [ name, getValue ] = metrics[i];
+    std::vector<float> values;
+
+    for (auto& sample : samples) {
+      values.push_back(getValue(sample));
+    }
+
+    auto summary = summarize(values);
+
+    snprintf(
+      line,
+      sizeof(line),
+      "    \"%s\": { \"mean\": %f, \"p50\": %f, \"p95\": %f, \"p99\": %f }%s\n",
+      name, summary.mean, summary.p50, summary.p95, summary.p99,
+      i < metrics.size() - 1 ? "," : ""
+    );
+
+    json << line;
+  }
+
+  json << "  }\n}\n";
+
+  printf("[Benchmark] Wrote %u frames to %s.csv/.json\n", (unsigned int)samples.size(), resultsPath.c_str());
+}
\ No newline at end of file
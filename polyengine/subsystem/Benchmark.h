@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+#include "subsystem/AbstractScene.h"
+#include "subsystem/Math.h"
+
+/**
+ * Timings and counters recorded for a single benchmark frame.
+ */
+struct BenchmarkSample {
+  float frameTime = 0.0f;
+  float updateTime = 0.0f;
+  float renderTime = 0.0f;
+  float commandRecordTime = 0.0f;
+  float commandReplayTime = 0.0f;
+  float gpuFrameTime = 0.0f;
+  float cascadeRenderTime = 0.0f;
+  unsigned int totalDrawCalls = 0;
+  unsigned int totalStateChanges = 0;
+  unsigned int totalObjects = 0;
+  unsigned int totalPolygons = 0;
+  unsigned int bytesUploaded = 0;
+  unsigned int heapAllocations = 0;
+};
+
+/**
+ * Runs a scene deterministically from a benchmark script: randomness
+ * is seeded with a fixed value, frames advance by a fixed time step,
+ * the camera follows a spline through scripted keyframes, and input
+ * events are replayed at scripted times. Scripts are plain text, with
+ * one directive per line:
+ *
+ *   seed <value>
+ *   timestep <seconds>
+ *   camera <time> <x> <y> <z> <pitch> <yaw>
+ *   click <time>
+ *   keydown <time> <key name>
+ *   keyup <time> <key name>
+ *
+ * Per-frame samples are written out as CSV, along with a JSON summary
+ * of frame time percentiles which later runs can be compared against.
+ */
+class Benchmark {
+public:
+  Benchmark(const char* scriptPath, const char* resultsPath);
+
+  static bool compare(const char* baselinePath, const char* resultsPath, float tolerance);
+
+  void dispatchEvents(AbstractScene* scene);
+  unsigned int getSeed() const;
+  float getTimeStep() const;
+  unsigned int getTotalFrames() const;
+  void trackFrame(float updateTime, float renderTime);
+  void updateCamera(AbstractScene* scene);
+  void writeResults() const;
+
+private:
+  struct CameraKeyframe {
+    float time;
+    Vec3f position;
+    Vec3f orientation;
+  };
+
+  struct ScriptedEvent {
+    float time;
+    SDL_Event event;
+  };
+
+  std::string resultsPath;
+  unsigned int seed = 0;
+  float timeStep = 1.0f / 60.0f;
+  unsigned int currentFrame = 0;
+  unsigned int nextEventIndex = 0;
+  std::vector<CameraKeyframe> cameraKeyframes;
+  std::vector<ScriptedEvent> events;
+  std::vector<BenchmarkSample> samples;
+
+  float getCurrentTime() const;
+  void loadScript(const char* scriptPath);
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <cmath>
+#include <thread>
+
+#include "subsystem/FramePacer.h"
+#include "subsystem/ZoneProfiler.h"
+
+FramePacer::FramePacer() {
+  startTime = Clock::now();
+  lastFrameStart = startTime;
+  nextFrameDeadline = startTime;
+}
+
+/**
+ * Starts a new frame, returning the time in seconds since the
+ * previous one started.
+ */
+float FramePacer::beginFrame() {
+  auto now = Clock::now();
+  std::chrono::duration<float> dt = now - lastFrameStart;
+
+  lastFrameStart = now;
+
+  return dt.count();
+}
+
+/**
+ * Returns the time in milliseconds since the pacer was created.
+ */
+float FramePacer::getElapsedTime() {
+  std::chrono::duration<float, std::milli> elapsed = Clock::now() - startTime;
+
+  return elapsed.count();
+}
+
+/**
+ * Sets the frame rate to hold frames to, or removes any limit if 0.
+ */
+void FramePacer::setTargetFrameRate(unsigned int framesPerSecond) {
+  if (framesPerSecond == 0) {
+    targetFrameDuration = Clock::duration::zero();
+  } else {
+    targetFrameDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+  }
+
+  nextFrameDeadline = Clock::now();
+}
+
+/**
+ * Sleeps in short intervals while the remaining time comfortably
+ * exceeds how long a sleep is expected to take, then spins. The
+ * expected sleep time is learned from past sleeps, as the mean plus
+ * one standard deviation, so it adapts to the scheduler's actual
+ * granularity.
+ */
+void FramePacer::sleepUntil(Clock::time_point deadline) {
+  while (true) {
+    std::chrono::duration<double> remaining = deadline - Clock::now();
+
+    if (remaining.count() <= sleepEstimate) {
+      break;
+    }
+
+    auto sleepStart = Clock::now();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::chrono::duration<double> slept = Clock::now() - sleepStart;
+
+    // Welford's running mean and variance
+    double delta = slept.count() - sleepMean;
+
+    totalSleeps++;
+    sleepMean += delta / totalSleeps;
+    sleepVariance += delta * (slept.count() - sleepMean);
+    sleepEstimate = sleepMean + std::sqrt(sleepVariance / (totalSleeps - 1));
+  }
+
+  while (Clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * Waits until the next frame is due at the target frame rate. If a
+ * frame overran by more than a whole frame, the schedule is reset
+ * rather than rushing subsequent frames to catch up.
+ */
+void FramePacer::waitForNextFrame() {
+  if (targetFrameDuration == Clock::duration::zero()) {
+    return;
+  }
+
+  PROFILE_ZONE("FramePacer::waitForNextFrame");
+
+  auto now = Clock::now();
+
+  nextFrameDeadline += targetFrameDuration;
+
+  if (now > nextFrameDeadline + targetFrameDuration) {
+    nextFrameDeadline = now;
+
+    return;
+  }
+
+  sleepUntil(nextFrameDeadline);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+
+/**
+ * Measures frame times with a high-resolution clock, and optionally
+ * holds frames to a target frame rate. Waiting sleeps for as long as
+ * the OS scheduler can be trusted to wake up on time, then spins for
+ * the remainder, so frames are paced to well under a millisecond
+ * without burning a core for the whole wait.
+ */
+class FramePacer {
+public:
+  FramePacer();
+
+  float beginFrame();
+  float getElapsedTime();
+  void setTargetFrameRate(unsigned int framesPerSecond);
+  void waitForNextFrame();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point startTime;
+  Clock::time_point lastFrameStart;
+  Clock::time_point nextFrameDeadline;
+  Clock::duration targetFrameDuration = Clock::duration::zero();
+  double sleepEstimate = 0.005;
+  double sleepMean = 0.005;
+  double sleepVariance = 0.0;
+  unsigned int totalSleeps = 1;
+
+  void sleepUntil(Clock::time_point deadline);
+};
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename Signature, unsigned int CAPACITY = 48>
+class InlineFunction;
+
+/**
+ * A callable wrapper like std::function, which stores its callable in
+ * a fixed buffer within itself rather than on the heap, so creating,
+ * copying and destroying one never allocates. Callables too large for
+ * the buffer fail to compile, and should capture by reference or be
+ * given a larger capacity instead.
+ */
+template<typename R, typename... A, unsigned int CAPACITY>
+class InlineFunction<R(A...), CAPACITY> {
+public:
+  InlineFunction() {};
+  InlineFunction(std::nullptr_t) {};
+
+  template<typename F, typename = std::enable_if_t<
+    !std::is_same<std::decay_t<F>, InlineFunction>::value &&
+    std::is_invocable_r<R, std::decay_t<F>&, A...>::value
+  >>
+  InlineFunction(F&& callable) {
+    assign(std::forward<F>(callable));
+  }
+
+  InlineFunction(const InlineFunction& function) {
+    copyFrom(function);
+  }
+
+  InlineFunction(InlineFunction&& function) {
+    moveFrom(function);
+  }
+
+  ~InlineFunction() {
+    reset();
+  }
+
+  InlineFunction& operator=(const InlineFunction& function) {
+    if (this != &function) {
+      reset();
+      copyFrom(function);
+    }
+
+    return *this;
+  }
+
+  InlineFunction& operator=(InlineFunction&& function) {
+    if (this != &function) {
+      reset();
+      moveFrom(function);
+    }
+
+    return *this;
+  }
+
+  InlineFunction& operator=(std::nullptr_t) {
+    reset();
+
+    return *this;
+  }
+
+  template<typename F, typename = std::enable_if_t<
+    !std::is_same<std::decay_t<F>, InlineFunction>::value &&
+    std::is_invocable_r<R, std::decay_t<F>&, A...>::value
+  >>
+  InlineFunction& operator=(F&& callable) {
+    reset();
+    assign(std::forward<F>(callable));
+
+    return *this;
+  }
+
+  explicit operator bool() const {
+    return operations != nullptr;
+  }
+
+  R operator()(A... args) const {
+    return operations->invoke((void*)storage, std::forward<A>(args)...);
+  }
+
+private:
+  struct Operations {
+    R (*invoke)(void* callable, A&&... args);
+    void (*copy)(void* destination, const void* source);
+    void (*move)(void* destination, void* source);
+    void (*destroy)(void* callable);
+  };
+
+  alignas(std::max_align_t) unsigned char storage[CAPACITY];
+  const Operations* operations = nullptr;
+
+  template<typename F>
+  static const Operations* getOperations() {
+    const static Operations operations = {
+      [](void* callable, A&&... args) -> R {
+        return (R)(*(F*)callable)(std::forward<A>(args)...);
+      },
+      [](void* destination, const void* source) {
+        new (destination) F(*(const F*)source);
+      },
+      [](void* destination, void* source) {
+        new (destination) F(std::move(*(F*)source));
+      },
+      [](void* callable) {
+        ((F*)callable)->~F();
+      }
+    };
+
+    return &operations;
+  }
+
+  template<typename F>
+  void assign(F&& callable) {
+    typedef std::decay_t<F> Callable;
+
+    static_assert(sizeof(Callable) <= CAPACITY, "Callable is too large to store inline");
+    static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable is over-aligned");
+
+    new (storage) Callable(std::forward<F>(callable));
+
+    operations = getOperations<Callable>();
+  }
+
+  void copyFrom(const InlineFunction& function) {
+    if (function.operations != nullptr) {
+      function.operations->copy(storage, function.storage);
+
+      operations = function.operations;
+    }
+  }
+
+  void moveFrom(InlineFunction& function) {
+    if (function.operations != nullptr) {
+      function.operations->move(storage, function.storage);
+
+      operations = function.operations;
+
+      function.reset();
+    }
+  }
+
+  void reset() {
+    if (operations != nullptr) {
+      operations->destroy(storage);
+
+      operations = nullptr;
+    }
+  }
+};
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "subsystem/JobSystem.h"
+#include "subsystem/ZoneProfiler.h"
+
+constexpr static unsigned int INITIAL_QUEUE_SIZE = 256;
+
+/**
+ * JobSystem
+ * ---------
+ */
+unsigned int JobSystem::getTotalThreads() {
+  return (unsigned int)workers.size() + 1;
+}
+
+bool JobSystem::isRunning() {
+  return workers.size() > 0;
+}
+
+/**
+ * Splits the range [0, total) into batches, calling the body with the
+ * start and end of each batch in parallel, and returns once all of
+ * them are done. The calling thread takes the first batch itself.
+ */
+void JobSystem::parallelFor(unsigned int total, unsigned int batchSize, const InlineFunction<void(unsigned int, unsigned int)>& body) {
+  if (total == 0) {
+    return;
+  }
+
+  if (!isRunning() || total <= batchSize) {
+    body(0, total);
+
+    return;
+  }
+
+  JobCounter counter;
+
+  for (unsigned int start = batchSize; start < total; start += batchSize) {
+    unsigned int end = std::min(start + batchSize, total);
+
+    push([&body, start, end]() {
+      body(start, end);
+    }, counter);
+  }
+
+  wakeWorkers();
+
+  body(0, batchSize);
+
+  wait(counter);
+}
+
+void JobSystem::push(Job job, JobCounter& counter) {
+  auto* queue = queues[queueIndex];
+
+  counter.remaining.fetch_add(1, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(queue->mutex);
+
+  queue->pushBack({ std::move(job), &counter });
+  totalQueuedJobs++;
+}
+
+void JobSystem::run(Job job, JobCounter& counter) {
+  if (!isRunning()) {
+    job();
+
+    return;
+  }
+
+  push(std::move(job), counter);
+  wakeWorkers();
+}
+
+/**
+ * Runs the newest job on the current thread's own queue, or failing
+ * that, steals the oldest job from another queue. Returns false if
+ * there were no jobs to run.
+ */
+bool JobSystem::runNextJob() {
+  unsigned int totalQueues = (unsigned int)queues.size();
+  QueuedJob queuedJob;
+  bool hasJob = false;
+
+  {
+    auto* queue = queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+
+    if (queue->total > 0) {
+      queuedJob = queue->popBack();
+      totalQueuedJobs--;
+      hasJob = true;
+    }
+  }
+
+  for (unsigned int offset = 1; !hasJob && offset < totalQueues; offset++) {
+    auto* queue = queues[(queueIndex + offset) % totalQueues];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+
+    if (queue->total > 0) {
+      queuedJob = queue->popFront();
+      totalQueuedJobs--;
+      hasJob = true;
+    }
+  }
+
+  if (!hasJob) {
+    return false;
+  }
+
+  queuedJob.job();
+  queuedJob.counter->remaining.fetch_sub(1, std::memory_order_release);
+
+  return true;
+}
+
+/**
+ * Starts one worker per core besides the calling thread's. Has no
+ * effect if the workers are already running, or if there's only one
+ * core.
+ */
+void JobSystem::start() {
+  start(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+}
+
+void JobSystem::start(unsigned int totalWorkers) {
+  if (isRunning() || totalWorkers == 0) {
+    return;
+  }
+
+  isStopping = false;
+
+  // Queue 0 is shared by every thread other than the workers
+  for (unsigned int i = 0; i <= totalWorkers; i++) {
+    queues.push_back(new WorkQueue());
+    queues.back()->jobs.resize(INITIAL_QUEUE_SIZE);
+  }
+
+  for (unsigned int i = 1; i <= totalWorkers; i++) {
+    workers.push_back(std::thread(work, i));
+  }
+
+  printf("[JobSystem] Started %u workers\n", totalWorkers);
+}
+
+/**
+ * Stops and joins the workers. Any jobs must already have finished.
+ */
+void JobSystem::stop() {
+  if (!isRunning()) {
+    return;
+  }
+
+  isStopping = true;
+
+  wakeWorkers();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (auto* queue : queues) {
+    delete queue;
+  }
+
+  workers.clear();
+  queues.clear();
+}
+
+/**
+ * Runs jobs until the counter's jobs have all finished, so that jobs
+ * submitted by the waiting thread, or those they depend on, can never
+ * be stuck behind it.
+ */
+void JobSystem::wait(JobCounter& counter) {
+  while (counter.remaining.load(std::memory_order_acquire) > 0) {
+    if (!runNextJob()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::wakeWorkers() {
+  {
+    // Taking the lock ensures that no worker is between checking for
+    // jobs and going to sleep, where it would miss the notification
+    std::lock_guard<std::mutex> lock(sleepMutex);
+  }
+
+  wakeCondition.notify_all();
+}
+
+void JobSystem::work(unsigned int index) {
+  queueIndex = index;
+
+  ZoneProfiler::setThreadName(ZoneProfiler::internName("Worker " + std::to_string(index)));
+
+  while (!isStopping) {
+    if (!runNextJob()) {
+      std::unique_lock<std::mutex> lock(sleepMutex);
+
+      wakeCondition.wait(lock, []() {
+        return isStopping || totalQueuedJobs > 0;
+      });
+    }
+  }
+}
+
+std::vector<JobSystem::WorkQueue*> JobSystem::queues;
+std::vector<std::thread> JobSystem::workers;
+std::atomic<bool> JobSystem::isStopping = false;
+std::atomic<unsigned int> JobSystem::totalQueuedJobs = 0;
+std::mutex JobSystem::sleepMutex;
+std::condition_variable JobSystem::wakeCondition;
+thread_local unsigned int JobSystem::queueIndex = 0;
+
+/**
+ * JobSystem::WorkQueue
+ * --------------------
+ */
+JobSystem::QueuedJob JobSystem::WorkQueue::popBack() {
+  unsigned int size = (unsigned int)jobs.size();
+  QueuedJob job = std::move(jobs[(head + --total) % size]);
+
+  return job;
+}
+
+JobSystem::QueuedJob JobSystem::WorkQueue::popFront() {
+  unsigned int size = (unsigned int)jobs.size();
+  QueuedJob job = std::move(jobs[head]);
+
+  head = (head + 1) % size;
+  total--;
+
+  return job;
+}
+
+void JobSystem::WorkQueue::pushBack(QueuedJob&& job) {
+  unsigned int size = (unsigned int)jobs.size();
+
+  if (total == size) {
+    std::vector<QueuedJob> grownJobs(std::max(size * 2, INITIAL_QUEUE_SIZE));
+
+    for (unsigned int i = 0; i < total; i++) {
+      grownJobs[i] = std::move(jobs[(head + i) % size]);
+    }
+
+    jobs = std::move(grownJobs);
+    head = 0;
+    size = (unsigned int)jobs.size();
+  }
+
+  jobs[(head + total++) % size] = std::move(job);
+}
+
+/**
+ * JobGraph
+ * --------
+ */
+unsigned int JobGraph::add(const char* name, Job job) {
+  return add(name, std::move(job), {});
+}
+
+/**
+ * Adds a job, which only runs once each of the given jobs has finished,
+ * and returns its index for later jobs to depend on. The name is used
+ * as the job's profiled zone, so must be a string literal or otherwise
+ * outlive the profiler.
+ */
+unsigned int JobGraph::add(const char* name, Job job, std::initializer_list<unsigned int> dependencies) {
+  unsigned int index = (unsigned int)nodes.size();
+  auto node = std::make_unique<Node>();
+
+  node->name = name;
+  node->job = std::move(job);
+  node->totalDependencies = (unsigned int)dependencies.size();
+
+  for (unsigned int dependency : dependencies) {
+    nodes[dependency]->dependents.push_back(index);
+  }
+
+  nodes.push_back(std::move(node));
+
+  return index;
+}
+
+/**
+ * Runs every job in the graph, and returns once they've all finished.
+ * Graphs can be run again.
+ */
+void JobGraph::run() {
+  JobCounter counter;
+
+  for (auto& node : nodes) {
+    node->remainingDependencies = node->totalDependencies;
+  }
+
+  for (unsigned int i = 0; i < nodes.size(); i++) {
+    if (nodes[i]->totalDependencies == 0) {
+      schedule(i, counter);
+    }
+  }
+
+  JobSystem::wait(counter);
+}
+
+/**
+ * Submits a job whose dependencies have all finished. It schedules any
+ * dependents it was the last dependency of before finishing itself,
+ * so the counter can't reach zero while any of the graph is left.
+ */
+void JobGraph::schedule(unsigned int index, JobCounter& counter) {
+  JobSystem::run([this, index, &counter]() {
+    Node* node = nodes[index].get();
+
+    {
+      ScopedZone zone(node->name);
+
+      node->job();
+    }
+
+    for (unsigned int dependent : node->dependents) {
+      if (nodes[dependent]->remainingDependencies.fetch_sub(1) == 1) {
+        schedule(dependent, counter);
+      }
+    }
+  }, counter);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "subsystem/InlineFunction.h"
+
+typedef InlineFunction<void()> Job;
+
+/**
+ * Counts the jobs of a batch which have yet to finish, so that the
+ * batch can be waited on.
+ */
+struct JobCounter {
+  std::atomic<unsigned int> remaining = 0;
+};
+
+/**
+ * Runs jobs on a pool of worker threads, one per core besides the
+ * calling thread. Each worker has its own deque of jobs, pushing and
+ * popping its own jobs at the back, and stealing the oldest jobs from
+ * the front of the others' once it runs out. Jobs are stored inline in
+ * ring buffers which only grow, so submitting them doesn't allocate.
+ * Threads waiting on jobs help run them rather than blocking, so jobs
+ * may wait on jobs of their own.
+ *
+ * Until started, or once stopped, jobs run immediately on the calling
+ * thread, in the order they're submitted.
+ */
+class JobSystem {
+public:
+  static unsigned int getTotalThreads();
+  static bool isRunning();
+  static void parallelFor(unsigned int total, unsigned int batchSize, const InlineFunction<void(unsigned int, unsigned int)>& body);
+  static void run(Job job, JobCounter& counter);
+  static void start();
+  static void start(unsigned int totalWorkers);
+  static void stop();
+  static void wait(JobCounter& counter);
+
+private:
+  struct QueuedJob {
+    Job job;
+    JobCounter* counter = nullptr;
+  };
+
+  /**
+   * A deque of jobs as a ring buffer, doubling in size when full.
+   */
+  struct WorkQueue {
+    std::mutex mutex;
+    std::vector<QueuedJob> jobs;
+    unsigned int head = 0;
+    unsigned int total = 0;
+
+    QueuedJob popBack();
+    QueuedJob popFront();
+    void pushBack(QueuedJob&& job);
+  };
+
+  static std::vector<WorkQueue*> queues;
+  static std::vector<std::thread> workers;
+  static std::atomic<bool> isStopping;
+  static std::atomic<unsigned int> totalQueuedJobs;
+  static std::mutex sleepMutex;
+  static std::condition_variable wakeCondition;
+  static thread_local unsigned int queueIndex;
+
+  static void push(Job job, JobCounter& counter);
+  static bool runNextJob();
+  static void wakeWorkers();
+  static void work(unsigned int index);
+};
+
+/**
+ * A set of named jobs with dependencies between them, each run as soon
+ * as all of the jobs it depends on have finished. Jobs can only depend
+ * on jobs added before them, so graphs can't have cycles.
+ */
+class JobGraph {
+public:
+  unsigned int add(const char* name, Job job);
+  unsigned int add(const char* name, Job job, std::initializer_list<unsigned int> dependencies);
+  void run();
+
+private:
+  struct Node {
+    const char* name = nullptr;
+    Job job;
+    std::vector<unsigned int> dependents;
+    unsigned int totalDependencies = 0;
+    std::atomic<unsigned int> remainingDependencies = 0;
+  };
+
+  std::vector<std::unique_ptr<Node>> nodes;
+
+  void schedule(unsigned int index, JobCounter& counter);
+};
\ No newline at end of file
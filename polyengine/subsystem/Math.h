@@ -127,6 +127,7 @@ struct Matrix4 {
   Frustum operator*(const Frustum& frustum) const;
 
   void debug() const;
+  Matrix4 inverse() const;
   Matrix4 transpose() const;
 };
 
@@ -0,0 +1,100 @@
+#include <cstdio>
+
+#include "subsystem/MemoryTracker.h"
+
+static const char* TAG_NAMES[] = {
+  "CPU meshes",
+  "CPU instances",
+  "CPU textures",
+  "CPU pools",
+  "GPU meshes",
+  "GPU instances",
+  "GPU textures",
+  "GPU render targets",
+  "GPU shadow maps",
+  "GPU lights",
+  "GPU uniforms"
+};
+
+void MemoryTracker::dump() {
+  printf(
+    "[MemoryTracker] CPU: %.2f MB, GPU: %.2f MB\n",
+    getTotalCpuUsage() / (1024.0f * 1024.0f),
+    getTotalGpuUsage() / (1024.0f * 1024.0f)
+  );
+
+  for (unsigned int i = 0; i < MemoryTag::TOTAL_MEMORY_TAGS; i++) {
+    printf(
+      "[MemoryTracker]   %s: %.2f MB (peak %.2f MB)\n",
+      TAG_NAMES[i],
+      usage[i].load() / (1024.0f * 1024.0f),
+      highWaterMarks[i].load() / (1024.0f * 1024.0f)
+    );
+  }
+}
+
+uint64_t MemoryTracker::getHighWaterMark(MemoryTag tag) {
+  return highWaterMarks[tag].load(std::memory_order_relaxed);
+}
+
+const char* MemoryTracker::getTagName(MemoryTag tag) {
+  return TAG_NAMES[tag];
+}
+
+uint64_t MemoryTracker::getTotalCpuUsage() {
+  uint64_t total = 0;
+
+  for (unsigned int i = 0; i < MemoryTag::TOTAL_MEMORY_TAGS; i++) {
+    if (!isGpuTag((MemoryTag)i)) {
+      total += getUsage((MemoryTag)i);
+    }
+  }
+
+  return total;
+}
+
+uint64_t MemoryTracker::getTotalGpuUsage() {
+  uint64_t total = 0;
+
+  for (unsigned int i = 0; i < MemoryTag::TOTAL_MEMORY_TAGS; i++) {
+    if (isGpuTag((MemoryTag)i)) {
+      total += getUsage((MemoryTag)i);
+    }
+  }
+
+  return total;
+}
+
+uint64_t MemoryTracker::getUsage(MemoryTag tag) {
+  return usage[tag].load(std::memory_order_relaxed);
+}
+
+bool MemoryTracker::isGpuTag(MemoryTag tag) {
+  return tag >= MemoryTag::GPU_MESHES;
+}
+
+void MemoryTracker::trackAllocation(MemoryTag tag, uint64_t bytes) {
+  uint64_t current = usage[tag].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  uint64_t highWaterMark = highWaterMarks[tag].load(std::memory_order_relaxed);
+
+  while (current > highWaterMark && !highWaterMarks[tag].compare_exchange_weak(highWaterMark, current, std::memory_order_relaxed)) {}
+}
+
+void MemoryTracker::trackFree(MemoryTag tag, uint64_t bytes) {
+  usage[tag].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * Tracks a buffer being reallocated from one size to another, e.g.
+ * by glBufferData on an existing buffer.
+ */
+void MemoryTracker::trackResize(MemoryTag tag, uint64_t previousBytes, uint64_t bytes) {
+  if (bytes > previousBytes) {
+    trackAllocation(tag, bytes - previousBytes);
+  } else {
+    trackFree(tag, previousBytes - bytes);
+  }
+}
+
+std::atomic<uint64_t> MemoryTracker::usage[MemoryTag::TOTAL_MEMORY_TAGS];
+std::atomic<uint64_t> MemoryTracker::highWaterMarks[MemoryTag::TOTAL_MEMORY_TAGS];
\ No newline at end of file
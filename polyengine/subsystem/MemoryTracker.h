@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Subsystems which memory is accounted to. CPU memory covers engine
+ * data structures, while GPU memory covers OpenGL buffers and
+ * textures, sized from their formats and dimensions.
+ */
+enum MemoryTag {
+  CPU_MESHES,
+  CPU_INSTANCES,
+  CPU_TEXTURES,
+  CPU_POOLS,
+  GPU_MESHES,
+  GPU_INSTANCES,
+  GPU_TEXTURES,
+  GPU_RENDER_TARGETS,
+  GPU_SHADOW_MAPS,
+  GPU_LIGHTS,
+  GPU_UNIFORMS,
+  TOTAL_MEMORY_TAGS
+};
+
+/**
+ * Accounts for memory allocated by each engine subsystem, tracking
+ * both live usage and the high-water mark. Unlike driver-reported
+ * GPU memory, this works with any vendor, and since every tracked
+ * allocation must be matched by a free, steadily growing usage is
+ * a reliable sign of a leak. Allocations may be tracked from any
+ * thread.
+ */
+class MemoryTracker {
+public:
+  static void dump();
+  static uint64_t getHighWaterMark(MemoryTag tag);
+  static const char* getTagName(MemoryTag tag);
+  static uint64_t getTotalCpuUsage();
+  static uint64_t getTotalGpuUsage();
+  static uint64_t getUsage(MemoryTag tag);
+  static bool isGpuTag(MemoryTag tag);
+  static void trackAllocation(MemoryTag tag, uint64_t bytes);
+  static void trackFree(MemoryTag tag, uint64_t bytes);
+  static void trackResize(MemoryTag tag, uint64_t previousBytes, uint64_t bytes);
+
+private:
+  static std::atomic<uint64_t> usage[MemoryTag::TOTAL_MEMORY_TAGS];
+  static std::atomic<uint64_t> highWaterMarks[MemoryTag::TOTAL_MEMORY_TAGS];
+};
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <chrono>
+#include <cstdio>
+
+#include "subsystem/NullVideoController.h"
+#include "subsystem/AbstractScene.h"
+#include "subsystem/PerformanceProfiler.h"
+#include "subsystem/ZoneProfiler.h"
+#include "subsystem/entities/Object.h"
+#include "subsystem/entities/Instance.h"
+
+const RenderCommandList& NullVideoController::getGeometryCommands() const {
+  return geometryCommands;
+}
+
+void NullVideoController::onEntityRemoved(Entity* entity) {
+  if (entity->isOfType<Light>()) {
+    lightViewCommands.erase((Light*)entity);
+  }
+}
+
+void NullVideoController::onInit(SDL_Window* sdlWindow) {
+  printf("[NullVideoController] Rendering disabled\n");
+}
+
+/**
+ * Records every view the OpenGL video controller would render for
+ * the frame, and tracks the frame's objects, lights and draws as if
+ * they had been rendered.
+ */
+void NullVideoController::onPrepareFrame() {
+  PROFILE_ZONE("NullVideoController::onPrepareFrame");
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  recordGeometry();
+
+  for (auto* light : scene->getStage().getLights()) {
+    if (light->power > 0.0f) {
+      if (light->canCastShadows) {
+        recordLightView(light);
+      }
+
+      PerformanceProfiler::trackLight(light);
+    }
+  }
+
+  for (auto& light : scene->getStage().getWorld().getLights()) {
+    if (light.power > 0.0f) {
+      PerformanceProfiler::trackLight(&light);
+    }
+  }
+
+  std::chrono::duration<float, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+
+  PerformanceProfiler::trackCommandRecordTime(duration.count());
+}
+
+/**
+ * Nothing is rendered; all of the work happens in onPrepareFrame().
+ */
+void NullVideoController::onRender(SDL_Window* sdlWindow) {}
+
+void NullVideoController::onSceneChange(AbstractScene* scene) {
+  geometryCommands.clear();
+  lightViewCommands.clear();
+
+  scene->onEntityRemoved([=](auto* entity) {
+    onEntityRemoved(entity);
+  });
+}
+
+void NullVideoController::recordGeometry() {
+  geometryCommands.clear();
+
+  for (auto* object : scene->getStage().getObjects()) {
+    unsigned int totalRenderableInstances = object->getTotalRenderableInstances();
+
+    if (object->isOfType<Instance>() || totalRenderableInstances == 0) {
+      continue;
+    }
+
+    geometryCommands.draw(object, object, false);
+
+    PerformanceProfiler::trackObject(object, totalRenderableInstances);
+    PerformanceProfiler::trackDrawCall();
+  }
+
+  PerformanceProfiler::trackViewInstances("camera", geometryCommands.getTotalConsideredInstances(), geometryCommands.getTotalDrawnInstances());
+}
+
+/**
+ * Records a light's view. Directional lights draw every shadowcasting
+ * object, while spot and point lights draw only those instances within
+ * their radius, as in the OpenGL light view passes.
+ */
+void NullVideoController::recordLightView(const Light* light) {
+  auto& commands = lightViewCommands[light];
+
+  commands.clear();
+
+  for (auto* object : scene->getStage().getObjects()) {
+    if (object->isOfType<Instance>() || object->shadowCascadeLimit == 0) {
+      continue;
+    }
+
+    bool useShadowLod = object->shadowLod != nullptr;
+
+    if (light->type == Light::LightType::DIRECTIONAL) {
+      commands.draw(object, object, useShadowLod);
+    } else {
+      commands.drawInstancesWhere(object, object, useShadowLod, [=](const Vec3f& position) {
+        return light->isWithinRadius(position);
+      });
+    }
+  }
+
+  const char* view = (
+    light->type == Light::LightType::DIRECTIONAL
+      ? "directional-light" :
+    light->type == Light::LightType::SPOTLIGHT
+      ? "spot-light" :
+    "point-light"
+  );
+
+  PerformanceProfiler::trackViewInstances(view, commands.getTotalConsideredInstances(), commands.getTotalDrawnInstances());
+}
\ No newline at end of file
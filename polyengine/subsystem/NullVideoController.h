@@ -0,0 +1,34 @@
+#pragma once
+
+#include <map>
+
+#include "subsystem/AbstractVideoController.h"
+#include "subsystem/RenderCommandList.h"
+#include "subsystem/entities/Entity.h"
+#include "subsystem/entities/Light.h"
+
+/**
+ * A video controller which performs all of the CPU-side work of
+ * preparing a frame - deciding which objects and instances each view
+ * draws, and recording its command list - without a graphics API.
+ * Paired with a headless Window, this allows the simulation and
+ * render preparation costs of a scene to be measured on machines
+ * without a GPU or display.
+ */
+class NullVideoController final : public AbstractVideoController {
+public:
+  void onInit(SDL_Window* sdlWindow) override;
+  void onPrepareFrame() override;
+  void onRender(SDL_Window* sdlWindow) override;
+  void onSceneChange(AbstractScene* scene) override;
+
+  const RenderCommandList& getGeometryCommands() const;
+
+private:
+  RenderCommandList geometryCommands;
+  std::map<const Light*, RenderCommandList> lightViewCommands;
+
+  void onEntityRemoved(Entity* entity);
+  void recordGeometry();
+  void recordLightView(const Light* light);
+};
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "subsystem/ObjLoader.h"
+#include "subsystem/ZoneProfiler.h"
 
 static std::string VERTEX_LABEL = "v";
 static std::string TEXTURE_COORDINATE_LABEL = "vt";
@@ -10,6 +11,8 @@ static std::string NORMAL_LABEL = "vn";
 static std::string FACE_LABEL = "f";
 
 ObjLoader::ObjLoader(const char* path) {
+  PROFILE_ZONE("ObjLoader");
+
   load(path);
 
   while (isLoading) {
@@ -1,7 +1,86 @@
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 
+#include "subsystem/MemoryTracker.h"
 #include "subsystem/PerformanceProfiler.h"
-#include "SDL.h"
+
+/**
+ * Replaces the global allocator with one which counts allocations,
+ * so that per-frame heap churn shows up in the profile. Every form of
+ * delete is replaced too, so that none of them hands memory from
+ * malloc to the default allocator.
+ */
+void* operator new(size_t size) {
+  PerformanceProfiler::trackCounter(ProfiledCounter::HEAP_ALLOCATIONS);
+
+  void* memory = malloc(size > 0 ? size : 1);
+
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return memory;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+  free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+  free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+  free(memory);
+}
+
+static const char* COUNTER_NAMES[] = {
+  "bytes uploaded",
+  "buffer reallocations",
+  "program switches",
+  "texture switches",
+  "uniform sets",
+  "entities added",
+  "entities removed",
+  "heap allocations"
+};
+
+/**
+ * Prints the counters and view instance counts of the most recently
+ * completed frame.
+ */
+void PerformanceProfiler::dumpStats() {
+  printf("[PerformanceProfiler] Frame %u:", currentFrame);
+
+  for (unsigned int i = 0; i < ProfiledCounter::TOTAL_PROFILED_COUNTERS; i++) {
+    printf("%s %s: %u", i > 0 ? "," : "", COUNTER_NAMES[i], profile.counters[i]);
+  }
+
+  printf("\n");
+
+  for (auto& counts : profile.viewInstanceCounts) {
+    printf(
+      "[PerformanceProfiler]   View %s: %u considered, %u culled, %u drawn\n",
+      counts.view,
+      counts.considered,
+      counts.culled,
+      counts.drawn
+    );
+  }
+
+  MemoryTracker::dump();
+}
 
 unsigned int PerformanceProfiler::getAverageFps() {
   unsigned int samples = std::min(120, int(currentFrame));
@@ -14,12 +93,30 @@ unsigned int PerformanceProfiler::getAverageFps() {
   return unsigned int(sum / float(samples));
 }
 
+unsigned int PerformanceProfiler::getCounter(ProfiledCounter counter) {
+  return profile.counters[counter];
+}
+
 unsigned int PerformanceProfiler::getCurrentFrame() {
   return currentFrame;
 }
 
 unsigned int PerformanceProfiler::getFps() {
-  return unsigned int(1000.0f / float(frame.end - frame.start));
+  return profile.frameTime > 0.0f ? (unsigned int)(1000.0f / profile.frameTime) : 0;
+}
+
+/**
+ * Returns the most recent GPU time of the named pass, or 0 if the
+ * pass hasn't been timed.
+ */
+float PerformanceProfiler::getGpuPassTime(const char* name) {
+  for (auto& pass : profile.gpuPassTimes) {
+    if (pass.name == name) {
+      return pass.time;
+    }
+  }
+
+  return 0.0f;
 }
 
 const PerformanceProfile& PerformanceProfiler::getProfile() {
@@ -33,8 +130,40 @@ void PerformanceProfiler::resetProfile() {
   profile.totalLights = 0;
   profile.totalShadowCasters = 0;
   profile.totalDrawCalls = 0;
+  profile.totalStateChanges = 0;
+  profile.totalSkippedStateChanges = 0;
   profile.totalGpuMemory = 0;
   profile.usedGpuMemory = 0;
+  profile.gpuWaitTime = 0.0f;
+  profile.commandRecordTime = 0.0f;
+  profile.commandReplayTime = 0.0f;
+
+  for (auto& time : profile.subsystemTimes) {
+    time = 0.0f;
+  }
+}
+
+/**
+ * Dumps stats every given number of frames, or never if 0.
+ */
+void PerformanceProfiler::setStatsDumpInterval(unsigned int frames) {
+  statsDumpInterval = frames;
+}
+
+void PerformanceProfiler::trackCommandRecordTime(float milliseconds) {
+  profile.commandRecordTime = milliseconds;
+}
+
+/**
+ * Command lists are replayed view by view, so replay times are
+ * accumulated over the frame.
+ */
+void PerformanceProfiler::trackCommandReplayTime(float milliseconds) {
+  profile.commandReplayTime += milliseconds;
+}
+
+void PerformanceProfiler::trackCounter(ProfiledCounter counter, unsigned int amount) {
+  counters[counter].fetch_add(amount, std::memory_order_relaxed);
 }
 
 void PerformanceProfiler::trackDrawCall() {
@@ -42,7 +171,9 @@ void PerformanceProfiler::trackDrawCall() {
 }
 
 void PerformanceProfiler::trackFrameEnd() {
-  frame.end = SDL_GetTicks();
+  std::chrono::duration<float, std::milli> frameTime = std::chrono::high_resolution_clock::now() - frameStart;
+
+  profile.frameTime = frameTime.count();
 
   unsigned int fps = getFps();
 
@@ -50,12 +181,32 @@ void PerformanceProfiler::trackFrameEnd() {
 
   profile.fps = fps;
   profile.averageFps = getAverageFps();
+  profile.trackedCpuMemory = (unsigned int)(MemoryTracker::getTotalCpuUsage() / (1024 * 1024));
+  profile.trackedGpuMemory = (unsigned int)(MemoryTracker::getTotalGpuUsage() / (1024 * 1024));
+
+  // Counters are only published at the end of each frame, since
+  // other threads may still be tracking them until then
+  for (unsigned int i = 0; i < ProfiledCounter::TOTAL_PROFILED_COUNTERS; i++) {
+    profile.counters[i] = counters[i].exchange(0, std::memory_order_relaxed);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(viewInstanceCountsMutex);
+
+    profile.viewInstanceCounts = viewInstanceCounts;
+
+    viewInstanceCounts.clear();
+  }
+
+  if (statsDumpInterval > 0 && currentFrame % statsDumpInterval == 0) {
+    dumpStats();
+  }
 }
 
 void PerformanceProfiler::trackFrameStart() {
   resetProfile();
 
-  frame.start = SDL_GetTicks();
+  frameStart = std::chrono::high_resolution_clock::now();
 }
 
 void PerformanceProfiler::trackGpuMemory(unsigned int totalMemory, unsigned int usedMemory) {
@@ -63,6 +214,49 @@ void PerformanceProfiler::trackGpuMemory(unsigned int totalMemory, unsigned int
   profile.usedGpuMemory = usedMemory;
 }
 
+/**
+ * Tracks how long the CPU blocked waiting for the GPU to catch up
+ * before submitting the frame.
+ */
+void PerformanceProfiler::trackGpuWaitTime(float milliseconds) {
+  profile.gpuWaitTime = milliseconds;
+}
+
+/**
+ * GPU pass times are read back a few frames after submission, so
+ * they persist across profile resets until a newer measurement
+ * arrives. Each pass keeps an average over its last 120 samples.
+ */
+void PerformanceProfiler::trackGpuPassTime(const char* name, float milliseconds) {
+  GpuPassTime* pass = nullptr;
+
+  for (auto& existingPass : profile.gpuPassTimes) {
+    if (existingPass.name == name) {
+      pass = &existingPass;
+      break;
+    }
+  }
+
+  if (pass == nullptr) {
+    profile.gpuPassTimes.push_back(GpuPassTime());
+
+    pass = &profile.gpuPassTimes.back();
+    pass->name = name;
+  }
+
+  pass->samples[pass->totalSamples++ % 120] = milliseconds;
+  pass->time = milliseconds;
+
+  unsigned int samples = std::min(120U, pass->totalSamples);
+  float sum = 0.0f;
+
+  for (unsigned int i = 0; i < samples; i++) {
+    sum += pass->samples[i];
+  }
+
+  pass->averageTime = sum / samples;
+}
+
 void PerformanceProfiler::trackLight(const Light* light) {
   profile.totalLights++;
 
@@ -77,7 +271,56 @@ void PerformanceProfiler::trackObject(const Object* object, unsigned int totalRe
   profile.totalPolygons += object->getPolygons().size() * totalRenderableInstances;
 }
 
+/**
+ * Tracks the number of GL state changes and binds which were
+ * issued to the driver, and those skipped as redundant.
+ */
+void PerformanceProfiler::trackStateChanges(unsigned int issued, unsigned int skipped) {
+  profile.totalStateChanges = issued;
+  profile.totalSkippedStateChanges = skipped;
+}
+
+/**
+ * Subsystems may run several times per frame, e.g. culling for
+ * multiple object filters, so their times are accumulated.
+ */
+void PerformanceProfiler::trackSubsystemTime(ProfiledSubsystem subsystem, float milliseconds) {
+  profile.subsystemTimes[subsystem] += milliseconds;
+}
+
+/**
+ * Views are recorded in parallel, so counts are accumulated under
+ * a lock. Views with the same name, e.g. every spot light view,
+ * are counted together.
+ */
+void PerformanceProfiler::trackViewInstances(const char* view, unsigned int considered, unsigned int drawn) {
+  std::lock_guard<std::mutex> lock(viewInstanceCountsMutex);
+
+  for (auto& counts : viewInstanceCounts) {
+    if (strcmp(counts.view, view) == 0) {
+      counts.considered += considered;
+      counts.culled += considered - drawn;
+      counts.drawn += drawn;
+
+      return;
+    }
+  }
+
+  ViewInstanceCounts counts;
+
+  counts.view = view;
+  counts.considered = considered;
+  counts.culled = considered - drawn;
+  counts.drawn = drawn;
+
+  viewInstanceCounts.push_back(counts);
+}
+
 PerformanceProfile PerformanceProfiler::profile;
-Range<int> PerformanceProfiler::frame;
+std::chrono::high_resolution_clock::time_point PerformanceProfiler::frameStart;
 unsigned int PerformanceProfiler::currentFrame = 0;
-unsigned int PerformanceProfiler::fpsSamples[120];
\ No newline at end of file
+unsigned int PerformanceProfiler::fpsSamples[120];
+std::atomic<unsigned int> PerformanceProfiler::counters[ProfiledCounter::TOTAL_PROFILED_COUNTERS];
+std::mutex PerformanceProfiler::viewInstanceCountsMutex;
+std::vector<ViewInstanceCounts> PerformanceProfiler::viewInstanceCounts;
+unsigned int PerformanceProfiler::statsDumpInterval = 0;
\ No newline at end of file
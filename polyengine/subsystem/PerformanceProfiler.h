@@ -1,9 +1,66 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "subsystem/Math.h"
 #include "subsystem/entities/Object.h"
 #include "subsystem/entities/Light.h"
 
+/**
+ * Engine subsystems whose CPU time is tracked per frame.
+ */
+enum ProfiledSubsystem {
+  STAGE_UPDATE,
+  REHYDRATE,
+  CULLING,
+  LIGHT_BUFFERING,
+  TOTAL_PROFILED_SUBSYSTEMS
+};
+
+/**
+ * Engine work counted per frame. Counts are taken over the frame
+ * most recently completed, and may be tracked from any thread.
+ */
+enum ProfiledCounter {
+  BYTES_UPLOADED,
+  BUFFER_REALLOCATIONS,
+  PROGRAM_SWITCHES,
+  TEXTURE_SWITCHES,
+  UNIFORM_SETS,
+  ENTITIES_ADDED,
+  ENTITIES_REMOVED,
+  HEAP_ALLOCATIONS,
+  TOTAL_PROFILED_COUNTERS
+};
+
+/**
+ * Instances considered for a view over a frame, and how many of
+ * those were culled rather than drawn. Views are named by string
+ * literals, so that tracking them each frame doesn't allocate.
+ */
+struct ViewInstanceCounts {
+  const char* view = nullptr;
+  unsigned int considered = 0;
+  unsigned int culled = 0;
+  unsigned int drawn = 0;
+};
+
+/**
+ * GPU time spent in a named pass, as of the most recent frame whose
+ * timings have been read back, and averaged over recent frames.
+ */
+struct GpuPassTime {
+  std::string name;
+  float time = 0.0f;
+  float averageTime = 0.0f;
+  float samples[120] = { 0.0f };
+  unsigned int totalSamples = 0;
+};
+
 struct PerformanceProfile {
   unsigned int fps = 0;
   unsigned int averageFps = 0;
@@ -13,26 +70,54 @@ struct PerformanceProfile {
   unsigned int totalLights = 0;
   unsigned int totalShadowCasters = 0;
   unsigned int totalDrawCalls = 0;
+  unsigned int totalStateChanges = 0;
+  unsigned int totalSkippedStateChanges = 0;
   unsigned int totalGpuMemory = 0;
   unsigned int usedGpuMemory = 0;
+  unsigned int trackedCpuMemory = 0;
+  unsigned int trackedGpuMemory = 0;
+  float frameTime = 0.0f;
+  float gpuWaitTime = 0.0f;
+  float commandRecordTime = 0.0f;
+  float commandReplayTime = 0.0f;
+  float subsystemTimes[ProfiledSubsystem::TOTAL_PROFILED_SUBSYSTEMS] = { 0.0f };
+  unsigned int counters[ProfiledCounter::TOTAL_PROFILED_COUNTERS] = { 0 };
+  std::vector<ViewInstanceCounts> viewInstanceCounts;
+  std::vector<GpuPassTime> gpuPassTimes;
 };
 
 class PerformanceProfiler {
 public:
+  static void dumpStats();
+  static unsigned int getCounter(ProfiledCounter counter);
   static unsigned int getCurrentFrame();
+  static void setStatsDumpInterval(unsigned int frames);
+  static void trackCommandRecordTime(float milliseconds);
+  static void trackCommandReplayTime(float milliseconds);
+  static float getGpuPassTime(const char* name);
   static const PerformanceProfile& getProfile();
+  static void trackCounter(ProfiledCounter counter, unsigned int amount = 1);
   static void trackDrawCall();
   static void trackFrameEnd();
   static void trackFrameStart();
   static void trackGpuMemory(unsigned int totalMemory, unsigned int usedMemory);
+  static void trackGpuWaitTime(float milliseconds);
+  static void trackGpuPassTime(const char* name, float milliseconds);
   static void trackLight(const Light* light);
   static void trackObject(const Object* object, unsigned int totalRenderableInstances);
+  static void trackStateChanges(unsigned int issued, unsigned int skipped);
+  static void trackSubsystemTime(ProfiledSubsystem subsystem, float milliseconds);
+  static void trackViewInstances(const char* view, unsigned int considered, unsigned int drawn);
 
 private:
   static PerformanceProfile profile;
-  static Range<int> frame;
+  static std::chrono::high_resolution_clock::time_point frameStart;
   static unsigned int currentFrame;
   static unsigned int fpsSamples[120];
+  static std::atomic<unsigned int> counters[ProfiledCounter::TOTAL_PROFILED_COUNTERS];
+  static std::mutex viewInstanceCountsMutex;
+  static std::vector<ViewInstanceCounts> viewInstanceCounts;
+  static unsigned int statsDumpInterval;
 
   static unsigned int getAverageFps();
   static unsigned int getFps();
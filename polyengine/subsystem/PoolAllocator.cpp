@@ -0,0 +1,69 @@
+#include <cstdint>
+#include <new>
+
+#include "subsystem/PoolAllocator.h"
+#include "subsystem/MemoryTracker.h"
+
+void* PoolAllocator::allocate(size_t size) {
+  if (size == 0 || size > MAX_POOLED_BYTES) {
+    return ::operator new(size);
+  }
+
+  unsigned int sizeClass = (unsigned int)((size - 1) / SIZE_CLASS_BYTES);
+  Pool& pool = pools[sizeClass];
+  std::lock_guard<std::mutex> lock(pool.mutex);
+
+  if (pool.freeBlocks == nullptr) {
+    refill(pool, (sizeClass + 1) * SIZE_CLASS_BYTES);
+  }
+
+  FreeBlock* block = pool.freeBlocks;
+
+  pool.freeBlocks = block->next;
+
+  return block;
+}
+
+/**
+ * Returns memory to the pool it was allocated from. The size must be
+ * the one it was allocated with, which sized delete guarantees, even
+ * when deleting through a base class with a virtual destructor.
+ */
+void PoolAllocator::free(void* memory, size_t size) {
+  if (memory == nullptr) {
+    return;
+  }
+
+  if (size == 0 || size > MAX_POOLED_BYTES) {
+    ::operator delete(memory);
+
+    return;
+  }
+
+  Pool& pool = pools[(size - 1) / SIZE_CLASS_BYTES];
+  FreeBlock* block = (FreeBlock*)memory;
+  std::lock_guard<std::mutex> lock(pool.mutex);
+
+  block->next = pool.freeBlocks;
+  pool.freeBlocks = block;
+}
+
+/**
+ * Carves a new slab into blocks, threading them onto the pool's free
+ * list in address order.
+ */
+void PoolAllocator::refill(Pool& pool, size_t blockSize) {
+  size_t totalBlocks = SLAB_BYTES / blockSize;
+  uint8_t* slab = (uint8_t*)::operator new(totalBlocks * blockSize);
+
+  for (size_t i = totalBlocks; i > 0; i--) {
+    FreeBlock* block = (FreeBlock*)(slab + (i - 1) * blockSize);
+
+    block->next = pool.freeBlocks;
+    pool.freeBlocks = block;
+  }
+
+  MemoryTracker::trackAllocation(MemoryTag::CPU_POOLS, totalBlocks * blockSize);
+}
+
+PoolAllocator::Pool PoolAllocator::pools[PoolAllocator::TOTAL_SIZE_CLASSES];
\ No newline at end of file
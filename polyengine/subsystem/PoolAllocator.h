@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+/**
+ * Recycles the memory of small objects which are created and destroyed
+ * constantly during gameplay, such as instances, lights and actors, so
+ * that steady-state churn never reaches the general heap. Allocations
+ * are grouped into size classes 16 bytes apart, each with its own free
+ * list, which is refilled a whole slab at a time once it runs out.
+ * Slabs are kept for the lifetime of the program, so a pool only ever
+ * grows to the most objects of its size alive at once.
+ *
+ * Classes opt in by forwarding their own operator new and delete here.
+ * Larger allocations fall back to the heap. Allocations may be made
+ * from any thread.
+ */
+class PoolAllocator {
+public:
+  static void* allocate(size_t size);
+  static void free(void* memory, size_t size);
+
+private:
+  constexpr static size_t SIZE_CLASS_BYTES = 16;
+  constexpr static size_t MAX_POOLED_BYTES = 2048;
+  constexpr static size_t SLAB_BYTES = 64 * 1024;
+  constexpr static unsigned int TOTAL_SIZE_CLASSES = MAX_POOLED_BYTES / SIZE_CLASS_BYTES;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct Pool {
+    std::mutex mutex;
+    FreeBlock* freeBlocks = nullptr;
+  };
+
+  static Pool pools[TOTAL_SIZE_CLASSES];
+
+  static void refill(Pool& pool, size_t blockSize);
+};
\ No newline at end of file
@@ -1,15 +1,57 @@
-#include <cstdlib>
+#include <atomic>
 #include <ctime>
-#include <cmath>
+#include <random>
 
 #include "subsystem/RNG.h"
 
+static std::atomic<unsigned int> masterSeed = 0;
+static std::atomic<unsigned int> seedGeneration = 0;
+static std::atomic<unsigned int> totalStreams = 0;
+
+/**
+ * Each thread draws from its own engine, so that update handlers can
+ * use RNG concurrently. Engines are seeded from the master seed and
+ * a per-thread stream number, and reseeded whenever the master seed
+ * changes. Streams are numbered in the order threads first use RNG,
+ * so the thread which seeds first always gets stream 0, and its
+ * sequence is reproducible from the seed alone.
+ */
+struct RandomStream {
+  std::minstd_rand engine;
+  unsigned int index = totalStreams.fetch_add(1);
+  unsigned int generation = 0xFFFFFFFF;
+};
+
+static thread_local RandomStream stream;
+
+static std::minstd_rand& getEngine() {
+  unsigned int generation = seedGeneration.load(std::memory_order_acquire);
+
+  if (stream.generation != generation) {
+    stream.engine.seed(masterSeed.load(std::memory_order_relaxed) + stream.index * 0x9E3779B9u);
+    stream.generation = generation;
+  }
+
+  return stream.engine;
+}
+
 void RNG::seed() {
-  srand(time(0));
+  seed((unsigned int)time(0));
+}
+
+/**
+ * Seeds with a fixed value, so that runs are reproducible.
+ */
+void RNG::seed(unsigned int value) {
+  masterSeed.store(value, std::memory_order_relaxed);
+  seedGeneration.fetch_add(1, std::memory_order_release);
+
+  // Claims a stream for the seeding thread, if it doesn't have one yet
+  getEngine();
 }
 
 float RNG::random() {
-  return (rand() % 1000) / 1000.0f;
+  return (getEngine()() % 1000) / 1000.0f;
 }
 
 float RNG::random(float low, float high) {
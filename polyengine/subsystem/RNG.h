@@ -1,5 +1,6 @@
 namespace RNG {
   void seed();
+  void seed(unsigned int value);
   float random();
   float random(float low, float high);
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "subsystem/RenderCommandList.h"
+#include "subsystem/entities/Instance.h"
+
+void RenderCommandList::clear() {
+  commands.clear();
+  instanceMatrices.clear();
+  instanceColors.clear();
+  instanceObjectIds.clear();
+
+  currentPipeline = nullptr;
+  currentVariant = 0;
+  currentCascadeLimit = -1;
+  currentStencilMask = 0xFFFFFFFF;
+  totalDraws = 0;
+  totalConsideredInstances = 0;
+  totalDrawnInstances = 0;
+}
+
+/**
+ * Records a draw of every instance an object currently renders.
+ */
+void RenderCommandList::draw(void* handle, const Object* object, bool useShadowLod) {
+  RenderCommand command;
+
+  command.type = RenderCommandType::DRAW_OBJECT;
+  command.draw = { handle, object, useShadowLod, 0, 0 };
+
+  commands.push_back(command);
+  totalDraws++;
+  totalConsideredInstances += object->getTotalInstances();
+  totalDrawnInstances += object->getTotalRenderableInstances();
+}
+
+/**
+ * Records a draw of only those instances of an object whose positions
+ * match a predicate, regardless of whether rendering is enabled for
+ * them.
+ */
+void RenderCommandList::drawInstancesWhere(void* handle, const Object* object, bool useShadowLod, const std::function<bool(const Vec3f&)>& predicate) {
+  unsigned int firstInstance = instanceObjectIds.size();
+
+  auto addInstance = [&](const Matrix4& matrix, const Vec3f& color, int objectId) {
+    instanceMatrices.insert(instanceMatrices.end(), matrix.m, matrix.m + 16);
+    instanceColors.push_back(color.x);
+    instanceColors.push_back(color.y);
+    instanceColors.push_back(color.z);
+    instanceObjectIds.push_back(objectId);
+  };
+
+  if (object->hasInstances()) {
+    int index = 0;
+
+    for (auto* instance : object->getInstances()) {
+      if (predicate(instance->position)) {
+        addInstance(instance->getMatrix(), instance->color, index);
+      }
+
+      index++;
+    }
+
+    for (auto& worldInstance : object->getWorldInstances()) {
+      if (predicate(worldInstance.position)) {
+        addInstance(worldInstance.matrix, worldInstance.color, index);
+      }
+
+      index++;
+    }
+  } else if (object->getTotalInstances() > 0 && predicate(object->position)) {
+    addInstance(object->getMatrix(), object->color, object->id);
+  }
+
+  unsigned int totalInstances = instanceObjectIds.size() - firstInstance;
+
+  totalConsideredInstances += object->getTotalInstances();
+  totalDrawnInstances += totalInstances;
+
+  if (totalInstances == 0) {
+    return;
+  }
+
+  RenderCommand command;
+
+  command.type = RenderCommandType::DRAW_INSTANCES;
+  command.draw = { handle, object, useShadowLod, firstInstance, totalInstances };
+
+  commands.push_back(command);
+  totalDraws++;
+}
+
+const std::vector<RenderCommand>& RenderCommandList::getCommands() const {
+  return commands;
+}
+
+const float* RenderCommandList::getInstanceColors(const RenderCommand& command) const {
+  return &instanceColors[command.draw.firstInstance * 3];
+}
+
+const float* RenderCommandList::getInstanceMatrices(const RenderCommand& command) const {
+  return &instanceMatrices[command.draw.firstInstance * 16];
+}
+
+const int* RenderCommandList::getInstanceObjectIds(const RenderCommand& command) const {
+  return &instanceObjectIds[command.draw.firstInstance];
+}
+
+/**
+ * Returns the number of instances the list's draws were recorded
+ * from, whether or not they were drawn.
+ */
+unsigned int RenderCommandList::getTotalConsideredInstances() const {
+  return totalConsideredInstances;
+}
+
+unsigned int RenderCommandList::getTotalDraws() const {
+  return totalDraws;
+}
+
+unsigned int RenderCommandList::getTotalDrawnInstances() const {
+  return totalDrawnInstances;
+}
+
+void RenderCommandList::setDrawConstants(int cascadeLimit) {
+  if (cascadeLimit == currentCascadeLimit) {
+    return;
+  }
+
+  RenderCommand command;
+
+  command.type = RenderCommandType::SET_DRAW_CONSTANTS;
+  command.drawConstants.cascadeLimit = cascadeLimit;
+
+  commands.push_back(command);
+
+  currentCascadeLimit = cascadeLimit;
+}
+
+/**
+ * Records an integer uniform for the current pipeline. Names must
+ * outlive the command list, e.g. as string literals.
+ */
+void RenderCommandList::setInt(const char* name, int value) {
+  RenderCommand command;
+
+  command.type = RenderCommandType::SET_INT;
+  command.uniform = { name, value };
+
+  commands.push_back(command);
+}
+
+/**
+ * Records a pipeline change, returning true if the pipeline differs
+ * from the current one. Callers only need to record uniforms for the
+ * pipeline when this happens.
+ */
+bool RenderCommandList::setPipeline(const void* handle, unsigned int variant) {
+  if (handle == currentPipeline && variant == currentVariant) {
+    return false;
+  }
+
+  RenderCommand command;
+
+  command.type = RenderCommandType::SET_PIPELINE;
+  command.pipeline = { handle, variant };
+
+  commands.push_back(command);
+
+  currentPipeline = handle;
+  currentVariant = variant;
+
+  return true;
+}
+
+void RenderCommandList::setStencilMask(unsigned int mask) {
+  if (mask == currentStencilMask) {
+    return;
+  }
+
+  RenderCommand command;
+
+  command.type = RenderCommandType::SET_STENCIL_MASK;
+  command.stencil.mask = mask;
+
+  commands.push_back(command);
+
+  currentStencilMask = mask;
+}
\ No newline at end of file
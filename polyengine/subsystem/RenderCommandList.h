@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "subsystem/entities/Object.h"
+
+enum RenderCommandType {
+  SET_PIPELINE,
+  SET_INT,
+  SET_STENCIL_MASK,
+  SET_DRAW_CONSTANTS,
+  DRAW_OBJECT,
+  DRAW_INSTANCES
+};
+
+/**
+ * A single recorded render command. Pipelines and drawable objects
+ * are referred to by opaque handles, which only the video controller
+ * replaying a command list knows how to interpret.
+ */
+struct RenderCommand {
+  RenderCommandType type;
+
+  union {
+    struct {
+      const void* handle;
+      unsigned int variant;
+    } pipeline;
+
+    struct {
+      const char* name;
+      int value;
+    } uniform;
+
+    struct {
+      unsigned int mask;
+    } stencil;
+
+    struct {
+      int cascadeLimit;
+    } drawConstants;
+
+    struct {
+      void* handle;
+      const Object* object;
+      bool useShadowLod;
+      unsigned int firstInstance;
+      unsigned int totalInstances;
+    } draw;
+  };
+};
+
+/**
+ * Records render commands for a view without issuing anything to a
+ * graphics API, so separate views can be recorded on worker threads
+ * and replayed on the render thread afterward. Recording only reads
+ * scene state: draws restricted to a subset of an object's instances
+ * copy those instances' data into the command list, rather than
+ * changing which instances the object renders.
+ */
+class RenderCommandList {
+public:
+  void clear();
+  void draw(void* handle, const Object* object, bool useShadowLod);
+  void drawInstancesWhere(void* handle, const Object* object, bool useShadowLod, const std::function<bool(const Vec3f&)>& predicate);
+  const std::vector<RenderCommand>& getCommands() const;
+  const float* getInstanceColors(const RenderCommand& command) const;
+  const float* getInstanceMatrices(const RenderCommand& command) const;
+  const int* getInstanceObjectIds(const RenderCommand& command) const;
+  unsigned int getTotalConsideredInstances() const;
+  unsigned int getTotalDraws() const;
+  unsigned int getTotalDrawnInstances() const;
+  void setDrawConstants(int cascadeLimit);
+  void setInt(const char* name, int value);
+  bool setPipeline(const void* handle, unsigned int variant);
+  void setStencilMask(unsigned int mask);
+
+private:
+  std::vector<RenderCommand> commands;
+  std::vector<float> instanceMatrices;
+  std::vector<float> instanceColors;
+  std::vector<int> instanceObjectIds;
+  const void* currentPipeline = nullptr;
+  unsigned int currentVariant = 0;
+  int currentCascadeLimit = -1;
+  unsigned int currentStencilMask = 0xFFFFFFFF;
+  unsigned int totalDraws = 0;
+  unsigned int totalConsideredInstances = 0;
+  unsigned int totalDrawnInstances = 0;
+};
\ No newline at end of file
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+template<typename T>
+using ItemPredicate = std::function<bool(T*)>;
+
+/**
+ * Refers to an item in a SlotMap. Removing the item bumps its slot's
+ * generation, so that handles to it stop resolving even once the slot
+ * is reused for another item.
+ */
+struct SlotHandle {
+  constexpr static uint32_t NONE = 0xFFFFFFFF;
+
+  uint32_t slot = NONE;
+  uint32_t generation = 0;
+};
+
+/**
+ * A list of heap-allocated items with constant-time insertion and
+ * removal, by item or by handle. Items are packed densely for fast
+ * iteration, and removing one moves the last item into its place, so
+ * removals change the order of the remaining items.
+ *
+ * Items are found by address through an open-addressed index, which
+ * like the lists only grows, so that once a map has reached its peak
+ * size, adding and removing items never allocates.
+ */
+template<typename T>
+class SlotMap {
+public:
+  T* operator[](unsigned int index) const {
+    return items[index];
+  }
+
+  ~SlotMap() {
+    free();
+  }
+
+  typename std::vector<T*>::const_iterator begin() const {
+    return items.begin();
+  }
+
+  void clear() {
+    for (uint32_t slot : itemSlots) {
+      release(slot);
+    }
+
+    items.clear();
+    itemSlots.clear();
+    itemIndex.assign(itemIndex.size(), IndexEntry());
+  }
+
+  typename std::vector<T*>::const_iterator end() const {
+    return items.end();
+  }
+
+  void free() {
+    for (auto* item : items) {
+      delete item;
+    }
+
+    clear();
+  }
+
+  /**
+   * Returns the item a handle refers to, or nullptr if it has been
+   * removed since.
+   */
+  T* get(SlotHandle handle) const {
+    if (handle.slot >= slots.size() || slots[handle.slot].generation != handle.generation) {
+      return nullptr;
+    }
+
+    return items[slots[handle.slot].index];
+  }
+
+  SlotHandle getHandle(const T* item) const {
+    int position = findIndexEntry(item);
+
+    if (position == -1) {
+      return SlotHandle();
+    }
+
+    uint32_t slot = itemIndex[position].slot;
+
+    return { slot, slots[slot].generation };
+  }
+
+  unsigned int length() const {
+    return (unsigned int)items.size();
+  }
+
+  SlotHandle push(T* item) {
+    uint32_t slot;
+
+    if (freeSlots.size() > 0) {
+      slot = freeSlots.back();
+
+      freeSlots.pop_back();
+    } else {
+      slot = (uint32_t)slots.size();
+
+      slots.push_back(Slot());
+    }
+
+    slots[slot].index = (uint32_t)items.size();
+
+    insertIndexEntry(item, slot);
+
+    items.push_back(item);
+    itemSlots.push_back(slot);
+
+    return { slot, slots[slot].generation };
+  }
+
+  void remove(T* item) {
+    int position = findIndexEntry(item);
+
+    if (position != -1) {
+      removeAt(slots[itemIndex[position].slot].index);
+    }
+  }
+
+  void remove(SlotHandle handle) {
+    if (get(handle) != nullptr) {
+      removeAt(slots[handle.slot].index);
+    }
+  }
+
+  void removeWhere(ItemPredicate<T> predicate) {
+    unsigned int i = 0;
+
+    while (i < items.size()) {
+      if (predicate(items[i])) {
+        removeAt(i);
+      } else {
+        i++;
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+  };
+
+  struct IndexEntry {
+    const T* item = nullptr;
+    uint32_t slot = 0;
+  };
+
+  std::vector<T*> items;
+  std::vector<uint32_t> itemSlots;
+  std::vector<Slot> slots;
+  std::vector<uint32_t> freeSlots;
+  std::vector<IndexEntry> itemIndex;
+
+  /**
+   * Removes an index entry, shifting back any entries after it which
+   * would otherwise no longer be reachable from their home position.
+   */
+  void eraseIndexEntry(unsigned int position) {
+    unsigned int mask = (unsigned int)itemIndex.size() - 1;
+    unsigned int next = position;
+
+    while (true) {
+      next = (next + 1) & mask;
+
+      if (itemIndex[next].item == nullptr) {
+        break;
+      }
+
+      unsigned int home = getHomePosition(itemIndex[next].item);
+      bool isHomeBetween = position <= next
+        ? position < home && home <= next
+        : position < home || home <= next;
+
+      if (!isHomeBetween) {
+        itemIndex[position] = itemIndex[next];
+        position = next;
+      }
+    }
+
+    itemIndex[position] = IndexEntry();
+  }
+
+  int findIndexEntry(const T* item) const {
+    if (itemIndex.size() == 0) {
+      return -1;
+    }
+
+    unsigned int mask = (unsigned int)itemIndex.size() - 1;
+
+    for (unsigned int position = getHomePosition(item); itemIndex[position].item != nullptr; position = (position + 1) & mask) {
+      if (itemIndex[position].item == item) {
+        return (int)position;
+      }
+    }
+
+    return -1;
+  }
+
+  unsigned int getHomePosition(const T* item) const {
+    uint64_t hash = (uint64_t)(uintptr_t)item * 0x9E3779B97F4A7C15ull;
+
+    return (unsigned int)(hash >> 32) & ((unsigned int)itemIndex.size() - 1);
+  }
+
+  /**
+   * Doubles the index once it would become half full, keeping probe
+   * sequences short.
+   */
+  void growIndex() {
+    std::vector<IndexEntry> entries(std::max((unsigned int)itemIndex.size() * 2, 16u));
+
+    entries.swap(itemIndex);
+
+    for (auto& entry : entries) {
+      if (entry.item != nullptr) {
+        placeIndexEntry(entry.item, entry.slot);
+      }
+    }
+  }
+
+  void insertIndexEntry(const T* item, uint32_t slot) {
+    if ((items.size() + 1) * 2 > itemIndex.size()) {
+      growIndex();
+    }
+
+    placeIndexEntry(item, slot);
+  }
+
+  void placeIndexEntry(const T* item, uint32_t slot) {
+    unsigned int mask = (unsigned int)itemIndex.size() - 1;
+    unsigned int position = getHomePosition(item);
+
+    while (itemIndex[position].item != nullptr) {
+      position = (position + 1) & mask;
+    }
+
+    itemIndex[position] = { item, slot };
+  }
+
+  void release(uint32_t slot) {
+    slots[slot].generation++;
+
+    freeSlots.push_back(slot);
+  }
+
+  void removeAt(uint32_t index) {
+    uint32_t slot = itemSlots[index];
+    uint32_t lastIndex = (uint32_t)items.size() - 1;
+
+    eraseIndexEntry((unsigned int)findIndexEntry(items[index]));
+
+    if (index != lastIndex) {
+      items[index] = items[lastIndex];
+      itemSlots[index] = itemSlots[lastIndex];
+      slots[itemSlots[index]].index = index;
+    }
+
+    items.pop_back();
+    itemSlots.pop_back();
+
+    release(slot);
+  }
+};
\ No newline at end of file
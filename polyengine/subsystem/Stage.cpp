@@ -1,10 +1,70 @@
 #include <algorithm>
+#include <chrono>
 #include <typeinfo>
 
 #include "subsystem/Stage.h"
+#include "subsystem/JobSystem.h"
+#include "subsystem/PerformanceProfiler.h"
+#include "subsystem/ZoneProfiler.h"
 #include "subsystem/entities/Instance.h"
 
+constexpr static unsigned int ENTITY_UPDATE_BATCH_SIZE = 256;
+constexpr static unsigned int MATRIX_BATCH_SIZE = 1024;
+constexpr static unsigned int REHYDRATE_BATCH_SIZE = 64;
+
+template<typename T>
+static void updateEntities(SlotMap<T>& list, float dt) {
+  JobSystem::parallelFor(list.length(), ENTITY_UPDATE_BATCH_SIZE, [&](unsigned int start, unsigned int end) {
+    for (unsigned int i = start; i < end; i++) {
+      Entity* entity = list[i];
+
+      if (entity->onUpdate) {
+        entity->onUpdate(dt);
+      }
+    }
+  });
+}
+
+template<typename T>
+static void decayLifetimes(SlotMap<T>& list, float dt) {
+  for (unsigned int i = 0; i < list.length(); i++) {
+    Entity* entity = list[i];
+
+    if (entity->lifetime > 0.0f) {
+      entity->lifetime = std::max(entity->lifetime - dt, 0.0f);
+    }
+  }
+}
+
+/**
+ * Builds the graph of entity update jobs once, so that running it each
+ * frame doesn't allocate. The jobs read the time step of the update
+ * in progress.
+ */
+Stage::Stage() {
+  unsigned int objectUpdates = entityUpdates.add("Stage::updateObjects", [this]() {
+    updateEntities(objects, updateDt);
+  });
+
+  unsigned int lightUpdates = entityUpdates.add("Stage::updateLights", [this]() {
+    updateEntities(lights, updateDt);
+  });
+
+  entityUpdates.add("Stage::decayLifetimes", [this]() {
+    decayLifetimes(objects, updateDt);
+    decayLifetimes(lights, updateDt);
+  }, { objectUpdates, lightUpdates });
+}
+
 Stage::~Stage() {
+  // Removed entities are no longer in any list, and are only
+  // deleted once their removal events are dispatched
+  for (auto& event : entityEvents) {
+    if (event.type == EntityEvent::REMOVED) {
+      delete event.entity;
+    }
+  }
+
   objects.free();
   lights.free();
   actors.free();
@@ -13,19 +73,60 @@ Stage::~Stage() {
 }
 
 void Stage::add(Entity* entity) {
-  saveEntity(entity);
+  if (isUpdatingEntities) {
+    queueChange({ StageChange::ADD, "", nullptr, entity, nullptr });
 
-  if (entityAddedHandler) {
-    entityAddedHandler(entity);
+    return;
   }
+
+  saveEntity(entity);
+  notifyEntityAdded(entity);
 }
 
 void Stage::add(Actor* actor) {
+  if (isUpdatingEntities) {
+    queueChange({ StageChange::ADD, "", nullptr, nullptr, actor });
+
+    return;
+  }
+
   saveActor(actor);
 
   actor->onAdded();
 }
 
+/**
+ * Adds and removes everything queued while entities were updated, in
+ * the order it was queued.
+ */
+void Stage::applyQueuedChanges() {
+  for (auto& change : queuedChanges) {
+    if (change.type == StageChange::REMOVE) {
+      remove(change.entity);
+
+      continue;
+    }
+
+    if (change.entity != nullptr) {
+      saveEntity(change.entity);
+    } else if (change.actor != nullptr) {
+      saveActor(change.actor);
+    }
+
+    if (change.item != nullptr) {
+      store.try_emplace(std::move(change.name), change.item);
+    }
+
+    if (change.entity != nullptr) {
+      notifyEntityAdded(change.entity);
+    } else if (change.actor != nullptr) {
+      change.actor->onAdded();
+    }
+  }
+
+  queuedChanges.clear();
+}
+
 void Stage::saveActor(Actor* actor) {
   actor->setStage(this);
 
@@ -48,18 +149,60 @@ void Stage::saveEntity(Entity* entity) {
   }
 }
 
-const HeapList<Light>& Stage::getLights() const {
+/**
+ * Passes any entity events queued while deferred on to the handlers,
+ * in the order they occurred, and deletes removed entities.
+ */
+void Stage::dispatchEntityEvents() {
+  PROFILE_ZONE("Stage::dispatchEntityEvents");
+
+  for (auto& event : entityEvents) {
+    if (event.type == EntityEvent::ADDED) {
+      if (entityAddedHandler) {
+        entityAddedHandler(event.entity);
+      }
+    } else {
+      if (entityRemovedHandler) {
+        entityRemovedHandler(event.entity);
+      }
+
+      delete event.entity;
+    }
+  }
+
+  entityEvents.clear();
+}
+
+const SlotMap<Light>& Stage::getLights() const {
   return lights;
 }
 
-const HeapList<Object>& Stage::getObjects() const {
+const SlotMap<Object>& Stage::getObjects() const {
   return objects;
 }
 
+World& Stage::getWorld() {
+  return world;
+}
+
+const World& Stage::getWorld() const {
+  return world;
+}
+
 bool Stage::isActorRegistered(Actor* actor) {
   return registeredActorTypes.find(typeid(*actor).hash_code()) != registeredActorTypes.end();
 }
 
+void Stage::notifyEntityAdded(Entity* entity) {
+  PerformanceProfiler::trackCounter(ProfiledCounter::ENTITIES_ADDED);
+
+  if (areEntityEventsDeferred) {
+    entityEvents.push_back({ EntityEvent::ADDED, entity });
+  } else if (entityAddedHandler) {
+    entityAddedHandler(entity);
+  }
+}
+
 void Stage::onEntityAdded(Callback<Entity*> handler) {
   entityAddedHandler = handler;
 }
@@ -68,7 +211,40 @@ void Stage::onEntityRemoved(Callback<Entity*> handler) {
   entityRemovedHandler = handler;
 }
 
+void Stage::queueChange(const StageChange& change) {
+  std::lock_guard<std::mutex> lock(queuedChangesMutex);
+
+  queuedChanges.push_back(change);
+}
+
+/**
+ * Removes an entity from the stage. While entity events are deferred,
+ * the entity stops being updated immediately, but is only deleted
+ * once its removal event is dispatched, since the handler may still
+ * need to refer to it. Entities removed while entities are being
+ * updated are only removed once they're done.
+ */
 void Stage::remove(Entity* entity) {
+  if (isUpdatingEntities) {
+    queueChange({ StageChange::REMOVE, "", nullptr, entity, nullptr });
+
+    return;
+  }
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::ENTITIES_REMOVED);
+
+  if (areEntityEventsDeferred) {
+    if (entity->isOfType<Object>()) {
+      objects.remove((Object*)entity);
+    } else if (entity->isOfType<Light>()) {
+      lights.remove((Light*)entity);
+    }
+
+    entityEvents.push_back({ EntityEvent::REMOVED, entity });
+
+    return;
+  }
+
   if (entityRemovedHandler) {
     entityRemovedHandler(entity);
   }
@@ -101,32 +277,58 @@ void Stage::removeExpiredEntities() {
   removeExpired(lights);
 }
 
+/**
+ * Queues entity events rather than calling the handlers immediately,
+ * until the queue is dispatched, e.g. so that entities can be added
+ * and removed on a simulation thread while handlers only run while
+ * it's paused.
+ */
+void Stage::setEntityEventsDeferred(bool areEntityEventsDeferred) {
+  this->areEntityEventsDeferred = areEntityEventsDeferred;
+}
+
 void Stage::update(float dt) {
-  auto updateEntity = [=](Entity* entity) {
-    if (entity->onUpdate) {
-      entity->onUpdate(dt);
-    }
+  PROFILE_ZONE("Stage::update");
 
-    if (entity->lifetime > 0.0f) {
-      entity->lifetime = std::max(entity->lifetime - dt, 0.0f);
-    }
-  };
+  auto updateStart = std::chrono::high_resolution_clock::now();
 
   for (auto* actor : actors) {
     actor->update(dt);
   }
 
-  for (unsigned int i = 0; i < objects.length(); i++) {
-    updateEntity(objects[i]);
-  }
+  updateDt = dt;
+  isUpdatingEntities = true;
 
-  for (unsigned int i = 0; i < lights.length(); i++) {
-    updateEntity(lights[i]);
-  }
+  entityUpdates.run();
 
+  isUpdatingEntities = false;
+
+  applyQueuedChanges();
   removeExpiredEntities();
 
-  for (auto* object : objects) {
-    object->rehydrate();
-  }
+  world.update(dt);
+
+  auto rehydrateStart = std::chrono::high_resolution_clock::now();
+
+  // Instance matrices have to be up to date before their references'
+  // buffers are refreshed from them, so each pass waits on the last
+  JobSystem::parallelFor(objects.length(), MATRIX_BATCH_SIZE, [&](unsigned int start, unsigned int end) {
+    for (unsigned int i = start; i < end; i++) {
+      objects[i]->updateMatrix();
+    }
+  });
+
+  JobSystem::parallelFor(objects.length(), REHYDRATE_BATCH_SIZE, [&](unsigned int start, unsigned int end) {
+    for (unsigned int i = start; i < end; i++) {
+      objects[i]->rehydrate();
+    }
+  });
+
+  auto rehydrateEnd = std::chrono::high_resolution_clock::now();
+
+  std::chrono::duration<float, std::milli> updateTime = rehydrateStart - updateStart;
+  std::chrono::duration<float, std::milli> rehydrateTime = rehydrateEnd - rehydrateStart;
+
+  PerformanceProfiler::trackSubsystemTime(ProfiledSubsystem::STAGE_UPDATE, updateTime.count());
+  PerformanceProfiler::trackSubsystemTime(ProfiledSubsystem::REHYDRATE, rehydrateTime.count());
 }
\ No newline at end of file
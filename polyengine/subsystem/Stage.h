@@ -1,21 +1,77 @@
 #pragma once
 
 #include <vector>
-#include <functional>
 #include <string>
+#include <string_view>
 #include <map>
+#include <mutex>
 #include <set>
+#include <stdexcept>
 #include <type_traits>
 
 #include "subsystem/entities/Entity.h"
 #include "subsystem/entities/Light.h"
 #include "subsystem/entities/Object.h"
 #include "subsystem/entities/Actor.h"
-#include "subsystem/HeapList.h"
+#include "subsystem/ecs/World.h"
+#include "subsystem/InlineFunction.h"
+#include "subsystem/JobSystem.h"
+#include "subsystem/SlotMap.h"
 #include "subsystem/Types.h"
 
+/**
+ * An entity addition or removal, queued while entity events are
+ * deferred.
+ */
+struct EntityEvent {
+  enum EventType {
+    ADDED,
+    REMOVED
+  };
+
+  EventType type;
+  Entity* entity;
+};
+
+/**
+ * An addition or removal made while entities were being updated in
+ * parallel, applied once they're done. Additions keep the item as it
+ * was added, to store by name, alongside it as an entity or actor.
+ */
+struct StageChange {
+  enum ChangeType {
+    ADD,
+    REMOVE
+  };
+
+  ChangeType type;
+  std::string name;
+  void* item = nullptr;
+  Entity* entity = nullptr;
+  Actor* actor = nullptr;
+};
+
+/**
+ * Holds the entities and actors of a scene, and updates them each
+ * frame in phases: actors first, then entity update handlers and
+ * lifetimes, in parallel, and then once entities have been added and
+ * removed, object matrices and instance buffers, again in parallel.
+ *
+ * Since update handlers run concurrently, any entities or actors they
+ * add or remove only join or leave the stage once all of them are
+ * done. Additions still run their setup handler immediately.
+ *
+ * Alongside its entities, each stage has a World, for entities made
+ * of components instead, which is updated once entities have been
+ * added and removed.
+ *
+ * Entities and actors are allocated from pools, and setup and update
+ * handlers are stored inline, so that once a scene has warmed up,
+ * adding and expiring entities doesn't touch the general heap.
+ */
 class Stage {
 public:
+  Stage();
   ~Stage();
 
   void add(Entity* entity);
@@ -27,7 +83,7 @@ public:
   }
 
   template<typename T>
-  void add(std::function<void(T*)> handler) {
+  void add(InlineFunction<void(T*)> handler) {
     add<T>("__dummy__", handler);
   }
 
@@ -37,12 +93,20 @@ public:
   }
 
   template<typename T>
-  void add(std::string name, std::function<void(T*)> handler) {
+  void add(std::string name, InlineFunction<void(T*)> handler) {
     bool isEntity = std::is_base_of<Entity, T>::value;
     bool isActor = std::is_base_of<Actor, T>::value;
 
     T* t = new T();
 
+    if (isUpdatingEntities) {
+      handler(t);
+
+      queueChange({ StageChange::ADD, name, t, isEntity ? (Entity*)t : nullptr, isActor ? (Actor*)t : nullptr });
+
+      return;
+    }
+
     if (isEntity) {
       saveEntity((Entity*)t);
     } else if (isActor) {
@@ -51,19 +115,19 @@ public:
 
     handler(t);
 
-    store.emplace(name, t);
+    store.try_emplace(std::move(name), t);
 
-    if (isEntity && entityAddedHandler) {
-      entityAddedHandler((Entity*)t);
+    if (isEntity) {
+      notifyEntityAdded((Entity*)t);
     } else if (isActor) {
       ((Actor*)t)->onAdded();
     }
   }
 
   template<typename T, unsigned int total>
-  void addMultiple(std::function<void(T*, int)> handler) {
+  void addMultiple(InlineFunction<void(T*, int)> handler) {
     for (unsigned int i = 0; i < total; i++) {
-      add<T>([=](T* t) {
+      add<T>([&](T* t) {
         handler(t, i);
       });
     }
@@ -74,27 +138,52 @@ public:
     addMultiple<T, total>([](T* t, int index) {});
   }
 
+  /**
+   * Returns the item added under a name, throwing if there isn't one.
+   * Names are looked up without copying them.
+   */
   template<typename T = Object>
-  T* get(std::string name) {
-    return (T*)store.at(name);
+  T* get(std::string_view name) {
+    auto entry = store.find(name);
+
+    if (entry == store.end()) {
+      throw std::out_of_range("[Stage] Nothing stored as: " + std::string(name));
+    }
+
+    return (T*)entry->second;
   }
 
-  const HeapList<Light>& getLights() const;
-  const HeapList<Object>& getObjects() const;
+  void dispatchEntityEvents();
+  const SlotMap<Light>& getLights() const;
+  const SlotMap<Object>& getObjects() const;
+  World& getWorld();
+  const World& getWorld() const;
   void onEntityAdded(Callback<Entity*> handler);
   void onEntityRemoved(Callback<Entity*> handler);
   void remove(Entity* entity);
+  void setEntityEventsDeferred(bool areEntityEventsDeferred);
   void update(float dt);
 
 private:
-  HeapList<Object> objects;
-  HeapList<Light> lights;
-  HeapList<Actor> actors;
-  std::map<std::string, void*> store;
+  SlotMap<Object> objects;
+  SlotMap<Light> lights;
+  SlotMap<Actor> actors;
+  World world;
+  std::map<std::string, void*, std::less<>> store;
   std::set<std::size_t> registeredActorTypes;
   Callback<Entity*> entityAddedHandler = nullptr;
   Callback<Entity*> entityRemovedHandler = nullptr;
-
+  std::vector<EntityEvent> entityEvents;
+  bool areEntityEventsDeferred = false;
+  std::vector<StageChange> queuedChanges;
+  std::mutex queuedChangesMutex;
+  bool isUpdatingEntities = false;
+  JobGraph entityUpdates;
+  float updateDt = 0.0f;
+
+  void applyQueuedChanges();
+  void notifyEntityAdded(Entity* entity);
+  void queueChange(const StageChange& change);
   void saveActor(Actor* actor);
   void saveEntity(Entity* entity);
   bool isActorRegistered(Actor* actor);
@@ -3,6 +3,7 @@
 
 #include "SDL_image.h"
 #include "subsystem/Texture.h"
+#include "subsystem/MemoryTracker.h"
 
 Texture::Texture(std::string path) {
   this->path = path;
@@ -12,10 +13,16 @@ Texture::Texture(std::string path) {
 
   if (!surface) {
     printf("[Texture] Failed to load texture: %s\n", path);
+  } else {
+    MemoryTracker::trackAllocation(MemoryTag::CPU_TEXTURES, surface->h * surface->pitch);
   }
 }
 
 Texture::~Texture() {
+  if (surface != nullptr) {
+    MemoryTracker::trackFree(MemoryTag::CPU_TEXTURES, surface->h * surface->pitch);
+  }
+
   SDL_FreeSurface(surface);
 }
 
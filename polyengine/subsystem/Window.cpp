@@ -1,36 +1,44 @@
+#include <chrono>
 #include <cstdio>
 #include <cmath>
 
 #include "subsystem/Window.h"
 #include "subsystem/RNG.h"
 #include "subsystem/AbstractScene.h"
+#include "subsystem/JobSystem.h"
 #include "subsystem/PerformanceProfiler.h"
+#include "subsystem/ZoneProfiler.h"
 #include "SDL.h"
 
 Window::Window() {
-  SDL_Init(SDL_INIT_EVERYTHING);
-
   RNG::seed();
 }
 
 Window::~Window() {
+  JobSystem::stop();
+
   videoController->onDestroy();
 
   delete videoController;
+  delete gameController;
+  delete benchmark;
+
+  if (sdlWindow != nullptr) {
+    SDL_DestroyWindow(sdlWindow);
+  }
 
-  SDL_DestroyWindow(sdlWindow);
   SDL_Quit();
 }
 
 void Window::handleStats() {
-  char title[150];
+  char title[384];
 
   auto& profile = PerformanceProfiler::getProfile();
 
   sprintf_s(
     title,
     sizeof(title),
-    "FPS: %u (%u), Objects: %u, Verts/Tris: %u/%u, Lights/Shadowcasters: %u/%u, Draw calls: %u, GPU Memory: %u/%u MB",
+    "FPS: %u (%u), Objects: %u, Verts/Tris: %u/%u, Lights/Shadowcasters: %u/%u, Draw calls: %u, State changes: %u (%u skipped), Record/replay: %.2f/%.2f ms, GPU frame/cascades: %.2f/%.2f ms, Memory: CPU %u MB, GPU %u MB (driver: %u/%u MB)",
     profile.fps,
     profile.averageFps,
     profile.totalObjects,
@@ -39,20 +47,51 @@ void Window::handleStats() {
     profile.totalLights,
     profile.totalShadowCasters,
     profile.totalDrawCalls,
+    profile.totalStateChanges,
+    profile.totalSkippedStateChanges,
+    profile.commandRecordTime,
+    profile.commandReplayTime,
+    PerformanceProfiler::getGpuPassTime("frame"),
+    PerformanceProfiler::getGpuPassTime("shadow-cascades"),
+    profile.trackedCpuMemory,
+    profile.trackedGpuMemory,
     profile.usedGpuMemory,
     profile.totalGpuMemory
   );
 
-  SDL_SetWindowTitle(sdlWindow, title);
+  if (sdlWindow != nullptr) {
+    SDL_SetWindowTitle(sdlWindow, title);
+  }
+}
+
+/**
+ * Registers a handler called at the end of each frame with the
+ * index of the frame, e.g. to sample the frame's profile.
+ */
+void Window::onFrameEnd(Callback<unsigned int> handler) {
+  frameEndHandler = handler;
 }
 
 void Window::open(const char* title, Region2d<unsigned int> region) {
+  SDL_Init(SDL_INIT_EVERYTHING);
+
   Window::size = { region.width, region.height };
   Uint32 flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
 
   sdlWindow = SDL_CreateWindow(title, region.x, region.y, region.width, region.height, flags);
 }
 
+/**
+ * Runs without an SDL window or video subsystem, for machines with
+ * no display. Video controllers are initialized without a window,
+ * and should either render offscreen or not at all.
+ */
+void Window::openHeadless(Area<unsigned int> area) {
+  SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS);
+
+  Window::size = area;
+}
+
 void Window::pollEvents() {
   SDL_Event event;
 
@@ -77,6 +116,8 @@ void Window::pollEvents() {
           videoController->toggleFullScreen(sdlWindow);
         }
 
+        videoController->onKeyDown(event.key.keysym.sym);
+
         break;
       default:
         break;
@@ -88,28 +129,79 @@ void Window::pollEvents() {
 
 void Window::run() {
   gameController->handleSceneChange([&](AbstractScene* scene) {
-    videoController->setScene(scene);
+    // Scenes changed while simulating on another thread are only
+    // handed to the video controller once simulation is paused
+    if (isSimulating) {
+      pendingScene = scene;
+    } else {
+      videoController->setScene(scene);
+    }
   });
 
+  // Benchmarks are always run on one thread, to stay deterministic
+  if (benchmark != nullptr) {
+    isPipelined = false;
+  } else {
+    JobSystem::start();
+  }
+
+  videoController->setPipelined(isPipelined);
+
+  if (benchmark != nullptr) {
+    RNG::seed(benchmark->getSeed());
+  }
+
   gameController->onInit();
 
-  int lastTick = SDL_GetTicks();
+  ZoneProfiler::setThreadName("Main");
+
+  unsigned int totalFrames = 0;
+  float startTime = framePacer.getElapsedTime();
+
+  framePacer.beginFrame();
 
   while (!didCloseWindow) {
-    float dt = (SDL_GetTicks() - lastTick) / 1000.0f;
+    PROFILE_ZONE("Frame");
 
-    lastTick = SDL_GetTicks();
+    float dt = framePacer.beginFrame();
 
     PerformanceProfiler::trackFrameStart();
 
     pollEvents();
-    gameController->getActiveScene()->update(dt);
-    videoController->onRender(sdlWindow);
+
+    if (benchmark != nullptr) {
+      runBenchmarkFrame();
+    } else if (isPipelined) {
+      runPipelinedFrame(dt);
+    } else {
+      gameController->getActiveScene()->update(dt);
+      videoController->onPrepareFrame();
+      videoController->onRender(sdlWindow);
+    }
 
     PerformanceProfiler::trackFrameEnd();
 
     handleStats();
-    SDL_Delay(1);
+
+    if (frameEndHandler) {
+      frameEndHandler(totalFrames);
+    }
+
+    if (frameLimit > 0 && ++totalFrames == frameLimit) {
+      printf("[Window] Ran %u frames in %.0f ms\n", totalFrames, framePacer.getElapsedTime() - startTime);
+
+      for (auto& pass : PerformanceProfiler::getProfile().gpuPassTimes) {
+        printf("[Window] GPU pass %s: %.3f ms average\n", pass.name.c_str(), pass.averageTime);
+      }
+
+      if (benchmark != nullptr) {
+        benchmark->writeResults();
+      }
+
+      break;
+    }
+
+    framePacer.waitForNextFrame();
   }
 }
 
@@ -117,6 +209,120 @@ void Window::setGameController(AbstractGameController* gameController) {
   this->gameController = gameController;
 }
 
+/**
+ * Advances the active scene by the benchmark's fixed time step, with
+ * its scripted input and camera path, and samples the frame.
+ */
+void Window::runBenchmarkFrame() {
+  auto* scene = gameController->getActiveScene();
+
+  benchmark->dispatchEvents(scene);
+
+  auto updateStart = std::chrono::high_resolution_clock::now();
+
+  scene->update(benchmark->getTimeStep());
+  benchmark->updateCamera(scene);
+
+  auto renderStart = std::chrono::high_resolution_clock::now();
+
+  videoController->onPrepareFrame();
+  videoController->onRender(sdlWindow);
+
+  auto renderEnd = std::chrono::high_resolution_clock::now();
+
+  std::chrono::duration<float, std::milli> updateTime = renderStart - updateStart;
+  std::chrono::duration<float, std::milli> renderTime = renderEnd - renderStart;
+
+  benchmark->trackFrame(updateTime.count(), renderTime.count());
+}
+
+/**
+ * Renders the frame prepared at the end of the previous one, while
+ * the next is simulated as a job on one of the JobSystem's workers.
+ * Once both are done, and nothing else is touching the scene, entity
+ * events and any scene change from the simulation are passed on to
+ * the video controller, which then prepares the next frame. Frames
+ * thus take about as long as the slower of simulating and rendering,
+ * plus preparation, rather than both in sequence; in exchange, what's
+ * on screen trails the simulation by a frame.
+ */
+void Window::runPipelinedFrame(float dt) {
+  auto* scene = gameController->getActiveScene();
+
+  scene->setEntityEventsDeferred(true);
+
+  isSimulating = true;
+
+  JobCounter simulation;
+
+  JobSystem::run([=]() {
+    PROFILE_ZONE("Window::simulate");
+
+    scene->update(dt);
+  }, simulation);
+
+  if (hasPreparedFrame) {
+    videoController->onRender(sdlWindow);
+  }
+
+  {
+    PROFILE_ZONE("Window::waitForSimulation");
+
+    JobSystem::wait(simulation);
+  }
+
+  isSimulating = false;
+
+  if (pendingScene != nullptr) {
+    // Flush events queued from before the scene was last
+    // active, since changing scenes picks up all its entities
+    pendingScene->dispatchEntityEvents();
+    videoController->setScene(pendingScene);
+
+    pendingScene = nullptr;
+  }
+
+  gameController->getActiveScene()->dispatchEntityEvents();
+  videoController->onPrepareFrame();
+
+  hasPreparedFrame = true;
+}
+
+/**
+ * Runs the game from a benchmark script rather than live input, and
+ * for exactly as many frames as the script needs. The Window takes
+ * ownership of the benchmark.
+ */
+void Window::setBenchmark(Benchmark* benchmark) {
+  this->benchmark = benchmark;
+
+  setFrameLimit(benchmark->getTotalFrames());
+}
+
+/**
+ * Stops running after a fixed number of frames, or never if 0.
+ */
+void Window::setFrameLimit(unsigned int frameLimit) {
+  this->frameLimit = frameLimit;
+}
+
+/**
+ * Simulates each frame on another thread while the previous frame is
+ * rendered. See runPipelinedFrame().
+ */
+void Window::setPipelined(bool isPipelined) {
+  this->isPipelined = isPipelined;
+}
+
+/**
+ * Holds frames to the given rate, or runs as fast as possible if 0,
+ * as by default. Benchmarks and headless runs should leave this
+ * unset, since any waiting would distort measured frame times.
+ */
+void Window::setTargetFrameRate(unsigned int framesPerSecond) {
+  framePacer.setTargetFrameRate(framesPerSecond);
+}
+
 void Window::setVideoController(AbstractVideoController* videoController) {
   if (this->videoController != nullptr) {
     this->videoController->onDestroy();
@@ -4,8 +4,11 @@
 #include "Math.h"
 #include "subsystem/AbstractVideoController.h"
 #include "subsystem/AbstractGameController.h"
+#include "subsystem/Benchmark.h"
+#include "subsystem/FramePacer.h"
 #include "subsystem/InputSystem.h"
 #include "subsystem/Math.h"
+#include "subsystem/Types.h"
 
 class Window {
 public:
@@ -15,16 +18,32 @@ public:
   static Area<unsigned int> size;
 
   void open(const char* title, Region2d<unsigned int> region);
+  void onFrameEnd(Callback<unsigned int> handler);
+  void openHeadless(Area<unsigned int> area);
   void run();
+  void setBenchmark(Benchmark* benchmark);
+  void setFrameLimit(unsigned int frameLimit);
   void setGameController(AbstractGameController* gameController);
+  void setPipelined(bool isPipelined);
+  void setTargetFrameRate(unsigned int framesPerSecond);
   void setVideoController(AbstractVideoController* videoController);
 
 private:
   bool didCloseWindow = false;
+  bool isPipelined = false;
+  bool isSimulating = false;
+  bool hasPreparedFrame = false;
+  unsigned int frameLimit = 0;
   SDL_Window* sdlWindow = nullptr;
   AbstractVideoController* videoController = nullptr;
   AbstractGameController* gameController = nullptr;
+  Benchmark* benchmark = nullptr;
+  AbstractScene* pendingScene = nullptr;
+  FramePacer framePacer;
+  Callback<unsigned int> frameEndHandler = nullptr;
 
   void handleStats();
   void pollEvents();
+  void runBenchmarkFrame();
+  void runPipelinedFrame(float dt);
 };
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include "subsystem/ZoneProfiler.h"
+
+/**
+ * Claims a buffer for the current thread on its first zone, and gives
+ * it back when the thread exits. Short-lived threads therefore reuse
+ * the buffers of earlier ones rather than allocating their own, though
+ * each still gets its own track.
+ */
+struct ZoneBufferOwner {
+  ZoneBuffer* buffer = nullptr;
+
+  ~ZoneBufferOwner() {
+    if (buffer != nullptr) {
+      ZoneProfiler::releaseThreadBuffer(buffer);
+    }
+  }
+};
+
+static thread_local ZoneBufferOwner threadBufferOwner;
+
+static std::string escapeJson(const std::string& value) {
+  std::string escaped;
+
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+
+    escaped += c;
+  }
+
+  return escaped;
+}
+
+std::atomic<bool> ZoneProfiler::isRunning = false;
+std::atomic<uint64_t> ZoneProfiler::origin = 0;
+std::mutex ZoneProfiler::buffersMutex;
+std::set<std::string> ZoneProfiler::internedNames;
+std::vector<ZoneBuffer*> ZoneProfiler::buffers;
+std::vector<ZoneBuffer*> ZoneProfiler::freeBuffers;
+std::vector<std::string> ZoneProfiler::trackNames;
+
+/**
+ * Adds a named track and returns its id. Must be called while holding
+ * the buffers mutex.
+ */
+unsigned int ZoneProfiler::addTrack(const std::string& name) {
+  trackNames.push_back(name);
+
+  return (unsigned int)trackNames.size();
+}
+
+void ZoneProfiler::beginZone() {
+  getThreadBuffer()->depth++;
+}
+
+/**
+ * Creates a track for zones which aren't timed on any one thread,
+ * e.g. GPU work, shown alongside the thread timelines.
+ */
+ZoneBuffer* ZoneProfiler::createTrack(const char* name) {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  ZoneBuffer* buffer = new ZoneBuffer();
+
+  buffer->threadId = addTrack(name);
+
+  buffers.push_back(buffer);
+
+  return buffer;
+}
+
+void ZoneProfiler::endZone(const char* name, uint64_t start) {
+  ZoneBuffer* buffer = getThreadBuffer();
+
+  buffer->depth--;
+
+  recordZone(buffer, name, start, now(), buffer->depth);
+}
+
+ZoneBuffer* ZoneProfiler::getThreadBuffer() {
+  if (threadBufferOwner.buffer == nullptr) {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    ZoneBuffer* buffer;
+
+    if (freeBuffers.size() > 0) {
+      buffer = freeBuffers.back();
+
+      freeBuffers.pop_back();
+    } else {
+      buffer = new ZoneBuffer();
+
+      buffers.push_back(buffer);
+    }
+
+    // Reused buffers get a new track too, so that neither the previous
+    // thread's name nor its events carry over to this one
+    buffer->threadId = addTrack("Thread " + std::to_string(trackNames.size() + 1));
+
+    threadBufferOwner.buffer = buffer;
+  }
+
+  return threadBufferOwner.buffer;
+}
+
+/**
+ * Returns a copy of a name which lives as long as the profiler, for
+ * naming zones after strings which may not.
+ */
+const char* ZoneProfiler::internName(const std::string& name) {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+
+  return internedNames.insert(name).first->c_str();
+}
+
+bool ZoneProfiler::isEnabled() {
+  return isRunning.load(std::memory_order_relaxed);
+}
+
+uint64_t ZoneProfiler::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()
+  ).count();
+}
+
+void ZoneProfiler::recordZone(ZoneBuffer* buffer, const char* name, uint64_t start, uint64_t end, unsigned int depth) {
+  uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  ZoneEvent& event = buffer->events[head % ZoneBuffer::SIZE];
+
+  event.name = name;
+  event.start = start;
+  event.end = end;
+  event.depth = depth;
+  event.threadId = buffer->threadId;
+
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void ZoneProfiler::releaseThreadBuffer(ZoneBuffer* buffer) {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+
+  buffer->depth = 0;
+
+  freeBuffers.push_back(buffer);
+}
+
+void ZoneProfiler::setThreadName(const char* name) {
+  ZoneBuffer* buffer = getThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffersMutex);
+
+  trackNames[buffer->threadId - 1] = name;
+}
+
+/**
+ * Starts recording zones, discarding any recorded previously. Must not
+ * be called while zones are being recorded on other threads.
+ */
+void ZoneProfiler::start() {
+  {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    for (auto* buffer : buffers) {
+      buffer->head.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  origin.store(now(), std::memory_order_relaxed);
+  isRunning.store(true, std::memory_order_release);
+}
+
+void ZoneProfiler::stop() {
+  isRunning.store(false, std::memory_order_release);
+}
+
+/**
+ * Writes the most recent zones recorded on each thread as complete
+ * ("X") trace events, with times in microseconds since the profiler
+ * was started. Should be called once recording threads are idle,
+ * since a buffer which wraps around during export may yield a few
+ * mixed-up events.
+ */
+bool ZoneProfiler::writeTrace(const char* path) {
+  std::ofstream trace(path);
+
+  if (!trace.is_open()) {
+    printf("[ZoneProfiler] Unable to write trace: %s\n", path);
+
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  uint64_t traceOrigin = origin.load(std::memory_order_relaxed);
+  unsigned int totalEvents = 0;
+  char line[512];
+
+  trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+  trace << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Polygarden\"}}";
+
+  for (unsigned int i = 0; i < trackNames.size(); i++) {
+    snprintf(line, sizeof(line), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", i + 1, escapeJson(trackNames[i]).c_str());
+
+    trace << line;
+  }
+
+  for (auto* buffer : buffers) {
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t total = std::min(head, (uint64_t)ZoneBuffer::SIZE);
+    std::vector<ZoneEvent> events;
+
+    for (uint64_t i = head - total; i < head; i++) {
+      events.push_back(buffer->events[i % ZoneBuffer::SIZE]);
+    }
+
+    // Zones are stored in the order they ended, which puts children
+    // ahead of their parents; viewers expect parents first
+    std::sort(events.begin(), events.end(), [](const ZoneEvent& a, const ZoneEvent& b) {
+      return a.start == b.start ? a.depth < b.depth : a.start < b.start;
+    });
+
+    for (auto& event : events) {
+      if (event.start < traceOrigin) {
+        continue;
+      }
+
+      snprintf(
+        line,
+        sizeof(line),
+        ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+        escapeJson(event.name).c_str(),
+        event.threadId,
+        (event.start - traceOrigin) / 1000.0,
+        (event.end - event.start) / 1000.0
+      );
+
+      trace << line;
+      totalEvents++;
+    }
+  }
+
+  trace << "\n]}\n";
+
+  printf("[ZoneProfiler] Wrote %u zones to %s\n", totalEvents, path);
+
+  return true;
+}
\ No newline at end of file
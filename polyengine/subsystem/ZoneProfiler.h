@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#define PROFILE_ZONE_CONCAT_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_INNER(a, b)
+
+/**
+ * Profiles the enclosing scope as a zone with the given name, which
+ * must be a string literal or otherwise outlive the profiler. Names
+ * built at runtime can be made to outlive it with internName().
+ */
+#define PROFILE_ZONE(name) ScopedZone PROFILE_ZONE_CONCAT(__zone, __LINE__)(name)
+
+/**
+ * A completed zone, with start and end times in steady clock
+ * nanoseconds, its nesting depth on its thread, and the track it was
+ * recorded on.
+ */
+struct ZoneEvent {
+  const char* name = nullptr;
+  uint64_t start = 0;
+  uint64_t end = 0;
+  unsigned int depth = 0;
+  unsigned int threadId = 0;
+};
+
+/**
+ * A fixed-size ring of the most recent zones completed on one thread,
+ * or on one track, such as the GPU timeline. Only one thread writes
+ * to it at a time, publishing each event by advancing the head, so
+ * recording never takes a lock. Buffers are handed on to new threads
+ * once their thread exits, each of which records on a track of its
+ * own, so events keep the track they were recorded on.
+ */
+struct ZoneBuffer {
+  constexpr static unsigned int SIZE = 65536;
+
+  unsigned int threadId = 0;
+  std::atomic<uint64_t> head = 0;
+  unsigned int depth = 0;
+  ZoneEvent events[SIZE];
+};
+
+/**
+ * Records nested, high-resolution CPU timing zones on any thread, and
+ * exports them as a Chrome trace which can be opened in
+ * chrome://tracing or Perfetto. While stopped, a zone costs a single
+ * relaxed atomic load.
+ */
+class ZoneProfiler {
+public:
+  static void beginZone();
+  static ZoneBuffer* createTrack(const char* name);
+  static void endZone(const char* name, uint64_t start);
+  static const char* internName(const std::string& name);
+  static bool isEnabled();
+  static uint64_t now();
+  static void recordZone(ZoneBuffer* buffer, const char* name, uint64_t start, uint64_t end, unsigned int depth);
+  static void setThreadName(const char* name);
+  static void start();
+  static void stop();
+  static bool writeTrace(const char* path);
+
+private:
+  static std::atomic<bool> isRunning;
+  static std::atomic<uint64_t> origin;
+  static std::mutex buffersMutex;
+  static std::set<std::string> internedNames;
+  static std::vector<ZoneBuffer*> buffers;
+  static std::vector<ZoneBuffer*> freeBuffers;
+  static std::vector<std::string> trackNames;
+
+  static unsigned int addTrack(const std::string& name);
+  static ZoneBuffer* getThreadBuffer();
+  static void releaseThreadBuffer(ZoneBuffer* buffer);
+
+  friend struct ZoneBufferOwner;
+};
+
+/**
+ * Times its own lifetime as a zone. Zones opened while the profiler
+ * is stopped are never recorded, even if it starts before they end.
+ */
+class ScopedZone {
+public:
+  ScopedZone(const char* name) {
+    if (ZoneProfiler::isEnabled()) {
+      this->name = name;
+      start = ZoneProfiler::now();
+
+      ZoneProfiler::beginZone();
+    }
+  }
+
+  ~ScopedZone() {
+    if (name != nullptr) {
+      ZoneProfiler::endZone(name, start);
+    }
+  }
+
+private:
+  const char* name = nullptr;
+  uint64_t start = 0;
+};
\ No newline at end of file
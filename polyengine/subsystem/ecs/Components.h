@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+
+#include "subsystem/entities/Light.h"
+#include "subsystem/Math.h"
+
+class Object;
+
+enum ComponentType {
+  TRANSFORM_COMPONENT,
+  RENDER_INSTANCE_COMPONENT,
+  LIGHT_COMPONENT,
+  LIFETIME_COMPONENT,
+  VELOCITY_COMPONENT,
+  TWEEN_COMPONENT,
+  TOTAL_COMPONENT_TYPES
+};
+
+/**
+ * A set of component types, one bit per type.
+ */
+typedef uint32_t ComponentMask;
+
+/**
+ * Components are plain data, and are moved between archetypes and
+ * chunks with memcpy, so must all be trivially copyable. Each names
+ * its own type, which is how World finds its column.
+ */
+struct TransformComponent {
+  constexpr static ComponentType TYPE = ComponentType::TRANSFORM_COMPONENT;
+
+  Vec3f position;
+  Vec3f orientation;
+  Vec3f scale = Vec3f(1.0f);
+};
+
+/**
+ * Renders an entity as an instance of a reference object, which must
+ * outlive the entity. The matrix is computed from the entity's
+ * transform on each World update.
+ */
+struct RenderInstanceComponent {
+  constexpr static ComponentType TYPE = ComponentType::RENDER_INSTANCE_COMPONENT;
+
+  Object* reference = nullptr;
+  Vec3f color = Vec3f(1.0f);
+  Matrix4 matrix = Matrix4::identity();
+};
+
+/**
+ * A light positioned at the entity's transform. Lights made of
+ * components can't cast shadows.
+ */
+struct LightComponent {
+  constexpr static ComponentType TYPE = ComponentType::LIGHT_COMPONENT;
+
+  Light::LightType type = Light::LightType::POINT;
+  Vec3f color = Vec3f(1.0f);
+  Vec3f direction;
+  float radius = 100.0f;
+  float power = 1.0f;
+};
+
+/**
+ * Destroys the entity once the remaining time runs out.
+ */
+struct LifetimeComponent {
+  constexpr static ComponentType TYPE = ComponentType::LIFETIME_COMPONENT;
+
+  float remaining = 0.0f;
+};
+
+struct VelocityComponent {
+  constexpr static ComponentType TYPE = ComponentType::VELOCITY_COMPONENT;
+
+  Vec3f velocity;
+  Vec3f acceleration;
+};
+
+/**
+ * Scales the entity's transform from one scale to another over the
+ * duration, optionally eased, holding the final scale once done.
+ */
+struct TweenComponent {
+  constexpr static ComponentType TYPE = ComponentType::TWEEN_COMPONENT;
+
+  Vec3f fromScale = Vec3f(0.0f);
+  Vec3f toScale = Vec3f(1.0f);
+  float elapsed = 0.0f;
+  float duration = 1.0f;
+  float (*easing)(float t) = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,397 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "subsystem/ecs/World.h"
+#include "subsystem/entities/Object.h"
+#include "subsystem/ZoneProfiler.h"
+
+constexpr static unsigned int CHUNK_BYTES = 16 * 1024;
+
+/**
+ * Sizes, alignments and default constructors of each component type,
+ * indexed by type, so that chunks can be managed without knowing the
+ * types.
+ */
+struct ComponentInfo {
+  unsigned int size;
+  unsigned int alignment;
+  void (*construct)(void* destination);
+};
+
+template<typename T>
+static void constructComponent(void* destination) {
+  static_assert(std::is_trivially_copyable<T>::value, "Components must be trivially copyable");
+  static_assert(alignof(T) <= alignof(std::max_align_t), "Components can't be over-aligned");
+
+  new (destination) T();
+}
+
+const static ComponentInfo COMPONENT_INFO[] = {
+  { sizeof(TransformComponent), alignof(TransformComponent), constructComponent<TransformComponent> },
+  { sizeof(RenderInstanceComponent), alignof(RenderInstanceComponent), constructComponent<RenderInstanceComponent> },
+  { sizeof(LightComponent), alignof(LightComponent), constructComponent<LightComponent> },
+  { sizeof(LifetimeComponent), alignof(LifetimeComponent), constructComponent<LifetimeComponent> },
+  { sizeof(VelocityComponent), alignof(VelocityComponent), constructComponent<VelocityComponent> },
+  { sizeof(TweenComponent), alignof(TweenComponent), constructComponent<TweenComponent> }
+};
+
+static_assert(sizeof(COMPONENT_INFO) / sizeof(ComponentInfo) == ComponentType::TOTAL_COMPONENT_TYPES, "Every component type needs its info");
+
+static bool hasComponent(ComponentMask mask, unsigned int type) {
+  return (mask & (1u << type)) != 0;
+}
+
+static uint8_t* getComponent(ArchetypeChunk* chunk, unsigned int type, unsigned int row) {
+  return chunk->data + chunk->archetype->columnOffsets[type] + row * COMPONENT_INFO[type].size;
+}
+
+static void deleteChunk(ArchetypeChunk* chunk) {
+  delete[] chunk->data;
+  delete[] chunk->entities;
+  delete chunk;
+}
+
+World::~World() {
+  for (auto* archetype : archetypes) {
+    for (auto* chunk : archetype->chunks) {
+      deleteChunk(chunk);
+    }
+
+    if (archetype->spareChunk != nullptr) {
+      deleteChunk(archetype->spareChunk);
+    }
+
+    delete archetype;
+  }
+}
+
+EntityHandle World::createEntity(ComponentMask mask) {
+  uint32_t slot;
+
+  if (freeRecords.size() > 0) {
+    slot = freeRecords.back();
+
+    freeRecords.pop_back();
+  } else {
+    slot = (uint32_t)records.size();
+
+    records.push_back(EntityRecord());
+  }
+
+  EntityHandle entity = { slot, records[slot].generation };
+
+  insertRow(getArchetype(mask), entity);
+
+  totalEntities++;
+
+  return entity;
+}
+
+/**
+ * Queues an entity to be destroyed on the next update, once systems
+ * are no longer iterating over it.
+ */
+void World::destroy(EntityHandle entity) {
+  pendingDestroys.push_back(entity);
+}
+
+void World::destroyPendingEntities() {
+  for (auto entity : pendingDestroys) {
+    if (!isAlive(entity)) {
+      continue;
+    }
+
+    auto& record = records[entity.slot];
+
+    removeRow(record.chunk, record.row);
+
+    record.chunk = nullptr;
+    record.generation++;
+
+    freeRecords.push_back(entity.slot);
+    totalEntities--;
+  }
+
+  pendingDestroys.clear();
+}
+
+/**
+ * Finds the archetype for a set of component types, creating it if
+ * there isn't one yet. Chunks are sized to about 16KB, with a column
+ * per component type, each starting at its type's alignment.
+ */
+Archetype* World::getArchetype(ComponentMask mask) {
+  for (auto* archetype : archetypes) {
+    if (archetype->mask == mask) {
+      return archetype;
+    }
+  }
+
+  Archetype* archetype = new Archetype();
+
+  archetype->mask = mask;
+
+  unsigned int rowSize = 0;
+  unsigned int maxPadding = 0;
+
+  for (unsigned int type = 0; type < ComponentType::TOTAL_COMPONENT_TYPES; type++) {
+    if (hasComponent(mask, type)) {
+      rowSize += COMPONENT_INFO[type].size;
+      maxPadding += COMPONENT_INFO[type].alignment - 1;
+    }
+  }
+
+  archetype->chunkCapacity = std::max((CHUNK_BYTES - maxPadding) / std::max(rowSize, 1u), 1u);
+
+  unsigned int offset = 0;
+
+  for (unsigned int type = 0; type < ComponentType::TOTAL_COMPONENT_TYPES; type++) {
+    if (hasComponent(mask, type)) {
+      unsigned int alignment = COMPONENT_INFO[type].alignment;
+
+      offset = (offset + alignment - 1) / alignment * alignment;
+
+      archetype->columnOffsets[type] = offset;
+
+      offset += archetype->chunkCapacity * COMPONENT_INFO[type].size;
+    }
+  }
+
+  archetype->chunkBytes = offset;
+
+  archetypes.push_back(archetype);
+
+  return archetype;
+}
+
+/**
+ * Returns the lights made of components, as of the last update.
+ */
+const std::vector<Light>& World::getLights() const {
+  return lights;
+}
+
+ComponentMask World::getMask(EntityHandle entity) const {
+  return isAlive(entity) ? records[entity.slot].chunk->archetype->mask : 0;
+}
+
+unsigned int World::getTotalEntities() const {
+  return totalEntities;
+}
+
+/**
+ * Appends a row of default components for an entity to the last chunk
+ * of an archetype, adding a chunk if the last one is full, which is
+ * the spare chunk if there is one.
+ */
+void World::insertRow(Archetype* archetype, EntityHandle entity) {
+  if (archetype->chunks.size() == 0 || archetype->chunks.back()->total == archetype->chunkCapacity) {
+    ArchetypeChunk* chunk = archetype->spareChunk;
+
+    if (chunk != nullptr) {
+      archetype->spareChunk = nullptr;
+    } else {
+      chunk = new ArchetypeChunk();
+
+      chunk->archetype = archetype;
+      chunk->data = new uint8_t[archetype->chunkBytes];
+      chunk->entities = new EntityHandle[archetype->chunkCapacity];
+    }
+
+    archetype->chunks.push_back(chunk);
+  }
+
+  ArchetypeChunk* chunk = archetype->chunks.back();
+  unsigned int row = chunk->total++;
+
+  for (unsigned int type = 0; type < ComponentType::TOTAL_COMPONENT_TYPES; type++) {
+    if (hasComponent(archetype->mask, type)) {
+      COMPONENT_INFO[type].construct(getComponent(chunk, type, row));
+    }
+  }
+
+  chunk->entities[row] = entity;
+
+  records[entity.slot].chunk = chunk;
+  records[entity.slot].row = row;
+}
+
+bool World::isAlive(EntityHandle entity) const {
+  return (
+    entity.slot < records.size() &&
+    records[entity.slot].generation == entity.generation &&
+    records[entity.slot].chunk != nullptr
+  );
+}
+
+/**
+ * Moves an entity to the archetype for a new set of component types,
+ * keeping the components it still has, and defaulting any new ones.
+ */
+void World::migrate(EntityHandle entity, ComponentMask mask) {
+  if (!isAlive(entity) || records[entity.slot].chunk->archetype->mask == mask) {
+    return;
+  }
+
+  EntityRecord previous = records[entity.slot];
+  ComponentMask sharedMask = previous.chunk->archetype->mask & mask;
+
+  insertRow(getArchetype(mask), entity);
+
+  auto& record = records[entity.slot];
+
+  for (unsigned int type = 0; type < ComponentType::TOTAL_COMPONENT_TYPES; type++) {
+    if (hasComponent(sharedMask, type)) {
+      memcpy(getComponent(record.chunk, type, record.row), getComponent(previous.chunk, type, previous.row), COMPONENT_INFO[type].size);
+    }
+  }
+
+  removeRow(previous.chunk, previous.row);
+}
+
+/**
+ * Removes a row by moving the archetype's last row into its place,
+ * keeping chunks packed. Once the last chunk is empty, it becomes the
+ * spare chunk, or is freed if there already is one.
+ */
+void World::removeRow(ArchetypeChunk* chunk, unsigned int row) {
+  Archetype* archetype = chunk->archetype;
+  ArchetypeChunk* lastChunk = archetype->chunks.back();
+  unsigned int lastRow = lastChunk->total - 1;
+
+  if (chunk != lastChunk || row != lastRow) {
+    EntityHandle movedEntity = lastChunk->entities[lastRow];
+
+    for (unsigned int type = 0; type < ComponentType::TOTAL_COMPONENT_TYPES; type++) {
+      if (hasComponent(archetype->mask, type)) {
+        memcpy(getComponent(chunk, type, row), getComponent(lastChunk, type, lastRow), COMPONENT_INFO[type].size);
+      }
+    }
+
+    chunk->entities[row] = movedEntity;
+
+    records[movedEntity.slot].chunk = chunk;
+    records[movedEntity.slot].row = row;
+  }
+
+  if (--lastChunk->total == 0) {
+    archetype->chunks.pop_back();
+
+    if (archetype->spareChunk == nullptr) {
+      archetype->spareChunk = lastChunk;
+    } else {
+      deleteChunk(lastChunk);
+    }
+  }
+}
+
+void World::update(float dt) {
+  PROFILE_ZONE("World::update");
+
+  updateVelocities(dt);
+  updateTweens(dt);
+  updateLifetimes(dt);
+  destroyPendingEntities();
+  updateMatrices();
+  updateRenderInstances();
+  updateLights();
+}
+
+void World::updateLifetimes(float dt) {
+  each<LifetimeComponent>([&](unsigned int total, const EntityHandle* entities, LifetimeComponent* lifetimes) {
+    for (unsigned int i = 0; i < total; i++) {
+      lifetimes[i].remaining -= dt;
+
+      if (lifetimes[i].remaining <= 0.0f) {
+        pendingDestroys.push_back(entities[i]);
+      }
+    }
+  });
+}
+
+void World::updateLights() {
+  unsigned int totalLights = 0;
+  unsigned int index = 0;
+
+  each<TransformComponent, LightComponent>([&](unsigned int total, const EntityHandle* entities, TransformComponent* transforms, LightComponent* components) {
+    totalLights += total;
+  });
+
+  lights.resize(totalLights);
+
+  each<TransformComponent, LightComponent>([&](unsigned int total, const EntityHandle* entities, TransformComponent* transforms, LightComponent* components) {
+    for (unsigned int i = 0; i < total; i++) {
+      Light& light = lights[index++];
+
+      light.type = components[i].type;
+      light.color = components[i].color;
+      light.direction = components[i].direction;
+      light.radius = components[i].radius;
+      light.power = components[i].power;
+      light.position = transforms[i].position;
+    }
+  });
+}
+
+void World::updateMatrices() {
+  eachInParallel<TransformComponent, RenderInstanceComponent>([](unsigned int total, const EntityHandle* entities, TransformComponent* transforms, RenderInstanceComponent* instances) {
+    for (unsigned int i = 0; i < total; i++) {
+      instances[i].matrix = Object::createMatrix(transforms[i].position, transforms[i].orientation, transforms[i].scale);
+    }
+  });
+}
+
+/**
+ * Hands each render instance to its reference object, which renders
+ * it alongside its own instances. References are cleared first, so
+ * that instances of destroyed entities disappear.
+ */
+void World::updateRenderInstances() {
+  for (auto* reference : instancedReferences) {
+    reference->clearWorldInstances();
+  }
+
+  instancedReferences.clear();
+
+  each<TransformComponent, RenderInstanceComponent>([&](unsigned int total, const EntityHandle* entities, TransformComponent* transforms, RenderInstanceComponent* instances) {
+    for (unsigned int i = 0; i < total; i++) {
+      Object* reference = instances[i].reference;
+
+      if (reference == nullptr) {
+        continue;
+      }
+
+      if (reference->getWorldInstances().size() == 0) {
+        instancedReferences.push_back(reference);
+      }
+
+      reference->addWorldInstance(instances[i].matrix, transforms[i].position, instances[i].color);
+    }
+  });
+}
+
+void World::updateTweens(float dt) {
+  eachInParallel<TransformComponent, TweenComponent>([dt](unsigned int total, const EntityHandle* entities, TransformComponent* transforms, TweenComponent* tweens) {
+    for (unsigned int i = 0; i < total; i++) {
+      auto& tween = tweens[i];
+
+      tween.elapsed = std::min(tween.elapsed + dt, tween.duration);
+
+      float t = tween.duration > 0.0f ? tween.elapsed / tween.duration : 1.0f;
+      float progress = tween.easing != nullptr ? tween.easing(t) : t;
+
+      transforms[i].scale = tween.fromScale + (tween.toScale - tween.fromScale) * progress;
+    }
+  });
+}
+
+void World::updateVelocities(float dt) {
+  eachInParallel<TransformComponent, VelocityComponent>([dt](unsigned int total, const EntityHandle* entities, TransformComponent* transforms, VelocityComponent* velocities) {
+    for (unsigned int i = 0; i < total; i++) {
+      velocities[i].velocity += velocities[i].acceleration * dt;
+      transforms[i].position += velocities[i].velocity * dt;
+    }
+  });
+}
\ No newline at end of file
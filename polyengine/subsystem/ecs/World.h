@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "subsystem/ecs/Components.h"
+#include "subsystem/entities/Light.h"
+#include "subsystem/JobSystem.h"
+#include "subsystem/SlotMap.h"
+
+/**
+ * Identifies an entity in a World. Handles to destroyed entities stop
+ * resolving, even once their slot is reused.
+ */
+typedef SlotHandle EntityHandle;
+
+struct Archetype;
+
+/**
+ * Up to a fixed number of entities of one archetype, with each of
+ * its component types packed into its own column.
+ */
+struct ArchetypeChunk {
+  Archetype* archetype = nullptr;
+  uint8_t* data = nullptr;
+  EntityHandle* entities = nullptr;
+  unsigned int total = 0;
+};
+
+/**
+ * Every entity with one exact set of component types. Its chunks are
+ * kept full, besides the last. Once emptied, the last chunk is kept
+ * aside as a spare, so that an archetype whose count hovers around a
+ * chunk boundary doesn't free and allocate a chunk each time.
+ */
+struct Archetype {
+  ComponentMask mask = 0;
+  unsigned int chunkBytes = 0;
+  unsigned int chunkCapacity = 0;
+  unsigned int columnOffsets[ComponentType::TOTAL_COMPONENT_TYPES] = { 0 };
+  std::vector<ArchetypeChunk*> chunks;
+  ArchetypeChunk* spareChunk = nullptr;
+};
+
+/**
+ * Opt-in storage for entities made of plain data components rather
+ * than Entity subclasses and update handlers. Entities are grouped by
+ * their set of component types into archetypes, and systems run over
+ * each archetype's chunks as tightly packed arrays, with no virtual
+ * calls, type checks or per-entity allocations.
+ *
+ * Each update moves and tweens transforms, expires lifetimes, and
+ * publishes render instances to their reference objects and lights
+ * to the renderer. Adding and removing components moves the entity
+ * to another archetype, so mustn't happen while iterating.
+ */
+class World {
+public:
+  ~World();
+
+  template<typename T>
+  T* add(EntityHandle entity) {
+    migrate(entity, getMask(entity) | getComponentMask<T>());
+
+    return get<T>(entity);
+  }
+
+  template<typename... T>
+  EntityHandle create() {
+    return createEntity(getComponentMask<T...>());
+  }
+
+  /**
+   * Calls the body once for each chunk of entities having at least
+   * the given components, with the number of entities, their handles,
+   * and a column for each component.
+   */
+  template<typename... T, typename F>
+  void each(F body) {
+    ComponentMask mask = getComponentMask<T...>();
+
+    for (auto* archetype : archetypes) {
+      if ((archetype->mask & mask) != mask) {
+        continue;
+      }
+
+      for (auto* chunk : archetype->chunks) {
+        if (chunk->total > 0) {
+          body(chunk->total, chunk->entities, getColumn<T>(chunk)...);
+        }
+      }
+    }
+  }
+
+  /**
+   * Like each(), but runs the body on multiple chunks in parallel.
+   */
+  template<typename... T, typename F>
+  void eachInParallel(F body) {
+    ComponentMask mask = getComponentMask<T...>();
+
+    matchingChunks.clear();
+
+    for (auto* archetype : archetypes) {
+      if ((archetype->mask & mask) == mask) {
+        matchingChunks.insert(matchingChunks.end(), archetype->chunks.begin(), archetype->chunks.end());
+      }
+    }
+
+    JobSystem::parallelFor((unsigned int)matchingChunks.size(), 1, [&](unsigned int start, unsigned int end) {
+      for (unsigned int i = start; i < end; i++) {
+        auto* chunk = matchingChunks[i];
+
+        if (chunk->total > 0) {
+          body(chunk->total, chunk->entities, getColumn<T>(chunk)...);
+        }
+      }
+    });
+  }
+
+  template<typename T>
+  T* get(EntityHandle entity) const {
+    if (!isAlive(entity)) {
+      return nullptr;
+    }
+
+    auto& record = records[entity.slot];
+
+    if ((record.chunk->archetype->mask & getComponentMask<T>()) == 0) {
+      return nullptr;
+    }
+
+    return getColumn<T>(record.chunk) + record.row;
+  }
+
+  template<typename T>
+  void remove(EntityHandle entity) {
+    migrate(entity, getMask(entity) & ~getComponentMask<T>());
+  }
+
+  void destroy(EntityHandle entity);
+  const std::vector<Light>& getLights() const;
+  unsigned int getTotalEntities() const;
+  bool isAlive(EntityHandle entity) const;
+  void update(float dt);
+
+private:
+  struct EntityRecord {
+    ArchetypeChunk* chunk = nullptr;
+    unsigned int row = 0;
+    uint32_t generation = 0;
+  };
+
+  std::vector<Archetype*> archetypes;
+  std::vector<EntityRecord> records;
+  std::vector<uint32_t> freeRecords;
+  std::vector<EntityHandle> pendingDestroys;
+  std::vector<ArchetypeChunk*> matchingChunks;
+  std::vector<Object*> instancedReferences;
+  std::vector<Light> lights;
+  unsigned int totalEntities = 0;
+
+  template<typename... T>
+  constexpr static ComponentMask getComponentMask() {
+    return (0 | ... | (1u << T::TYPE));
+  }
+
+  template<typename T>
+  static T* getColumn(ArchetypeChunk* chunk) {
+    return (T*)(chunk->data + chunk->archetype->columnOffsets[T::TYPE]);
+  }
+
+  EntityHandle createEntity(ComponentMask mask);
+  void destroyPendingEntities();
+  Archetype* getArchetype(ComponentMask mask);
+  ComponentMask getMask(EntityHandle entity) const;
+  void insertRow(Archetype* archetype, EntityHandle entity);
+  void migrate(EntityHandle entity, ComponentMask mask);
+  void removeRow(ArchetypeChunk* chunk, unsigned int row);
+  void updateLifetimes(float dt);
+  void updateLights();
+  void updateMatrices();
+  void updateRenderInstances();
+  void updateTweens(float dt);
+  void updateVelocities(float dt);
+};
\ No newline at end of file
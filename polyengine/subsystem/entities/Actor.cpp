@@ -1,4 +1,5 @@
 #include "subsystem/entities/Actor.h"
+#include "subsystem/PoolAllocator.h"
 
 Actor::~Actor() {
   positionables.clear();
@@ -6,6 +7,14 @@ Actor::~Actor() {
   orientables.clear();
 }
 
+void* Actor::operator new(size_t size) {
+  return PoolAllocator::allocate(size);
+}
+
+void Actor::operator delete(void* memory, size_t size) {
+  PoolAllocator::free(memory, size);
+}
+
 void Actor::addPositionable(Positionable* positionable) {
   positionables.push_back(positionable);
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include "subsystem/traits/LifeCycle.h"
@@ -11,6 +12,9 @@ class Actor : public LifeCycle, public Transformable {
 public:
   virtual ~Actor();
 
+  static void* operator new(size_t size);
+  static void operator delete(void* memory, size_t size);
+
   virtual void onAdded() {};
   virtual void onRegistered() {};
   void setOrientation(const Vec3f& orientation) override;
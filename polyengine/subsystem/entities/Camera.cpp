@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include "subsystem/entities/Camera.h"
 
 constexpr static float PI = 3.141592f;
@@ -36,8 +38,8 @@ Vec3f Camera::getRightDirection() const {
 
 Matrix4 Camera::getViewMatrix() const {
   return (
-    Matrix4::rotate(Camera::active->orientation.invert()) *
-    Matrix4::translate(Camera::active->position.invert())
+    Matrix4::rotate(orientation.invert()) *
+    Matrix4::translate(position.invert())
   );
 }
 
@@ -25,4 +25,4 @@ bool Entity::isExpired() const {
   return lifetime == 0.0f;
 }
 
-int Entity::total = 0;
\ No newline at end of file
+std::atomic<int> Entity::total = 0;
\ No newline at end of file
@@ -1,19 +1,20 @@
 #pragma once
 
-#include <functional>
+#include <atomic>
 
+#include "subsystem/InlineFunction.h"
 #include "subsystem/Math.h"
 
 struct Entity {
   Entity();
   virtual ~Entity() {};
 
-  static int total;
+  static std::atomic<int> total;
   int id;
   Vec3f position;
   Vec3f orientation;
   float lifetime = -1.0f;
-  std::function<void(float)> onUpdate = nullptr;
+  InlineFunction<void(float)> onUpdate = nullptr;
 
   void expire();
   float getLocalDistance() const;
@@ -1,9 +1,18 @@
 #include "subsystem/entities/Instance.h"
+#include "subsystem/PoolAllocator.h"
 
 Instance::~Instance() {
   reference->untrackInstance(this);
 }
 
+void* Instance::operator new(size_t size) {
+  return PoolAllocator::allocate(size);
+}
+
+void Instance::operator delete(void* memory, size_t size) {
+  PoolAllocator::free(memory, size);
+}
+
 void Instance::from(Object* reference) {
   this->reference = reference;
 
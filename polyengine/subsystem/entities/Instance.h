@@ -9,6 +9,9 @@ class Instance : public Object {
 public:
   ~Instance();
 
+  static void* operator new(size_t size);
+  static void operator delete(void* memory, size_t size);
+
   void from(Object* reference);
   void rehydrate() override {};
 };
\ No newline at end of file
@@ -1,4 +1,7 @@
+#include <cmath>
+
 #include "subsystem/entities/Light.h"
+#include "subsystem/PoolAllocator.h"
 
 /**
  * Light
@@ -10,6 +13,26 @@ Light::Light(const Vec3f& position, const Vec3f& color, float radius) {
   this->radius = radius;
 }
 
+void* Light::operator new(size_t size) {
+  return PoolAllocator::allocate(size);
+}
+
+void Light::operator delete(void* memory, size_t size) {
+  PoolAllocator::free(memory, size);
+}
+
+/**
+ * Determines whether a position falls within the cube bounding
+ * the light's radius, which is cheap enough to test per instance.
+ */
+bool Light::isWithinRadius(const Vec3f& position) const {
+  return (
+    std::abs(position.x - this->position.x) < radius &&
+    std::abs(position.y - this->position.y) < radius &&
+    std::abs(position.z - this->position.z) < radius
+  );
+}
+
 void Light::setPosition(const Vec3f& position) {
   this->position = position;
 }
\ No newline at end of file
@@ -11,16 +11,34 @@ struct Light : Entity, public Positionable {
     SPOTLIGHT = 2
   };
 
+  /**
+   * Determines how shadows are filtered for directional and spot
+   * lights. PCF filters per screen pixel with a contact-hardening
+   * kernel, while EVSM prefilters the shadow map once per frame and
+   * resolves each pixel with a single mipmapped lookup. Point lights
+   * always use PCF. The filter is fixed once the light's shadow
+   * caster is created.
+   */
+  enum ShadowFilter {
+    PCF = 0,
+    EVSM = 1
+  };
+
   Light() {};
   Light(const Vec3f& position, const Vec3f& color, float radius);
 
+  static void* operator new(size_t size);
+  static void operator delete(void* memory, size_t size);
+
   LightType type = LightType::POINT;
   Vec3f color = Vec3f(1.0f);
   Vec3f direction;
   float radius = 100.0f;
   float power = 1.0f;
   bool canCastShadows = false;
+  ShadowFilter shadowFilter = ShadowFilter::PCF;
   Area<unsigned int> shadowMapSize = { 1024, 1024 };
 
+  bool isWithinRadius(const Vec3f& position) const;
   void setPosition(const Vec3f& position) override;
 };
\ No newline at end of file
@@ -1,5 +1,22 @@
+#include <algorithm>
+#include <mutex>
+
 #include "subsystem/entities/Object.h"
 #include "subsystem/entities/Instance.h"
+#include "subsystem/MemoryTracker.h"
+#include "subsystem/PerformanceProfiler.h"
+#include "subsystem/ZoneProfiler.h"
+
+/**
+ * Guards instance lists while tracking instances, since instances of
+ * the same reference can be created by entity update handlers running
+ * in parallel. Tracking is rare enough for one lock to be shared.
+ */
+static std::mutex instanceTrackingMutex;
+
+static uint64_t getInstanceBufferBytes(unsigned int totalInstances) {
+  return totalInstances * ((16 + 3) * sizeof(float) + sizeof(int));
+}
 
 /**
  * Object
@@ -34,11 +51,25 @@ Object::~Object() {
     instance->expire();
   }
 
+  MemoryTracker::trackFree(MemoryTag::CPU_MESHES, vertices.size() * sizeof(Vertex3d) + polygons.size() * sizeof(Polygon));
+  MemoryTracker::trackFree(MemoryTag::CPU_INSTANCES, getInstanceBufferBytes(totalAllocatedInstances));
+
   polygons.clear();
   vertices.clear();
   instances.clear();
 }
 
+/**
+ * Creates the matrix for a transform, as uploaded for rendering.
+ */
+Matrix4 Object::createMatrix(const Vec3f& position, const Vec3f& orientation, const Vec3f& scale) {
+  return (
+    Matrix4::translate({ position.x, position.y, -1.0f * position.z }) *
+    Matrix4::rotate(orientation) *
+    Matrix4::scale(scale)
+  ).transpose();
+}
+
 void Object::addPolygon(int v1index, int v2index, int v3index) {
   Polygon* polygon = new Polygon();
 
@@ -51,6 +82,8 @@ void Object::addPolygon(int v1index, int v2index, int v3index) {
   vertices[v3index]->polygons.push_back(polygon);
 
   polygons.push_back(polygon);
+
+  MemoryTracker::trackAllocation(MemoryTag::CPU_MESHES, sizeof(Polygon));
 }
 
 void Object::addVertex(const Vec3f& position) {
@@ -65,6 +98,27 @@ void Object::addVertex(const Vec3f& position, const Vec2f& uv) {
   vertex->index = vertices.size();
 
   vertices.push_back(vertex);
+
+  MemoryTracker::trackAllocation(MemoryTag::CPU_MESHES, sizeof(Vertex3d));
+}
+
+/**
+ * Adds an instance on behalf of a World entity, which is rendered
+ * after the object's own instances until the world next clears them.
+ * World instances can't be individually disabled.
+ */
+void Object::addWorldInstance(const Matrix4& matrix, const Vec3f& position, const Vec3f& color) {
+  worldInstances.push_back({ matrix, position, color });
+
+  shouldRecomputeBuffers = true;
+}
+
+void Object::clearWorldInstances() {
+  if (worldInstances.size() > 0) {
+    worldInstances.clear();
+
+    shouldRecomputeBuffers = true;
+  }
 }
 
 void Object::disableRendering() {
@@ -105,10 +159,37 @@ void Object::enableRenderingWhere(std::function<bool(Object*)> predicate) {
   }
 }
 
+/**
+ * Returns the distance from a position to the nearest point of the
+ * box bounding the object's rendered instances, as of their last
+ * rehydration, or to the object itself if it has no instances.
+ */
+float Object::getBoundsDistance(const Vec3f& position) const {
+  if (!hasInstances()) {
+    return (this->position - position).magnitude();
+  }
+
+  Vec3f nearestPoint = Vec3f(
+    std::clamp(position.x, instanceBoundsMin.x, instanceBoundsMax.x),
+    std::clamp(position.y, instanceBoundsMin.y, instanceBoundsMax.y),
+    std::clamp(position.z, instanceBoundsMin.z, instanceBoundsMax.z)
+  );
+
+  return (nearestPoint - position).magnitude();
+}
+
 const float* Object::getColorBuffer() const {
   return colorBuffer;
 }
 
+const SlotMap<Instance>& Object::getInstances() const {
+  return instances;
+}
+
+/**
+ * Returns the object's matrix as of the last stage update, which
+ * recomputes it if the object has since been transformed.
+ */
 const Matrix4& Object::getMatrix() const {
   return matrix;
 }
@@ -134,7 +215,7 @@ unsigned int Object::getTotalRenderableInstances() const {
     return isRenderable() ? 1 : 0;
   }
 
-  unsigned int total = 0;
+  unsigned int total = (unsigned int)worldInstances.size();
 
   for (auto* instance : instances) {
     if (instance->isRenderingEnabled) {
@@ -148,7 +229,7 @@ unsigned int Object::getTotalRenderableInstances() const {
 unsigned int Object::getTotalInstances() const {
   return (
     hasInstances()
-      ? instances.length() :
+      ? instances.length() + (unsigned int)worldInstances.size() :
     isReference
       ? 0 :
     1
@@ -159,8 +240,12 @@ const std::vector<Vertex3d*>& Object::getVertices() const {
   return vertices;
 }
 
+const std::vector<WorldInstance>& Object::getWorldInstances() const {
+  return worldInstances;
+}
+
 bool Object::hasInstances() const {
-  return instances.length() > 0;
+  return instances.length() > 0 || worldInstances.size() > 0;
 }
 
 bool Object::isRenderable() const {
@@ -184,19 +269,17 @@ void Object::reallocateBuffers() {
     delete[] objectIdBuffer;
   }
 
-  colorBuffer = new float[getTotalInstances() * 3];
-  matrixBuffer = new float[getTotalInstances() * 16];
-  objectIdBuffer = new int[getTotalInstances()];
-}
+  unsigned int totalInstances = std::max(getTotalInstances(), totalAllocatedInstances * 2);
 
-void Object::recomputeMatrix() {
-  matrix = (
-    Matrix4::translate({ position.x, position.y, -1.0f * position.z }) *
-    Matrix4::rotate(orientation) *
-    Matrix4::scale(scale)
-  ).transpose();
+  colorBuffer = new float[totalInstances * 3];
+  matrixBuffer = new float[totalInstances * 16];
+  objectIdBuffer = new int[totalInstances];
 
-  reference->shouldRecomputeBuffers = true;
+  MemoryTracker::trackResize(MemoryTag::CPU_INSTANCES, getInstanceBufferBytes(totalAllocatedInstances), getInstanceBufferBytes(totalInstances));
+
+  totalAllocatedInstances = totalInstances;
+
+  PerformanceProfiler::trackCounter(ProfiledCounter::BUFFER_REALLOCATIONS);
 }
 
 void Object::refreshColorBuffer() {
@@ -214,6 +297,14 @@ void Object::refreshColorBuffer() {
         idx++;
       }
     }
+
+    for (auto& worldInstance : worldInstances) {
+      colorBuffer[idx * 3] = worldInstance.color.x;
+      colorBuffer[idx * 3 + 1] = worldInstance.color.y;
+      colorBuffer[idx * 3 + 2] = worldInstance.color.z;
+
+      idx++;
+    }
   } else {
     colorBuffer[0] = color.x;
     colorBuffer[1] = color.y;
@@ -221,19 +312,44 @@ void Object::refreshColorBuffer() {
   }
 }
 
+/**
+ * Copies instance matrices into the matrix buffer, and bounds the
+ * positions of the instances copied.
+ */
 void Object::refreshMatrixBuffer() {
   if (hasInstances()) {
     unsigned int idx = 0;
 
+    auto addToBounds = [&](const Vec3f& position) {
+      if (idx == 0) {
+        instanceBoundsMin = position;
+        instanceBoundsMax = position;
+      } else {
+        instanceBoundsMin = Vec3f(std::min(instanceBoundsMin.x, position.x), std::min(instanceBoundsMin.y, position.y), std::min(instanceBoundsMin.z, position.z));
+        instanceBoundsMax = Vec3f(std::max(instanceBoundsMax.x, position.x), std::max(instanceBoundsMax.y, position.y), std::max(instanceBoundsMax.z, position.z));
+      }
+    };
+
     for (unsigned int i = 0; i < instances.length(); i++) {
       auto* instance = instances[i];
 
       if (instance->isRenderingEnabled) {
         const Matrix4& matrix = instance->getMatrix();
 
+        addToBounds(instance->position);
         memcpy(&matrixBuffer[idx++ * 16], matrix.m, 16 * sizeof(float));
       }
     }
+
+    for (auto& worldInstance : worldInstances) {
+      addToBounds(worldInstance.position);
+      memcpy(&matrixBuffer[idx++ * 16], worldInstance.matrix.m, 16 * sizeof(float));
+    }
+
+    if (idx == 0) {
+      instanceBoundsMin = position;
+      instanceBoundsMax = position;
+    }
   } else {
     memcpy(matrixBuffer, matrix.m, 16 * sizeof(float));
   }
@@ -250,14 +366,22 @@ void Object::refreshObjectIdBuffer() {
         objectIdBuffer[idx++] = (int)i;
       }
     }
+
+    for (unsigned int i = 0; i < worldInstances.size(); i++) {
+      objectIdBuffer[idx++] = (int)(instances.length() + i);
+    }
   } else {
     objectIdBuffer[0] = id;
   }
 }
 
 void Object::rehydrate() {
+  PROFILE_ZONE("Object::rehydrate");
+
   if (getTotalInstances() > 0) {
-    if (shouldReallocateBuffers) {
+    // Buffers only ever grow, doubling in size, so that instances
+    // coming and going don't reallocate them
+    if (getTotalInstances() > totalAllocatedInstances) {
       reallocateBuffers();
     }
 
@@ -268,14 +392,12 @@ void Object::rehydrate() {
     }
   }
 
-  shouldReallocateBuffers = false;
   shouldRecomputeBuffers = false;
 }
 
 void Object::rotate(const Vec3f& rotation) {
   orientation += rotation;
-
-  recomputeMatrix();
+  isMatrixDirty = true;
 }
 
 void Object::setColor(const Vec3f& color) {
@@ -285,36 +407,45 @@ void Object::setColor(const Vec3f& color) {
 
 void Object::setOrientation(const Vec3f& orientation) {
   this->orientation = orientation;
-
-  recomputeMatrix();
+  isMatrixDirty = true;
 }
 
 void Object::setPosition(const Vec3f& position) {
   this->position = position;
-
-  recomputeMatrix();
+  isMatrixDirty = true;
 }
 
 void Object::setScale(const Vec3f& scale) {
   this->scale = scale;
-
-  recomputeMatrix();
+  isMatrixDirty = true;
 }
 
 void Object::trackInstance(Instance* instance) {
+  std::lock_guard<std::mutex> lock(instanceTrackingMutex);
+
   instances.push(instance);
 
-  shouldReallocateBuffers = true;
   shouldRecomputeBuffers = true;
 }
 
 void Object::untrackInstance(Instance* instance) {
+  std::lock_guard<std::mutex> lock(instanceTrackingMutex);
+
   instances.remove(instance);
 
-  shouldReallocateBuffers = true;
   shouldRecomputeBuffers = true;
 }
 
+void Object::updateMatrix() {
+  if (!isMatrixDirty) {
+    return;
+  }
+
+  matrix = createMatrix(position, orientation, scale);
+  isMatrixDirty = false;
+  reference->shouldRecomputeBuffers = true;
+}
+
 void Object::updateNormals() {
   for (auto* polygon : polygons) {
     polygon->updateNormal();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <functional>
 
@@ -7,7 +8,7 @@
 #include "subsystem/traits/Transformable.h"
 #include "subsystem/Texture.h"
 #include "subsystem/Geometry.h"
-#include "subsystem/HeapList.h"
+#include "subsystem/SlotMap.h"
 
 enum ObjectEffects {
   TREE_ANIMATION = 1 << 0,
@@ -17,6 +18,16 @@ enum ObjectEffects {
 class Instance;
 class ReferenceMesh;
 
+/**
+ * An instance of an object belonging to an entity in a World rather
+ * than to an Instance.
+ */
+struct WorldInstance {
+  Matrix4 matrix;
+  Vec3f position;
+  Vec3f color;
+};
+
 class Object : public Entity, public Transformable {
   friend class Instance;
   friend class ReferenceMesh;
@@ -33,11 +44,17 @@ public:
 
   virtual ~Object();
 
+  static Matrix4 createMatrix(const Vec3f& position, const Vec3f& orientation, const Vec3f& scale);
+
+  void addWorldInstance(const Matrix4& matrix, const Vec3f& position, const Vec3f& color);
+  void clearWorldInstances();
   void disableRendering();
   void enableRendering();
   void enableRenderingAll();
   void enableRenderingWhere(std::function<bool(Object*)> predicate);
+  float getBoundsDistance(const Vec3f& position) const;
   const float* getColorBuffer() const;
+  const SlotMap<Instance>& getInstances() const;
   const Matrix4& getMatrix() const;
   const float* getMatrixBuffer() const;
   const int* getObjectIdBuffer() const;
@@ -46,6 +63,7 @@ public:
   unsigned int getTotalRenderableInstances() const;
   unsigned int getTotalInstances() const;
   const std::vector<Vertex3d*>& getVertices() const;
+  const std::vector<WorldInstance>& getWorldInstances() const;
   bool hasInstances() const;
   bool isRenderable() const;
   void move(const Vec3f& movement);
@@ -55,6 +73,7 @@ public:
   virtual void setOrientation(const Vec3f& orientation) override;
   virtual void setPosition(const Vec3f& position) override;
   virtual void setScale(const Vec3f& scale) override;
+  void updateMatrix();
 
 protected:
   std::vector<Vertex3d*> vertices;
@@ -69,18 +88,21 @@ protected:
   void updateNormals();
 
 private:
-  HeapList<Instance> instances;
+  SlotMap<Instance> instances;
+  std::vector<WorldInstance> worldInstances;
   Object* reference = this;
   bool isReference = false;
   float* matrixBuffer = nullptr;
   float* colorBuffer = nullptr;
   int* objectIdBuffer = nullptr;
-  bool shouldReallocateBuffers = true;
-  bool shouldRecomputeBuffers = false;
+  unsigned int totalAllocatedInstances = 0;
+  Vec3f instanceBoundsMin;
+  Vec3f instanceBoundsMax;
+  std::atomic<bool> shouldRecomputeBuffers = false;
+  bool isMatrixDirty = false;
   bool isRenderingEnabled = true;
 
   void reallocateBuffers();
-  void recomputeMatrix();
   void refreshColorBuffer();
   void refreshMatrixBuffer();
   void refreshObjectIdBuffer();
@@ -1,11 +1,11 @@
 #include "subsystem/traits/LifeCycle.h"
 
-std::function<float()> LifeCycle::createTimer() {
-  float time = getRunningTime();
-
-  return [=]() {
-    return getRunningTime() - time;
-  };
+/**
+ * LifeCycle
+ * ---------
+ */
+Timer LifeCycle::createTimer() {
+  return Timer(this, getRunningTime());
 }
 
 float LifeCycle::getRunningTime() {
@@ -20,4 +20,17 @@ void LifeCycle::update(float dt) {
   runningTime += dt;
 
   onUpdate(dt);
+}
+
+/**
+ * Timer
+ * -----
+ */
+Timer::Timer(LifeCycle* lifeCycle, float startTime) {
+  this->lifeCycle = lifeCycle;
+  this->startTime = startTime;
+}
+
+float Timer::operator()() const {
+  return lifeCycle->getRunningTime() - startTime;
 }
\ No newline at end of file
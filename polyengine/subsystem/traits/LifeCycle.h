@@ -1,12 +1,12 @@
 #pragma once
 
-#include <functional>
+class Timer;
 
 class LifeCycle {
 public:
   virtual ~LifeCycle() {};
 
-  std::function<float()> createTimer();
+  Timer createTimer();
   float getRunningTime();
   virtual bool isInitialized() final;
   virtual void onDestroy() {};
@@ -16,4 +16,20 @@ public:
 
 private:
   float runningTime = 0.0f;
+};
+
+/**
+ * Measures the running time of a LifeCycle since the timer was created.
+ * Calling it returns the elapsed time. Timers are small enough to be
+ * captured by value in update handlers.
+ */
+class Timer {
+public:
+  Timer(LifeCycle* lifeCycle, float startTime);
+
+  float operator()() const;
+
+private:
+  LifeCycle* lifeCycle;
+  float startTime;
 };
\ No newline at end of file
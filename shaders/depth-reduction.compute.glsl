@@ -0,0 +1,47 @@
+#version 430 core
+
+#include <helpers/gbuffer.glsl>
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+uniform sampler2D depthTexture;
+
+layout (std430, binding = 0) buffer DepthBounds {
+  uint minDepth;
+  uint maxDepth;
+};
+
+shared uint groupMinDepth;
+shared uint groupMaxDepth;
+
+void main() {
+  if (gl_LocalInvocationIndex == 0) {
+    groupMinDepth = 0x7F7FFFFFu;
+    groupMaxDepth = 0u;
+  }
+
+  barrier();
+
+  ivec2 size = textureSize(depthTexture, 0);
+  ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+
+  if (texel.x < size.x && texel.y < size.y) {
+    float hardwareDepth = texelFetch(depthTexture, texel, 0).r;
+
+    // Skip cleared pixels at the far plane. Linear depths are
+    // positive, so their bit patterns compare like floats.
+    if (hardwareDepth < 1.0) {
+      uint depthBits = floatBitsToUint(getLinearDepth(hardwareDepth));
+
+      atomicMin(groupMinDepth, depthBits);
+      atomicMax(groupMaxDepth, depthBits);
+    }
+  }
+
+  barrier();
+
+  if (gl_LocalInvocationIndex == 0 && groupMaxDepth > 0u) {
+    atomicMin(minDepth, groupMinDepth);
+    atomicMax(maxDepth, groupMaxDepth);
+  }
+}
\ No newline at end of file
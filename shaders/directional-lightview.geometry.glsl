@@ -0,0 +1,53 @@
+#version 400 core
+
+layout (triangles, invocations = 4) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+#include <helpers/light-constants.glsl>
+#include <helpers/draw-constants.glsl>
+
+in vec2 geometryUv[];
+
+out vec2 fragmentUv;
+
+/**
+ * Determines whether a light-space triangle lies entirely outside
+ * of a cascade's clip volume. Cascades use orthographic projections,
+ * so clip-space coordinates can be compared directly against the
+ * unit cube without a perspective divide.
+ */
+bool isOutsideCascade(vec4 v1, vec4 v2, vec4 v3) {
+  vec3 low = min(v1.xyz, min(v2.xyz, v3.xyz));
+  vec3 high = max(v1.xyz, max(v2.xyz, v3.xyz));
+
+  return any(lessThan(high, vec3(-1.0))) || any(greaterThan(low, vec3(1.0)));
+}
+
+void main() {
+  int cascadeIndex = gl_InvocationID;
+
+  if (cascadeIndex >= cascadeLimit) {
+    return;
+  }
+
+  mat4 lightMatrix = lightMatrices[cascadeIndex];
+  vec4 positions[3];
+
+  for (int v = 0; v < 3; v++) {
+    positions[v] = lightMatrix * gl_in[v].gl_Position;
+  }
+
+  if (isOutsideCascade(positions[0], positions[1], positions[2])) {
+    return;
+  }
+
+  for (int v = 0; v < 3; v++) {
+    gl_Layer = cascadeIndex;
+    gl_Position = positions[v];
+    fragmentUv = geometryUv[v];
+
+    EmitVertex();
+  }
+
+  EndPrimitive();
+}
\ No newline at end of file
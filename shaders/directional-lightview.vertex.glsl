@@ -0,0 +1,11 @@
+#version 330 core
+
+#include <helpers/attributes.glsl>
+#include <helpers/vertex-transformers.glsl>
+
+out vec2 geometryUv;
+
+void main() {
+  gl_Position = Instance.matrix * vec4(getTransformedVertex(Vertex.position), 1.0);
+  geometryUv = Vertex.uv;
+}
\ No newline at end of file
@@ -1,27 +1,30 @@
 #version 330 core
 
 #include <helpers/lighting.glsl>
+#include <helpers/gbuffer.glsl>
 #include <helpers/shadows.glsl>
 #include <helpers/sampling.glsl>
+#include <helpers/frame-constants.glsl>
+#include <helpers/light-constants.glsl>
 
 uniform sampler2D colorTexture;
-uniform sampler2D normalDepthTexture;
-uniform sampler2D positionTexture;
-uniform sampler2D lightMaps[4];
-uniform mat4 lightMatrixCascades[4];
-uniform vec3 cameraPosition;
-uniform Light light;
+uniform sampler2D normalTexture;
+uniform sampler2D depthTexture;
+uniform sampler2DArrayShadow lightMaps;
+uniform sampler2DArray lightDepthMaps;
+uniform sampler2DArray lightMomentMaps;
+uniform bool useEvsm = false;
 
 noperspective in vec2 fragmentUv;
 
 layout (location = 0) out vec4 colorDepth;
 
 int getCascadeIndex(float depth) {
-  if (depth < 200.0) {
+  if (depth < cascadeSplits[0]) {
     return 0;
-  } else if (depth < 500.0) {
+  } else if (depth < cascadeSplits[1]) {
     return 1;
-  } else if (depth < 1250.0) {
+  } else if (depth < cascadeSplits[2]) {
     return 2;
   } else {
     return 3;
@@ -52,17 +55,17 @@ vec3 getVolumetricLight(vec3 surfacePosition) {
   vec3 ray = surfaceToCamera * stepFactor;
   float strength = 0.2 + pow(max(dot(normalize(surfaceToCamera), light.direction), 0.0), 10);
 
-  surfacePosition += ray * getDitheringFactor(fragmentUv, textureSize(positionTexture, 0));
+  surfacePosition += ray * getDitheringFactor(fragmentUv, textureSize(depthTexture, 0));
 
   for (int i = 1; i < STEP_COUNT; i++) {
     vec3 samplePosition = surfacePosition + ray * float(i);
     float depth = length(samplePosition - cameraPosition);
     int cascadeIndex = getCascadeIndex(depth);
-    mat4 lightMatrix = lightMatrixCascades[cascadeIndex];
+    mat4 lightMatrix = lightMatrices[cascadeIndex];
     vec3 transform = getLightMapTransform(samplePosition, lightMatrix);
-    float closestDepth = texture(lightMaps[cascadeIndex], transform.xy).r;
+    float visibility = texture(lightMaps, vec4(transform.xy, float(cascadeIndex), transform.z));
 
-    volumetricLight += (closestDepth < transform.z) ? vec3(0.0) : (light.color * stepFactor);
+    volumetricLight += light.color * stepFactor * visibility;
   }
 
   return volumetricLight * strength;
@@ -70,18 +73,20 @@ vec3 getVolumetricLight(vec3 surfacePosition) {
 
 void main() {
   vec3 albedo = texture(colorTexture, fragmentUv).xyz;
-  vec3 position = texture(positionTexture, fragmentUv).xyz;
-  vec4 normalDepth = texture(normalDepthTexture, fragmentUv);
+  float hardwareDepth = texture(depthTexture, fragmentUv).r;
+  vec3 position = getWorldPosition(fragmentUv, hardwareDepth, inverseViewProjectionMatrix);
   vec3 surfaceToCamera = normalize(cameraPosition - position);
-  vec3 normal = normalDepth.xyz;
-  float depth = normalDepth.w;
+  vec3 normal = decodeNormal(texture(normalTexture, fragmentUv).xy);
+  float depth = getLinearDepth(hardwareDepth);
 
   int cascadeIndex = getCascadeIndex(depth);
-  mat4 lightMatrix = lightMatrixCascades[cascadeIndex];
+  mat4 lightMatrix = lightMatrices[cascadeIndex];
   vec3 lighting = albedo * getDirectionalLightFactor(light, normal, surfaceToCamera);
   float bias = getBias(depth, normal);
   float maxSoftness = getMaxSoftness(depth);
-  float shadowFactor = getShadowFactor(position, lightMatrix, lightMaps[cascadeIndex], bias, maxSoftness);
+  float shadowFactor = useEvsm
+    ? getEvsmShadowFactor(position, lightMatrix, lightMomentMaps, cascadeIndex, bias)
+    : getShadowFactor(position, lightMatrix, lightMaps, lightDepthMaps, cascadeIndex, bias, maxSoftness);
   vec3 volumetricLight = getVolumetricLight(position);
 
   colorDepth = vec4(lighting * shadowFactor + volumetricLight, depth);
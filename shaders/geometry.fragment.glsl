@@ -1,24 +1,24 @@
 #version 330 core
 
-uniform bool hasTexture = false;
-uniform bool hasNormalMap = false;
+#include <helpers/gbuffer.glsl>
+
 uniform sampler2D modelTexture;
 uniform sampler2D normalMap;
 
 in vec3 fragmentColor;
 in vec3 fragmentNormal;
 in vec3 fragmentTangent;
-in vec3 fragmentPosition;
 in vec2 fragmentUv;
 
-layout (location = 0) out vec3 color;
-layout (location = 1) out vec4 normalDepth;
-layout (location = 2) out vec3 position;
+layout (location = 0) out vec4 color;
+layout (location = 1) out vec2 normal;
 
 vec4 getColor() {
-  return hasTexture
-    ? texture(modelTexture, fragmentUv)
-    : vec4(fragmentColor, 1.0);
+  #ifdef HAS_TEXTURE
+    return texture(modelTexture, fragmentUv);
+  #else
+    return vec4(fragmentColor, 1.0);
+  #endif
 }
 
 mat3 getTBNMatrix() {
@@ -33,18 +33,14 @@ mat3 getTBNMatrix() {
 }
 
 vec3 getNormal() {
-  if (hasNormalMap) {
+  #ifdef HAS_NORMAL_MAP
     vec3 mappedNormal = texture(normalMap, fragmentUv).xyz * 2.0 - vec3(1.0);
     mat3 matrix = getTBNMatrix();
 
     return normalize(matrix * mappedNormal);
-  } else {
+  #else
     return normalize(fragmentNormal);
-  }
-}
-
-float getDepth() {
-  return gl_FragCoord.z / gl_FragCoord.w;
+  #endif
 }
 
 void main() {
@@ -54,7 +50,12 @@ void main() {
     discard;
   }
 
-  color = fragColor.xyz;
-  normalDepth = vec4(getNormal(), getDepth());
-  position = fragmentPosition;
+  // Alpha is reserved for material flags. Emissive surfaces
+  // are flagged so the lighting resolve can pass them through.
+  #ifdef IS_EMISSIVE
+    color = vec4(fragColor.xyz, 1.0);
+  #else
+    color = vec4(fragColor.xyz, 0.0);
+  #endif
+  normal = encodeNormal(getNormal());
 }
\ No newline at end of file
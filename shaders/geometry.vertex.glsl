@@ -1,27 +1,18 @@
 #version 330 core
 
 #include <helpers/attributes.glsl>
+#include <helpers/frame-constants.glsl>
 #include <helpers/vertex-transformers.glsl>
 
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
-
 out vec3 fragmentColor;
 out vec3 fragmentNormal;
 out vec3 fragmentTangent;
-out vec3 fragmentPosition;
 out vec2 fragmentUv;
 
 vec4 getClipPosition() {
   return projectionMatrix * viewMatrix * Instance.matrix * vec4(getTransformedVertex(Vertex.position), 1.0);
 }
 
-vec3 getWorldPosition() {
-  vec3 position = vec4(Instance.matrix * vec4(getTransformedVertex(Vertex.position), 1.0)).xyz;
-
-  return vec3(position.x, position.y, -position.z);
-}
-
 vec3 getNormal() {
   mat3 matrix = transpose(inverse(mat3(Instance.matrix)));
   vec3 normal = matrix * Vertex.normal;
@@ -41,7 +32,10 @@ void main() {
 
   fragmentColor = Instance.color;
   fragmentNormal = getNormal();
-  fragmentTangent = getTangent();
-  fragmentPosition = getWorldPosition();
+  #ifdef HAS_NORMAL_MAP
+    fragmentTangent = getTangent();
+  #else
+    fragmentTangent = vec3(0.0);
+  #endif
   fragmentUv = Vertex.uv;
 }
\ No newline at end of file
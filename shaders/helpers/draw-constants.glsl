@@ -0,0 +1,7 @@
+/**
+ * Per-draw constants, only re-uploaded when they change between
+ * draws. Mirrors DrawConstants in opengl/OpenGLUniformBuffer.h.
+ */
+layout (std140) uniform DrawConstants {
+  int cascadeLimit;
+};
\ No newline at end of file
@@ -0,0 +1,12 @@
+/**
+ * Constants shared by every program over the course of a frame,
+ * uploaded once per frame. Mirrors FrameConstants in
+ * opengl/OpenGLUniformBuffer.h.
+ */
+layout (std140) uniform FrameConstants {
+  mat4 projectionMatrix;
+  mat4 viewMatrix;
+  mat4 inverseViewProjectionMatrix;
+  vec3 cameraPosition;
+  float time;
+};
\ No newline at end of file
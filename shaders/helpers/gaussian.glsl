@@ -41,5 +41,19 @@ vec4 gaussian9(sampler2D image, vec2 uv, vec2 direction) {
     color += texture(image, uv + offset) * weight;
   }
 
+  return color;
+}
+
+vec4 gaussian9(sampler2DArray image, vec3 uvw, vec2 direction) {
+  vec4 color = vec4(0.0);
+  vec2 texelSize = 1.0 / textureSize(image, 0).xy;
+
+  for (int i = 0; i < 9; i++) {
+    vec2 offset = direction * texelSize * float(i - 4.0);
+    float weight = GAUSSIAN_KERNEL_9[i];
+
+    color += texture(image, vec3(uvw.xy + offset, uvw.z)) * weight;
+  }
+
   return color;
 }
\ No newline at end of file
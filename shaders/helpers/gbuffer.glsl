@@ -0,0 +1,54 @@
+// Must match the near/far planes used by the camera projection
+// in OpenGLVideoController::createProjectionMatrix()
+const float NEAR_PLANE = 1.0;
+const float FAR_PLANE = 10000.0;
+
+vec2 wrapOctahedron(vec2 v) {
+  return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+/**
+ * Encodes a unit normal into two [0, 1] components by projecting
+ * it onto an octahedron and unfolding the octahedron into a square.
+ */
+vec2 encodeNormal(vec3 normal) {
+  normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+
+  vec2 encoded = normal.z >= 0.0 ? normal.xy : wrapOctahedron(normal.xy);
+
+  return encoded * 0.5 + 0.5;
+}
+
+vec3 decodeNormal(vec2 encoded) {
+  encoded = encoded * 2.0 - 1.0;
+
+  vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float t = clamp(-normal.z, 0.0, 1.0);
+
+  normal.x += normal.x >= 0.0 ? -t : t;
+  normal.y += normal.y >= 0.0 ? -t : t;
+
+  return normalize(normal);
+}
+
+/**
+ * Converts a [0, 1] hardware depth value into a linear view depth.
+ */
+float getLinearDepth(float depth) {
+  float ndcDepth = depth * 2.0 - 1.0;
+
+  return (2.0 * NEAR_PLANE * FAR_PLANE) / (FAR_PLANE + NEAR_PLANE - ndcDepth * (FAR_PLANE - NEAR_PLANE));
+}
+
+/**
+ * Reconstructs the world position of a G-Buffer sample from its
+ * screen coordinates and hardware depth value.
+ */
+vec3 getWorldPosition(vec2 uv, float depth, mat4 inverseViewProjectionMatrix) {
+  vec4 clipPosition = vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+  vec4 worldPosition = inverseViewProjectionMatrix * clipPosition;
+
+  // Lighting uses world positions with inverted z relative to
+  // OpenGL world space
+  return (worldPosition.xyz / worldPosition.w) * vec3(1.0, 1.0, -1.0);
+}
\ No newline at end of file
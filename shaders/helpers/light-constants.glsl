@@ -0,0 +1,13 @@
+#include <helpers/lighting.glsl>
+
+/**
+ * Constants for the shadowcasting light currently being rendered.
+ * Directional lights use the first four matrices as cascades, spot
+ * lights use the first, and point lights use all six cube faces.
+ * Mirrors LightConstants in opengl/OpenGLUniformBuffer.h.
+ */
+layout (std140) uniform LightConstants {
+  mat4 lightMatrices[6];
+  vec4 cascadeSplits;
+  Light light;
+};
\ No newline at end of file
@@ -1,13 +1,29 @@
 #include <helpers/sampling.glsl>
 #include <helpers/random.glsl>
 
+// Positive/negative warp exponents for exponential variance shadow
+// maps. These are the largest values which remain stable in 32-bit
+// floating point moments.
+const vec2 EVSM_EXPONENTS = vec2(40.0, 5.0);
+const float EVSM_VARIANCE_BIAS = 0.0001;
+const float EVSM_LIGHT_BLEEDING_REDUCTION = 0.2;
+
 vec3 getLightMapTransform(vec3 surfacePosition, mat4 lightMatrix) {
   vec4 lightSpacePosition = lightMatrix * vec4(surfacePosition * vec3(1.0, 1.0, -1.0), 1.0);
 
   return (lightSpacePosition.xyz / lightSpacePosition.w) * 0.5 + 0.5;
 }
 
-float getShadowFactor(vec3 surfacePosition, mat4 lightMatrix, sampler2D lightMap, float bias, float maxSoftness) {
+/**
+ * Takes a single hardware-filtered shadow sample. Shadow maps use
+ * depth comparison with linear filtering, so each sample returns the
+ * bilinearly-weighted result of four depth comparisons.
+ */
+float sampleShadowMap(sampler2DArrayShadow shadowMaps, vec2 uv, int layer, float depth) {
+  return texture(shadowMaps, vec4(uv, float(layer), depth));
+}
+
+float getShadowFactor(vec3 surfacePosition, mat4 lightMatrix, sampler2DArrayShadow shadowMaps, sampler2DArray depthMaps, int layer, float bias, float maxSoftness) {
   vec3 transform = getLightMapTransform(surfacePosition, lightMatrix);
 
   if (transform.z > 1.0) {
@@ -15,19 +31,17 @@ float getShadowFactor(vec3 surfacePosition, mat4 lightMatrix, sampler2D lightMap
     return 1.0;
   }
 
-  vec2 texelSize = 1.0 / textureSize(lightMap, 0);
+  vec2 texelSize = 1.0 / textureSize(depthMaps, 0).xy;
   vec2 sampleSpread = maxSoftness * texelSize * 0.25;
-  float closestDepth = texture(lightMap, transform.xy).r;
-  float closestNeighboringOccluderDepth = min(transform.z, closestDepth);
-  bool isSurfaceOccluded = closestDepth < transform.z - bias;
-  float shadowFactor = 0.0;
+  float surfaceDepth = transform.z - bias;
+  float closestNeighboringOccluderDepth = transform.z;
 
-  shadowFactor += isSurfaceOccluded ? 0.0 : 1.0;
-
-  // Do a prelimary radial sweep of the surface region to determine
-  // the likely-closest depth of any neighboring occluders
-  for (int s = 0; s < 8; s++) {
-    float sampleDistance = texture(lightMap, transform.xy + RADIAL_SAMPLE_OFFSETS_8[s] * sampleSpread).r;
+  // Do a prelimary sweep of the surface region to determine
+  // the likely-closest depth of any neighboring occluders.
+  // Raw depth values are needed here, so the comparison-free
+  // depth sampler is used instead of the shadow sampler.
+  for (int s = 0; s < 4; s++) {
+    float sampleDistance = texture(depthMaps, vec3(transform.xy + DIAMOND_SAMPLE_OFFSETS[s] * sampleSpread, layer)).r;
 
     closestNeighboringOccluderDepth = min(sampleDistance, closestNeighboringOccluderDepth);
   }
@@ -36,21 +50,73 @@ float getShadowFactor(vec3 surfacePosition, mat4 lightMatrix, sampler2D lightMap
   // and closest neighboring occluder depth to determine blur
   float occluderDistance = transform.z - closestNeighboringOccluderDepth;
   float blur = 1.5 + maxSoftness * occluderDistance;
+  float centerFactor = sampleShadowMap(shadowMaps, transform.xy, layer, surfaceDepth);
+  float shadowFactor = centerFactor;
 
-  // Sample the region to take an average shadow factor
-  for (int i = 1; i <= 2; i++) {
-    for (int s = 0; s < 8; s++) {
-      vec2 radialOffset = RADIAL_SAMPLE_OFFSETS_8[s] * float(i) * texelSize * blur * 0.5;
-      vec2 randomOffset = getRandomOffset2(float(s * i)) * float(i) * texelSize * 0.3;
-      float sampledClosestDepth = texture(lightMap, transform.xy + radialOffset + randomOffset).r;
+  // Sample the region to take an average shadow factor. Since
+  // each tap is hardware-filtered, a single ring of samples at
+  // the outer radius covers the same area as the two manual
+  // sample rings it replaces.
+  for (int s = 0; s < 8; s++) {
+    vec2 radialOffset = RADIAL_SAMPLE_OFFSETS_8[s] * texelSize * blur * 0.75;
+    vec2 randomOffset = getRandomOffset2(float(s)) * texelSize * 0.45;
 
-      shadowFactor += (sampledClosestDepth < transform.z - bias) ? 0.0 : 1.0;
-    }
+    shadowFactor += sampleShadowMap(shadowMaps, transform.xy + radialOffset + randomOffset, layer, surfaceDepth);
   }
 
-  shadowFactor /= 17.0;
+  shadowFactor /= 9.0;
 
   // Correct for occluded surfaces where random shadow sample
   // offsets erroneously result in low average occlusion
-  return (isSurfaceOccluded && shadowFactor > 0.9) ? 0.0 : shadowFactor;
+  return (centerFactor == 0.0 && shadowFactor > 0.9) ? 0.0 : shadowFactor;
+}
+
+/**
+ * Warps a [0, 1] light-space depth into the positive and negative
+ * exponential depth moments stored in EVSM shadow maps.
+ */
+vec4 getWarpedDepthMoments(float depth) {
+  float clipDepth = depth * 2.0 - 1.0;
+  float positive = exp(EVSM_EXPONENTS.x * clipDepth);
+  float negative = -exp(-EVSM_EXPONENTS.y * clipDepth);
+
+  return vec4(positive, positive * positive, negative, negative * negative);
+}
+
+float getChebyshevUpperBound(vec2 moments, float mean, float minVariance) {
+  float variance = max(moments.y - moments.x * moments.x, minVariance);
+  float delta = mean - moments.x;
+  float maxProbability = variance / (variance + delta * delta);
+
+  // Remap the upper bound to cut off the low end of the falloff,
+  // where light bleeding artifacts tend to appear
+  maxProbability = clamp((maxProbability - EVSM_LIGHT_BLEEDING_REDUCTION) / (1.0 - EVSM_LIGHT_BLEEDING_REDUCTION), 0.0, 1.0);
+
+  return mean <= moments.x ? 1.0 : maxProbability;
+}
+
+/**
+ * Determines the shadow factor for a surface using prefiltered
+ * EVSM moments. Since the moments are blurred and mipmapped ahead
+ * of time, this only requires a single filtered lookup.
+ */
+float getEvsmShadowFactor(vec3 surfacePosition, mat4 lightMatrix, sampler2DArray momentMaps, int layer, float bias) {
+  vec3 transform = getLightMapTransform(surfacePosition, lightMatrix);
+
+  // Sample before any early return, so implicit derivatives used
+  // for mip selection remain well-defined
+  vec4 moments = texture(momentMaps, vec3(transform.xy, layer));
+
+  if (transform.z > 1.0) {
+    // Ignore surfaces beyond the far plane in light-space
+    return 1.0;
+  }
+
+  vec4 warpedDepth = getWarpedDepthMoments(transform.z - bias);
+  vec2 depthScale = EVSM_VARIANCE_BIAS * EVSM_EXPONENTS * vec2(warpedDepth.x, -warpedDepth.z);
+  vec2 minVariance = depthScale * depthScale;
+  float positiveFactor = getChebyshevUpperBound(moments.xy, warpedDepth.x, minVariance.x);
+  float negativeFactor = getChebyshevUpperBound(moments.zw, warpedDepth.z, minVariance.y);
+
+  return min(positiveFactor, negativeFactor);
 }
\ No newline at end of file
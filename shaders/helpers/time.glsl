@@ -1 +0,0 @@
-uniform float time;
\ No newline at end of file
@@ -1,14 +1,12 @@
-#include <helpers/time.glsl>
+#include <helpers/frame-constants.glsl>
 #include <helpers/attributes.glsl>
 
-uniform int treeTransformFactor;
-uniform int grassTransformFactor;
-
 const float SPEED = 2.0;
 const float DEVIATION = 0.1;
 
+#ifdef GRASS_ANIMATION
 vec3 grass(vec3 position) {
-  float xOffset = sin(time * SPEED + position.y * 0.25 + float(Instance.ID)) * DEVIATION * position.y * grassTransformFactor;
+  float xOffset = sin(time * SPEED + position.y * 0.25 + float(Instance.ID)) * DEVIATION * position.y;
 
   return vec3(
     position.x + xOffset,
@@ -16,10 +14,12 @@ vec3 grass(vec3 position) {
     position.z
   );
 }
+#endif
 
+#ifdef TREE_ANIMATION
 vec3 tree(vec3 position) {
   float magnitude = sqrt(position.x * position.x + position.z * position.z);
-  float yOffset = sin(time * SPEED + float(Instance.ID)) * DEVIATION * magnitude * min(position.y, 1.0) * treeTransformFactor;
+  float yOffset = sin(time * SPEED + float(Instance.ID)) * DEVIATION * magnitude * min(position.y, 1.0);
 
   return vec3(
     position.x,
@@ -27,7 +27,20 @@ vec3 tree(vec3 position) {
     position.z
   );
 }
+#endif
 
+/**
+ * Applies the animations enabled for the current shader variant.
+ * Static geometry compiles without either, leaving the vertex as-is.
+ */
 vec3 getTransformedVertex(vec3 position) {
-  return grass(tree(position));
+  #ifdef TREE_ANIMATION
+    position = tree(position);
+  #endif
+
+  #ifdef GRASS_ANIMATION
+    position = grass(position);
+  #endif
+
+  return position;
 }
\ No newline at end of file
@@ -3,15 +3,16 @@
 #define MAX_LIGHTS 128
 
 #include <helpers/lighting.glsl>
+#include <helpers/gbuffer.glsl>
+#include <helpers/frame-constants.glsl>
 
 const int POINT_LIGHT = 0;
 const int DIRECTIONAL_LIGHT = 1;
 const int SPOT_LIGHT = 2;
 
 uniform sampler2D colorTexture;
-uniform sampler2D normalDepthTexture;
-uniform sampler2D positionTexture;
-uniform vec3 cameraPosition;
+uniform sampler2D normalTexture;
+uniform sampler2D depthTexture;
 
 noperspective in vec2 fragmentUv;
 flat in Light light;
@@ -20,10 +21,11 @@ layout (location = 0) out vec4 colorDepth;
 
 void main() {
   vec3 albedo = texture(colorTexture, fragmentUv).xyz;
-  vec3 position = texture(positionTexture, fragmentUv).xyz;
-  vec4 normalDepth = texture(normalDepthTexture, fragmentUv);
+  float hardwareDepth = texture(depthTexture, fragmentUv).r;
+  vec3 position = getWorldPosition(fragmentUv, hardwareDepth, inverseViewProjectionMatrix);
   vec3 surfaceToCamera = normalize(cameraPosition - position);
-  vec3 normal = normalDepth.xyz;
+  vec3 normal = decodeNormal(texture(normalTexture, fragmentUv).xy);
+  float depth = getLinearDepth(hardwareDepth);
   vec3 illuminatedColor = vec3(0.0);
 
   switch (light.type) {
@@ -38,5 +40,5 @@ void main() {
       break;
   }
 
-  colorDepth = vec4(illuminatedColor, normalDepth.w);
+  colorDepth = vec4(illuminatedColor, depth);
 }
\ No newline at end of file
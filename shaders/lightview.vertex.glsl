@@ -2,12 +2,13 @@
 
 #include <helpers/attributes.glsl>
 #include <helpers/vertex-transformers.glsl>
+#include <helpers/light-constants.glsl>
 
-uniform mat4 lightMatrix;
+uniform int lightMatrixIndex = 0;
 
 out vec2 fragmentUv;
 
 void main() {
-  gl_Position = lightMatrix * Instance.matrix * vec4(getTransformedVertex(Vertex.position), 1.0);
+  gl_Position = lightMatrices[lightMatrixIndex] * Instance.matrix * vec4(getTransformedVertex(Vertex.position), 1.0);
   fragmentUv = Vertex.uv;
 }
\ No newline at end of file
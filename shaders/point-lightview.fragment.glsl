@@ -1,10 +1,13 @@
 #version 330 core
 
-uniform vec3 lightPosition;
-uniform float farPlane;
+#include <helpers/light-constants.glsl>
 
 in vec4 worldPosition;
 
 void main() {
-  gl_FragDepth = length(worldPosition.xyz - lightPosition) / farPlane;
+  // Light positions are stored in world space, so the z axis
+  // is flipped to match the OpenGL world space positions
+  vec3 lightPosition = light.position * vec3(1.0, 1.0, -1.0);
+
+  gl_FragDepth = length(worldPosition.xyz - lightPosition) / light.radius;
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 layout (triangles) in;
 layout (triangle_strip, max_vertices = 18) out;
 
-uniform mat4 lightMatrices[6];
+#include <helpers/light-constants.glsl>
 
 out vec4 worldPosition;
 
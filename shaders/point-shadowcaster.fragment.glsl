@@ -1,16 +1,16 @@
 #version 330 core
 
 #include <helpers/lighting.glsl>
+#include <helpers/gbuffer.glsl>
 #include <helpers/sampling.glsl>
 #include <helpers/random.glsl>
+#include <helpers/frame-constants.glsl>
+#include <helpers/light-constants.glsl>
 
 uniform sampler2D colorTexture;
-uniform sampler2D normalDepthTexture;
-uniform sampler2D positionTexture;
+uniform sampler2D normalTexture;
+uniform sampler2D depthTexture;
 uniform samplerCube lightCubeMap;
-uniform float farPlane;
-uniform vec3 cameraPosition;
-uniform Light light;
 
 noperspective in vec2 fragmentUv;
 
@@ -24,7 +24,7 @@ float getPointShadowFactor(vec3 surfacePosition, vec3 surfaceNormal) {
     vec3 surfaceToLight = lightToSurface * -1.0;
     float surfaceDistance = length(lightToSurface);
     vec3 sampleOffset = CUBE_SAMPLE_OFFSETS[i] * surfaceDistance * 0.005;
-    float closestDepth = texture(lightCubeMap, lightToSurface * vec3(1.0, 1.0, -1.0) + sampleOffset).r * farPlane;
+    float closestDepth = texture(lightCubeMap, lightToSurface * vec3(1.0, 1.0, -1.0) + sampleOffset).r * light.radius;
     float bias = 0.1 + (1.0 - dot(normalize(surfaceToLight), surfaceNormal)) * surfaceDistance * 0.01;
 
     factor += (closestDepth < surfaceDistance - bias) ? 0.0 : 1.0;
@@ -35,12 +35,13 @@ float getPointShadowFactor(vec3 surfacePosition, vec3 surfaceNormal) {
 
 void main() {
   vec3 albedo = texture(colorTexture, fragmentUv).xyz;
-  vec3 surfacePosition = texture(positionTexture, fragmentUv).xyz;
-  vec4 normalDepth = texture(normalDepthTexture, fragmentUv);
+  float hardwareDepth = texture(depthTexture, fragmentUv).r;
+  vec3 surfacePosition = getWorldPosition(fragmentUv, hardwareDepth, inverseViewProjectionMatrix);
   vec3 surfaceToCamera = normalize(cameraPosition - surfacePosition);
-  vec3 normal = normalDepth.xyz;
+  vec3 normal = decodeNormal(texture(normalTexture, fragmentUv).xy);
+  float depth = getLinearDepth(hardwareDepth);
   vec3 lighting = albedo * getPointLightFactor(light, surfacePosition, normal, surfaceToCamera);
   float shadowFactor = getPointShadowFactor(surfacePosition, normal);
 
-  colorDepth = vec4(lighting * shadowFactor, normalDepth.w);
+  colorDepth = vec4(lighting * shadowFactor, depth);
 }
\ No newline at end of file
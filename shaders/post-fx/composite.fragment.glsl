@@ -0,0 +1,23 @@
+#version 330 core
+
+#include <helpers/sampling.glsl>
+
+uniform sampler2D colorDepthIn;
+
+noperspective in vec2 fragmentUv;
+
+layout (location = 0) out vec4 colorDepthOut;
+
+#define TEXEL_SIZE (1.0 / vec2(textureSize(colorDepthIn, 0)))
+
+vec4 sampleColorDepth(vec2 uv) {
+  return texture(colorDepthIn, uv);
+}
+
+#define STAGE_SOURCE sampleColorDepth
+
+#pragma stages
+
+void main() {
+  colorDepthOut = FINAL_STAGE(fragmentUv);
+}
\ No newline at end of file
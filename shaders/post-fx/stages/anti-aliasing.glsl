@@ -0,0 +1,37 @@
+#include <helpers/sampling.glsl>
+
+float getAntiAliasingColorDelta(vec3 colorA, vec3 colorB) {
+  return (
+    abs(colorA.r - colorB.r) +
+    abs(colorA.g - colorB.g) +
+    abs(colorA.b - colorB.b)
+  );
+}
+
+vec3 getAntiAliasingMix(vec2 uv, vec3 color) {
+  for (int i = 0; i < 4; i++) {
+    color += PREVIOUS_STAGE(uv + CROSS_SAMPLE_OFFSETS[i] * TEXEL_SIZE).rgb * 0.5;
+  }
+
+  for (int i = 0; i < 4; i++) {
+    color += PREVIOUS_STAGE(uv + DIAMOND_SAMPLE_OFFSETS[i] * TEXEL_SIZE).rgb * 0.25;
+  }
+
+  return color / 4.0;
+}
+
+vec4 STAGE(vec2 uv) {
+  vec4 colorDepth = PREVIOUS_STAGE(uv);
+  vec3 color = colorDepth.rgb;
+
+  for (int i = 0; i < 4; i++) {
+    vec3 comparisonColor = PREVIOUS_STAGE(uv + CROSS_SAMPLE_OFFSETS[i] * TEXEL_SIZE).rgb;
+    float delta = getAntiAliasingColorDelta(color, comparisonColor);
+
+    if (delta > 0.15) {
+      color = getAntiAliasingMix(uv, color);
+    }
+  }
+
+  return vec4(color, colorDepth.w);
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+uniform sampler2D bloomColorIn;
+
+vec4 STAGE(vec2 uv) {
+  return PREVIOUS_STAGE(uv) + texture(bloomColorIn, uv);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+vec4 STAGE(vec2 uv) {
+  float depth = PREVIOUS_STAGE(uv).w;
+  vec2 clipUv = uv * 2.0 - 1.0;
+
+  return vec4(
+    PREVIOUS_STAGE(clipUv * 0.999 * 0.5 + 0.5).r,
+    PREVIOUS_STAGE(clipUv * 0.995 * 0.5 + 0.5).g,
+    PREVIOUS_STAGE(clipUv * 0.99 * 0.5 + 0.5).b,
+    depth
+  );
+}
\ No newline at end of file
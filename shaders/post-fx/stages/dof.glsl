@@ -0,0 +1,34 @@
+#include <helpers/sampling.glsl>
+
+vec2 getDofBlur(float depth) {
+  vec2 MIN_BLUR = vec2(0.0);
+  vec2 MAX_BLUR = TEXEL_SIZE;
+
+  float focalDistance = min(PREVIOUS_STAGE(vec2(0.5, 0.5)).w, 500.0);
+  float maxBlurDepth = focalDistance + 1000.0;
+  float factor = depth < focalDistance ? 5.0 : 1.0;
+  float alpha = factor * abs(depth - focalDistance) / maxBlurDepth;
+
+  if (alpha >= 1.0) {
+    return MAX_BLUR;
+  }
+
+  return mix(MIN_BLUR, MAX_BLUR, pow(alpha, 3));
+}
+
+vec4 STAGE(vec2 uv) {
+  vec4 colorDepth = PREVIOUS_STAGE(uv);
+  float depth = colorDepth.w;
+  vec2 blur = getDofBlur(depth);
+  vec3 color = colorDepth.rgb;
+
+  for (int s = 0; s < 4; s++) {
+    color += PREVIOUS_STAGE(uv + CROSS_SAMPLE_OFFSETS[s] * blur * 1.5).rgb;
+  }
+
+  for (int s = 0; s < 4; s++) {
+    color += PREVIOUS_STAGE(uv + DIAMOND_SAMPLE_OFFSETS[s] * blur * 3.0).rgb;
+  }
+
+  return vec4(color / 9.0, depth);
+}
\ No newline at end of file
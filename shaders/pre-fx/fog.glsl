@@ -0,0 +1,12 @@
+vec3 STAGE(Surface surface) {
+  vec3 color = PREVIOUS_STAGE(surface);
+
+  if (surface.isEmissive) {
+    return color;
+  }
+
+  float a = clamp((surface.depth / 10000.0) - (surface.position.y / 1000.0), 0.0, 1.0);
+  vec3 fogColor = mix(vec3(0.0), vec3(0.5), a);
+
+  return color + fogColor;
+}
\ No newline at end of file
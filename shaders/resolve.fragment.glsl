@@ -0,0 +1,46 @@
+#version 330 core
+
+#include <helpers/gbuffer.glsl>
+#include <helpers/frame-constants.glsl>
+
+uniform sampler2D colorTexture;
+uniform sampler2D depthTexture;
+
+noperspective in vec2 fragmentUv;
+
+layout (location = 0) out vec4 colorDepth;
+
+struct Surface {
+  vec2 uv;
+  vec3 albedo;
+  vec3 position;
+  float depth;
+  bool isEmissive;
+};
+
+/**
+ * Emissive surfaces aren't lit, so their albedo is resolved as-is.
+ * Lit surfaces resolve to zero, leaving the accumulated lighting
+ * they're blended over intact, before any pre-fx stages apply.
+ */
+vec3 getResolvedColor(Surface surface) {
+  return surface.isEmissive ? surface.albedo : vec3(0.0);
+}
+
+#define STAGE_SOURCE getResolvedColor
+
+#pragma stages
+
+void main() {
+  vec4 colorAndFlags = texture(colorTexture, fragmentUv);
+  float hardwareDepth = texture(depthTexture, fragmentUv).r;
+  Surface surface;
+
+  surface.uv = fragmentUv;
+  surface.albedo = colorAndFlags.rgb;
+  surface.position = getWorldPosition(fragmentUv, hardwareDepth, inverseViewProjectionMatrix);
+  surface.depth = getLinearDepth(hardwareDepth);
+  surface.isEmissive = colorAndFlags.a > 0.5;
+
+  colorDepth = vec4(FINAL_STAGE(surface), surface.depth);
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#version 330 core
+
+#include <helpers/shadows.glsl>
+#include <helpers/gaussian.glsl>
+
+uniform sampler2DArray depthMaps;
+uniform sampler2DArray momentMaps;
+uniform bool isWarpPass = false;
+uniform int layer;
+uniform vec2 direction;
+
+noperspective in vec2 fragmentUv;
+
+layout (location = 0) out vec4 moments;
+
+/**
+ * Warps and blurs raw shadow map depths along one axis. Moments
+ * are computed per-tap before blurring, since filtering the depths
+ * themselves would not produce valid moments.
+ */
+vec4 getBlurredWarpedMoments() {
+  vec4 blurredMoments = vec4(0.0);
+  vec2 texelSize = 1.0 / textureSize(depthMaps, 0).xy;
+
+  for (int i = 0; i < 9; i++) {
+    vec2 offset = direction * texelSize * float(i - 4.0);
+    float depth = texture(depthMaps, vec3(fragmentUv + offset, layer)).r;
+
+    blurredMoments += getWarpedDepthMoments(depth) * GAUSSIAN_KERNEL_9[i];
+  }
+
+  return blurredMoments;
+}
+
+void main() {
+  if (isWarpPass) {
+    moments = getBlurredWarpedMoments();
+  } else {
+    moments = gaussian9(momentMaps, vec3(fragmentUv, layer), direction);
+  }
+}
\ No newline at end of file
@@ -1,15 +1,18 @@
 #version 330 core
 
 #include <helpers/lighting.glsl>
+#include <helpers/gbuffer.glsl>
 #include <helpers/shadows.glsl>
+#include <helpers/frame-constants.glsl>
+#include <helpers/light-constants.glsl>
 
 uniform sampler2D colorTexture;
-uniform sampler2D normalDepthTexture;
-uniform sampler2D positionTexture;
-uniform sampler2D lightMap;
-uniform mat4 lightMatrix;
-uniform vec3 cameraPosition;
-uniform Light light;
+uniform sampler2D normalTexture;
+uniform sampler2D depthTexture;
+uniform sampler2DArrayShadow lightMap;
+uniform sampler2DArray lightDepthMap;
+uniform sampler2DArray lightMomentMap;
+uniform bool useEvsm = false;
 
 noperspective in vec2 fragmentUv;
 
@@ -17,12 +20,15 @@ layout (location = 0) out vec4 colorDepth;
 
 void main() {
   vec3 albedo = texture(colorTexture, fragmentUv).xyz;
-  vec3 position = texture(positionTexture, fragmentUv).xyz;
-  vec4 normalDepth = texture(normalDepthTexture, fragmentUv);
+  float hardwareDepth = texture(depthTexture, fragmentUv).r;
+  vec3 position = getWorldPosition(fragmentUv, hardwareDepth, inverseViewProjectionMatrix);
   vec3 surfaceToCamera = normalize(cameraPosition - position);
-  vec3 normal = normalDepth.xyz;
+  vec3 normal = decodeNormal(texture(normalTexture, fragmentUv).xy);
+  float depth = getLinearDepth(hardwareDepth);
   vec3 lighting = albedo * getSpotLightFactor(light, position, normal, surfaceToCamera);
-  float shadowFactor = getShadowFactor(position, lightMatrix, lightMap, 0.0001, 30.0);
+  float shadowFactor = useEvsm
+    ? getEvsmShadowFactor(position, lightMatrices[0], lightMomentMap, 0, 0.0001)
+    : getShadowFactor(position, lightMatrices[0], lightMap, lightDepthMap, 0, 0.0001, 30.0);
 
-  colorDepth = vec4(lighting * shadowFactor, normalDepth.w);
+  colorDepth = vec4(lighting * shadowFactor, depth);
 }
\ No newline at end of file